@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// 堆分配计数：替换全局operator new/delete，统计进程内C++分配的次数和字节数
+// 替换函数不能内联，每个可执行文件只能有一个源文件包含本头文件
+// Skia内部经sk_malloc直接调用malloc的分配（像素缓冲、编解码缓冲等）不计入
+namespace bench {
+
+struct AllocSnapshot {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+class AllocCounter {
+public:
+    static AllocSnapshot snapshot() {
+        return {counter().load(std::memory_order_relaxed), byteCounter().load(std::memory_order_relaxed)};
+    }
+    
+    // 自since以来的分配
+    static AllocSnapshot since(const AllocSnapshot& since) {
+        AllocSnapshot now = snapshot();
+        return {now.count - since.count, now.bytes - since.bytes};
+    }
+    
+    static void record(size_t size) {
+        counter().fetch_add(1, std::memory_order_relaxed);
+        byteCounter().fetch_add(size, std::memory_order_relaxed);
+    }
+
+private:
+    static std::atomic<uint64_t>& counter() {
+        static std::atomic<uint64_t> value{0};
+        return value;
+    }
+    
+    static std::atomic<uint64_t>& byteCounter() {
+        static std::atomic<uint64_t> value{0};
+        return value;
+    }
+};
+
+} // namespace bench
+
+void* operator new(size_t size) {
+    bench::AllocCounter::record(size);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    bench::AllocCounter::record(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
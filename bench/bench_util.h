@@ -0,0 +1,164 @@
+#pragma once
+
+#include "include/core/SkImageInfo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+// 基准测试公共工具：计时、统计、进程内存、输入查找与像素对比
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+// 返回从start到现在的毫秒数
+inline double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 一组样本的统计结果
+struct Stats {
+    size_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+};
+
+// 最近秩法求百分位，samples需已排序
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+inline Stats computeStats(std::vector<double> samples) {
+    Stats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    stats.count = samples.size();
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    stats.p50 = percentile(samples, 50);
+    stats.p90 = percentile(samples, 90);
+    stats.p95 = percentile(samples, 95);
+    stats.p99 = percentile(samples, 99);
+    return stats;
+}
+
+// 打印一行统计，单位由调用方决定
+inline void printStats(const std::string& name, const Stats& stats, const char* unit = "ms") {
+    std::printf("%-28s n=%-5zu min=%9.3f p50=%9.3f p95=%9.3f p99=%9.3f max=%9.3f mean=%9.3f %s\n",
+                name.c_str(), stats.count, stats.min, stats.p50, stats.p95, stats.p99,
+                stats.max, stats.mean, unit);
+}
+
+// 进程峰值常驻内存（字节）；macOS的ru_maxrss单位是字节，Linux是KB
+inline uint64_t peakRssBytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+// 进程当前常驻内存（字节），获取失败返回0
+inline uint64_t currentRssBytes() {
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// 递归查找目录下的协议文件（*.json），跳过素材和输出目录，结果按路径排序
+inline std::vector<std::string> findProtocolFiles(const std::string& dir) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(dir, ec); it != fs::recursive_directory_iterator(); ++it) {
+        const std::string name = it->path().filename().string();
+        if (it->is_directory() && (name == "resources" || name == "original" || name == "output")) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        if (it->is_regular_file() && it->path().extension() == ".json") {
+            files.push_back(it->path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// 查找各项目resources目录下（递归）的素材文件，结果按路径排序
+inline std::vector<std::string> findAssetFiles(const std::string& projectsDir) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& project : fs::directory_iterator(projectsDir, ec)) {
+        fs::path resources = project.path() / "resources";
+        if (!fs::is_directory(resources, ec)) {
+            continue;
+        }
+        for (const auto& entry : fs::recursive_directory_iterator(resources, ec)) {
+            if (entry.is_regular_file()) {
+                files.push_back(entry.path().string());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// 非预乘RGBA，与PNG解码结果格式一致，便于逐像素比较
+inline SkImageInfo comparisonInfo(int width, int height) {
+    return SkImageInfo::Make(width, height, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+}
+
+// PSNR保留两位小数，完全一致（无穷大）时为"inf"
+inline std::string formatPsnr(double psnr) {
+    if (std::isinf(psnr)) {
+        return "inf";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.2f", psnr);
+    return buffer;
+}
+
+} // namespace bench
@@ -0,0 +1,352 @@
+#include "bench_util.h"
+
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkSamplingOptions.h"
+
+#include "engine/render_engine.h"
+#include "output/image_writer.h"
+#include "parsers/protocol_parser.h"
+#include "utils/image_diff.h"
+#include "3rdparty/json/include/nlohmann/json.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace skia_renderer;
+using json = nlohmann::json;
+
+namespace {
+
+struct BenchOptions {
+    std::string projectsDir = "projects";
+    std::string jsonPath;           // 为空时不写JSON
+    std::vector<int> sampleSizes = {2, 4, 8};
+    int iterations = 3;
+    bool decode = true;
+    bool encode = true;
+};
+
+// 一种编码设置，直接用OutputConfig描述，走与线上相同的ImageWriter路径
+struct EncodeSetting {
+    std::string name;
+    OutputConfig config;
+};
+
+double megabytesPerSecond(size_t bytes, double ms) {
+    return ms > 0.0 ? bytes / (1024.0 * 1024.0) / (ms / 1000.0) : 0.0;
+}
+
+json psnrToJson(double psnr) {
+    return std::isinf(psnr) ? json(nullptr) : json(psnr);
+}
+
+bool decodeToBitmap(const sk_sp<SkData>& data, int sampleSize, SkBitmap* bitmap) {
+    std::unique_ptr<SkAndroidCodec> codec = SkAndroidCodec::MakeFromData(data);
+    if (!codec) {
+        return false;
+    }
+    SkISize size = codec->getSampledDimensions(sampleSize);
+    SkImageInfo info = bench::comparisonInfo(size.width(), size.height());
+    if (!bitmap->tryAllocPixels(info)) {
+        return false;
+    }
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = sampleSize;
+    SkCodec::Result result = codec->getAndroidPixels(info, bitmap->getPixels(), bitmap->rowBytes(), &options);
+    return result == SkCodec::kSuccess || result == SkCodec::kIncompleteInput;
+}
+
+double psnrBetween(const SkPixmap& a, const SkPixmap& b) {
+    ImageDiffResult diff;
+    if (!ImageDiff::compare(a, b, &diff)) {
+        return 0.0;
+    }
+    return diff.psnr;
+}
+
+// ==================== 解码 ====================
+
+// 全尺寸解码与按采样率缩小解码；缩小解码的PSNR以全尺寸解码后高质量缩放的结果为参照
+json benchDecode(const std::string& file, const BenchOptions& options) {
+    sk_sp<SkData> data = SkData::MakeFromFileName(file.c_str());
+    std::unique_ptr<SkAndroidCodec> probe = data ? SkAndroidCodec::MakeFromData(data) : nullptr;
+    if (!probe) {
+        return nullptr;
+    }
+
+    std::string format;
+    switch (probe->getEncodedFormat()) {
+        case SkEncodedImageFormat::kPNG: format = "png"; break;
+        case SkEncodedImageFormat::kJPEG: format = "jpeg"; break;
+        case SkEncodedImageFormat::kWEBP: format = "webp"; break;
+        case SkEncodedImageFormat::kGIF: format = "gif"; break;
+        default: format = "other"; break;
+    }
+    SkISize fullSize = probe->getInfo().dimensions();
+
+    json result = {
+        {"file", file},
+        {"format", format},
+        {"width", fullSize.width()},
+        {"height", fullSize.height()},
+        {"encodedBytes", data->size()},
+        {"decodes", json::array()},
+    };
+
+    SkBitmap full;
+    std::vector<int> sampleSizes = {1};
+    sampleSizes.insert(sampleSizes.end(), options.sampleSizes.begin(), options.sampleSizes.end());
+    for (int sampleSize : sampleSizes) {
+        std::vector<double> times;
+        SkBitmap bitmap;
+        bool success = true;
+        for (int i = 0; i < options.iterations && success; ++i) {
+            bitmap.reset();
+            auto start = bench::Clock::now();
+            success = decodeToBitmap(data, sampleSize, &bitmap);
+            times.push_back(bench::elapsedMs(start));
+        }
+        if (!success) {
+            std::printf("  %-60s 1/%d 解码失败\n", file.c_str(), sampleSize);
+            continue;
+        }
+
+        double psnr = std::numeric_limits<double>::infinity();
+        if (sampleSize == 1) {
+            full = bitmap;
+        } else if (!full.drawsNothing()) {
+            SkBitmap reference;
+            reference.allocPixels(bitmap.info());
+            full.pixmap().scalePixels(reference.pixmap(), SkSamplingOptions(SkCubicResampler::Mitchell()));
+            psnr = psnrBetween(bitmap.pixmap(), reference.pixmap());
+        }
+
+        bench::Stats stats = bench::computeStats(times);
+        size_t pixelBytes = bitmap.computeByteSize();
+        double throughput = megabytesPerSecond(pixelBytes, stats.p50);
+        std::printf("  %-60s %-5s 1/%d %5dx%-5d %9.2f ms %9.1f MB/s  PSNR %s\n", file.c_str(), format.c_str(),
+                    sampleSize, bitmap.width(), bitmap.height(), stats.p50, throughput, bench::formatPsnr(psnr).c_str());
+
+        result["decodes"].push_back({
+            {"sampleSize", sampleSize},
+            {"width", bitmap.width()},
+            {"height", bitmap.height()},
+            {"p50Ms", stats.p50},
+            {"mbPerSecond", throughput},
+            {"psnrVsFull", psnrToJson(psnr)},
+        });
+    }
+    return result;
+}
+
+// ==================== 编码 ====================
+
+std::vector<EncodeSetting> encodeSettings() {
+    std::vector<EncodeSetting> settings;
+    auto add = [&](const std::string& name, OutputConfig config) {
+        config.filename = "codec_bench";
+        settings.push_back({name, config});
+    };
+
+    for (const char* profile : {"fast", "balanced", "smallest"}) {
+        for (const char* format : {"png", "jpeg", "webp"}) {
+            OutputConfig config;
+            config.format = format;
+            config.profile = profile;
+            config.quality = std::string(format) == "png" ? 100 : 90;
+            add(std::string(format) + "/profile=" + profile, config);
+        }
+    }
+
+    for (int level = 0; level <= 9; ++level) {
+        OutputConfig config;
+        config.format = "png";
+        config.compressionLevel = level;
+        add("png/level=" + std::to_string(level), config);
+    }
+    for (const char* filter : {"none", "sub", "up", "avg", "paeth"}) {
+        OutputConfig config;
+        config.format = "png";
+        config.pngFilter = filter;
+        add(std::string("png/filter=") + filter, config);
+    }
+    {
+        OutputConfig config;
+        config.format = "png";
+        config.parallelEncode = true;
+        add("png/parallel", config);
+    }
+
+    for (const char* chroma : {"420", "444"}) {
+        for (int quality : {50, 70, 80, 85, 90, 95, 100}) {
+            OutputConfig config;
+            config.format = "jpeg";
+            config.quality = quality;
+            config.chromaSubsampling = chroma;
+            add("jpeg/q=" + std::to_string(quality) + "/" + chroma, config);
+        }
+    }
+    {
+        OutputConfig config;
+        config.format = "jpeg";
+        config.quality = 90;
+        config.parallelEncode = true;
+        add("jpeg/q=90/parallel", config);
+    }
+
+    for (int quality : {50, 75, 90, 100}) {
+        OutputConfig config;
+        config.format = "webp";
+        config.quality = quality;
+        add("webp/q=" + std::to_string(quality), config);
+    }
+    for (int effort : {0, 25, 50, 75, 100}) {
+        OutputConfig config;
+        config.format = "webp";
+        config.lossless = true;
+        config.quality = effort;
+        add("webp/lossless/effort=" + std::to_string(effort), config);
+    }
+    return settings;
+}
+
+json benchEncode(const std::string& protocolFile, const BenchOptions& options) {
+    ProtocolParser parser;
+    if (!parser.loadFromFile(protocolFile)) {
+        std::cout << "⚠️  跳过 " << protocolFile << ": " << parser.getErrorMessage() << std::endl;
+        return nullptr;
+    }
+
+    RenderEngine engine;
+    sk_sp<SkImage> image = engine.renderToImage(parser.getProtocol());
+    if (!image) {
+        std::cout << "⚠️  跳过 " << protocolFile << ": " << engine.getErrorMessage() << std::endl;
+        return nullptr;
+    }
+
+    SkBitmap source;
+    if (!source.tryAllocPixels(bench::comparisonInfo(image->width(), image->height())) ||
+        !image->readPixels(nullptr, source.pixmap(), 0, 0)) {
+        return nullptr;
+    }
+    size_t rawBytes = static_cast<size_t>(image->width()) * image->height() * 4;
+
+    std::cout << "\n" << protocolFile << " (" << image->width() << "x" << image->height() << ")" << std::endl;
+    json result = {
+        {"protocol", protocolFile},
+        {"width", image->width()},
+        {"height", image->height()},
+        {"encodes", json::array()},
+    };
+
+    ImageWriter writer;
+    for (const auto& setting : encodeSettings()) {
+        std::vector<double> times;
+        sk_sp<SkData> encoded;
+        for (int i = 0; i < options.iterations; ++i) {
+            auto start = bench::Clock::now();
+            encoded = writer.encodeImage(image, setting.config);
+            times.push_back(bench::elapsedMs(start));
+            if (!encoded) {
+                break;
+            }
+        }
+        if (!encoded) {
+            std::printf("  %-28s 编码失败: %s\n", setting.name.c_str(), writer.getErrorMessage().c_str());
+            continue;
+        }
+
+        SkBitmap decoded;
+        double psnr = decodeToBitmap(encoded, 1, &decoded) ? psnrBetween(source.pixmap(), decoded.pixmap()) : 0.0;
+
+        bench::Stats stats = bench::computeStats(times);
+        double throughput = megabytesPerSecond(rawBytes, stats.p50);
+        std::printf("  %-28s %9.2f ms %9.1f MB/s %10zu B (%5.1f%%)  PSNR %s\n", setting.name.c_str(), stats.p50,
+                    throughput, encoded->size(), encoded->size() * 100.0 / rawBytes, bench::formatPsnr(psnr).c_str());
+
+        result["encodes"].push_back({
+            {"setting", setting.name},
+            {"p50Ms", stats.p50},
+            {"mbPerSecond", throughput},
+            {"outputBytes", encoded->size()},
+            {"psnr", psnrToJson(psnr)},
+        });
+    }
+    return result;
+}
+
+void printUsage(const char* program) {
+    std::cout << "用法: " << program << " [选项]\n"
+              << "  --projects DIR   项目目录（默认projects）\n"
+              << "  --iterations N   每项测量次数，取中位数（默认3）\n"
+              << "  --decode-only    只测解码\n"
+              << "  --encode-only    只测编码\n"
+              << "  --json FILE      同时把结果写成JSON\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--projects" && hasValue) {
+            options.projectsDir = argv[++i];
+        } else if (arg == "--iterations" && hasValue) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--decode-only") {
+            options.encode = false;
+        } else if (arg == "--encode-only") {
+            options.decode = false;
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    json report;
+    if (options.decode) {
+        std::cout << "=== 解码（MB/s按解码后的RGBA字节计，PSNR以全尺寸解码+Mitchell缩放为参照） ===" << std::endl;
+        report["decode"] = json::array();
+        for (const auto& file : bench::findAssetFiles(options.projectsDir)) {
+            json result = benchDecode(file, options);
+            if (!result.is_null()) {
+                report["decode"].push_back(result);
+            }
+        }
+    }
+
+    if (options.encode) {
+        std::cout << "\n=== 编码（MB/s按输入的RGBA字节计，PSNR为编码后解码回来与原图的对比） ===" << std::endl;
+        report["encode"] = json::array();
+        for (const auto& file : bench::findProtocolFiles(options.projectsDir)) {
+            json result = benchEncode(file, options);
+            if (!result.is_null()) {
+                report["encode"].push_back(result);
+            }
+        }
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream out(options.jsonPath);
+        if (!out || !(out << report.dump(2) << std::endl)) {
+            std::cerr << "❌ 无法写入 " << options.jsonPath << std::endl;
+            return 1;
+        }
+        std::cout << "\n结果已写入 " << options.jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,411 @@
+#include "alloc_counter.h"
+#include "bench_util.h"
+
+#include "include/core/SkStream.h"
+
+#include "core/version.h"
+#include "engine/render_engine.h"
+#include "output/output_sink.h"
+#include "parsers/protocol_parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace skia_renderer;
+
+namespace {
+
+struct BenchOptions {
+    std::string projectsDir = "projects";
+    std::string jsonPath = "output/poster_bench.json";
+    std::vector<std::string> protocolFiles;     // 为空时扫描projectsDir
+    std::vector<std::string> atlasFiles;        // 精灵图集索引，所有引擎共享
+    std::vector<std::shared_ptr<const SpriteAtlas>> atlases;
+    int warmup = 2;
+    int iterations = 10;
+    int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    double seconds = 3.0;
+};
+
+struct ProtocolCase {
+    std::string name;       // 相对projects的路径，如 trip/trip_protocol
+    std::string file;
+    RenderProtocol protocol;
+};
+
+// 单个协议的延迟测试结果
+struct LatencyResult {
+    bench::Stats wall;
+    double parseMs = 0.0;           // 以下各阶段为均值
+    RenderStageTimings stages;
+    double allocationsPerRender = 0.0;
+    double allocatedBytesPerRender = 0.0;
+    uint64_t outputBytes = 0;
+    uint64_t peakRssBytes = 0;
+};
+
+struct ThroughputResult {
+    int threads = 0;
+    uint64_t posters = 0;
+    double seconds = 0.0;
+    double postersPerSecond = 0.0;
+};
+
+void printUsage(const char* program) {
+    std::cout << "用法: " << program << " [选项] [protocol.json...]\n"
+              << "  --projects DIR   协议搜索目录（默认projects），未指定协议文件时递归扫描其中的协议\n"
+              << "  --warmup N       每个协议的预热次数（默认2）\n"
+              << "  --iterations N   每个协议的计时次数（默认10）\n"
+              << "  --threads N      吞吐测试的最大线程数（默认CPU核数）\n"
+              << "  --seconds S      每档线程数的吞吐测试时长（默认3秒）\n"
+              << "  --json FILE      结果JSON路径（默认output/poster_bench.json）\n"
+              << "  --atlas FILE     加载精灵图集索引（.atlas.json），可重复指定\n";
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--projects" && hasValue) {
+            options->projectsDir = argv[++i];
+        } else if (arg == "--warmup" && hasValue) {
+            options->warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && hasValue) {
+            options->iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            options->maxThreads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seconds" && hasValue) {
+            options->seconds = std::max(0.1, std::atof(argv[++i]));
+        } else if (arg == "--json" && hasValue) {
+            options->jsonPath = argv[++i];
+        } else if (arg == "--atlas" && hasValue) {
+            options->atlasFiles.push_back(argv[++i]);
+        } else if (arg.rfind("--", 0) == 0) {
+            return false;
+        } else {
+            options->protocolFiles.push_back(arg);
+        }
+    }
+    return true;
+}
+
+std::vector<ProtocolCase> loadCases(const BenchOptions& options) {
+    std::vector<std::string> files = options.protocolFiles.empty()
+        ? bench::findProtocolFiles(options.projectsDir) : options.protocolFiles;
+
+    std::vector<ProtocolCase> cases;
+    for (const auto& file : files) {
+        ProtocolParser parser;
+        if (!parser.loadFromFile(file)) {
+            std::cout << "⚠️  跳过 " << file << ": " << parser.getErrorMessage() << std::endl;
+            continue;
+        }
+        ProtocolCase protocolCase;
+        protocolCase.file = file;
+        protocolCase.name = fs::path(file).lexically_relative(options.projectsDir).replace_extension().string();
+        if (protocolCase.name.empty() || protocolCase.name.rfind("..", 0) == 0) {
+            protocolCase.name = fs::path(file).stem().string();
+        }
+        protocolCase.protocol = parser.getProtocol();
+        cases.push_back(std::move(protocolCase));
+    }
+    return cases;
+}
+
+// 完整的一次渲染：解析协议、绘制、编码，编码结果丢弃只统计字节数
+bool renderOnce(RenderEngine& engine, const std::string& file, double* parseMs, uint64_t* outputBytes) {
+    auto parseStart = bench::Clock::now();
+    ProtocolParser parser;
+    if (!parser.loadFromFile(file)) {
+        std::cerr << "协议解析失败: " << parser.getErrorMessage() << std::endl;
+        return false;
+    }
+    *parseMs = bench::elapsedMs(parseStart);
+
+    SkNullWStream stream;
+    StreamOutputSink sink(&stream);
+    if (!engine.renderToSink(parser.getProtocol(), &sink)) {
+        std::cerr << "渲染失败: " << engine.getErrorMessage() << std::endl;
+        return false;
+    }
+    *outputBytes = stream.bytesWritten();
+    return true;
+}
+
+// 延迟测试：单线程、复用同一个引擎，与常驻服务的工作方式一致
+bool measureLatency(const ProtocolCase& protocolCase, const BenchOptions& options, LatencyResult* result) {
+    RenderEngine engine;
+    for (const auto& atlas : options.atlases) {
+        engine.addSpriteAtlas(atlas);
+    }
+    double parseMs = 0.0;
+    uint64_t outputBytes = 0;
+    for (int i = 0; i < options.warmup; ++i) {
+        if (!renderOnce(engine, protocolCase.file, &parseMs, &outputBytes)) {
+            return false;
+        }
+    }
+
+    std::vector<double> wall;
+    bench::AllocSnapshot allocStart = bench::AllocCounter::snapshot();
+    for (int i = 0; i < options.iterations; ++i) {
+        auto start = bench::Clock::now();
+        if (!renderOnce(engine, protocolCase.file, &parseMs, &outputBytes)) {
+            return false;
+        }
+        wall.push_back(bench::elapsedMs(start));
+
+        const RenderStageTimings& timings = engine.getLastTimings();
+        result->parseMs += parseMs;
+        result->stages.decodeMs += timings.decodeMs;
+        result->stages.canvasMs += timings.canvasMs;
+        result->stages.imagesMs += timings.imagesMs;
+        result->stages.textsMs += timings.textsMs;
+        result->stages.replayMs += timings.replayMs;
+        result->stages.encodeMs += timings.encodeMs;
+    }
+    bench::AllocSnapshot allocations = bench::AllocCounter::since(allocStart);
+
+    double n = options.iterations;
+    result->wall = bench::computeStats(wall);
+    result->parseMs /= n;
+    result->stages.decodeMs /= n;
+    result->stages.canvasMs /= n;
+    result->stages.imagesMs /= n;
+    result->stages.textsMs /= n;
+    result->stages.replayMs /= n;
+    result->stages.encodeMs /= n;
+    result->allocationsPerRender = allocations.count / n;
+    result->allocatedBytesPerRender = allocations.bytes / n;
+    result->outputBytes = outputBytes;
+    result->peakRssBytes = bench::peakRssBytes();
+    return true;
+}
+
+// 吞吐测试：每个线程一个引擎，轮流渲染所有协议，固定时长内统计完成数
+ThroughputResult measureThroughput(const std::vector<ProtocolCase>& cases, const BenchOptions& options, int threads) {
+    double seconds = options.seconds;
+    std::mutex mutex;
+    std::condition_variable ready;
+    int warmedUp = 0;
+    bool started = false;
+    std::atomic<uint64_t> next{0};
+    std::atomic<uint64_t> completed{0};
+    bench::Clock::time_point deadline;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            RenderEngine engine;
+            for (const auto& atlas : options.atlases) {
+                engine.addSpriteAtlas(atlas);
+            }
+            SkNullWStream stream;
+            StreamOutputSink sink(&stream);
+
+            // 每个引擎先完整渲染一轮，避免把字体加载和首次解码计入吞吐
+            for (const auto& protocolCase : cases) {
+                engine.renderToSink(protocolCase.protocol, &sink);
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ++warmedUp;
+                ready.notify_all();
+                ready.wait(lock, [&]() { return started; });
+            }
+
+            while (bench::Clock::now() < deadline) {
+                const ProtocolCase& protocolCase = cases[next++ % cases.size()];
+                if (engine.renderToSink(protocolCase.protocol, &sink)) {
+                    ++completed;
+                }
+            }
+        });
+    }
+
+    bench::Clock::time_point start;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&]() { return warmedUp == threads; });
+        start = bench::Clock::now();
+        deadline = start + std::chrono::duration_cast<bench::Clock::duration>(
+            std::chrono::duration<double>(seconds));
+        started = true;
+        ready.notify_all();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    ThroughputResult result;
+    result.threads = threads;
+    result.posters = completed;
+    result.seconds = bench::elapsedMs(start) / 1000.0;
+    result.postersPerSecond = result.posters / result.seconds;
+    return result;
+}
+
+// 线程数档位：1、2、4...直到最大线程数
+std::vector<int> threadLevels(int maxThreads) {
+    std::vector<int> levels;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        levels.push_back(threads);
+    }
+    levels.push_back(maxThreads);
+    return levels;
+}
+
+json statsToJson(const bench::Stats& stats) {
+    return {{"min", stats.min}, {"p50", stats.p50}, {"p95", stats.p95}, {"p99", stats.p99},
+            {"max", stats.max}, {"mean", stats.mean}};
+}
+
+std::string currentTimestamp() {
+    std::time_t now = std::time(nullptr);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return buffer;
+}
+
+bool writeJson(const std::string& path, const json& report) {
+    fs::path parent = fs::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code ec;
+        fs::create_directories(parent, ec);
+    }
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << report.dump(2) << std::endl;
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    for (const auto& atlasFile : options.atlasFiles) {
+        std::string error;
+        std::shared_ptr<SpriteAtlas> atlas = SpriteAtlas::load(atlasFile, &error);
+        if (!atlas) {
+            std::cerr << "❌ " << error << std::endl;
+            return 1;
+        }
+        std::cout << "🧩 图集 " << atlasFile << ": " << atlas->getSpriteCount() << "个精灵";
+        if (atlas->getStaleCount() > 0) {
+            std::cout << ", " << atlas->getStaleCount() << "个已过期";
+        }
+        std::cout << std::endl;
+        options.atlases.push_back(atlas);
+    }
+
+    std::vector<ProtocolCase> cases = loadCases(options);
+    if (cases.empty()) {
+        std::cerr << "❌ 没有可用的协议文件" << std::endl;
+        return 1;
+    }
+
+    std::cout << "🏁 poster_bench " << kRendererVersion << ": " << cases.size() << "个协议, 预热"
+              << options.warmup << "次, 计时" << options.iterations << "次" << std::endl;
+
+    json report;
+    report["version"] = kRendererVersion;
+    report["timestamp"] = currentTimestamp();
+    report["hardwareThreads"] = std::thread::hardware_concurrency();
+    report["warmup"] = options.warmup;
+    report["iterations"] = options.iterations;
+    report["protocols"] = json::array();
+
+    // 延迟与分阶段耗时
+    std::printf("\n%-40s %10s %9s %9s %9s | %7s %7s %7s %7s %7s %7s %7s | %9s %9s\n",
+                "协议", "尺寸", "p50(ms)", "p95(ms)", "p99(ms)",
+                "parse", "decode", "canvas", "images", "texts", "replay", "encode", "new/张", "峰值RSS");
+    bool allSucceeded = true;
+    for (const auto& protocolCase : cases) {
+        LatencyResult result;
+        if (!measureLatency(protocolCase, options, &result)) {
+            std::cout << "❌ " << protocolCase.name << std::endl;
+            allSucceeded = false;
+            continue;
+        }
+
+        std::string size = std::to_string(protocolCase.protocol.canvas.width) + "x" +
+                           std::to_string(protocolCase.protocol.canvas.height);
+        std::printf("%-40s %10s %9.2f %9.2f %9.2f | %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f | %9.0f %7.1fMB\n",
+                    protocolCase.name.c_str(), size.c_str(),
+                    result.wall.p50, result.wall.p95, result.wall.p99,
+                    result.parseMs, result.stages.decodeMs, result.stages.canvasMs, result.stages.imagesMs,
+                    result.stages.textsMs, result.stages.replayMs, result.stages.encodeMs,
+                    result.allocationsPerRender, result.peakRssBytes / (1024.0 * 1024.0));
+
+        report["protocols"].push_back({
+            {"name", protocolCase.name},
+            {"file", protocolCase.file},
+            {"width", protocolCase.protocol.canvas.width},
+            {"height", protocolCase.protocol.canvas.height},
+            {"wallMs", statsToJson(result.wall)},
+            {"stagesMs", {
+                {"parse", result.parseMs},
+                {"decode", result.stages.decodeMs},
+                {"canvas", result.stages.canvasMs},
+                {"images", result.stages.imagesMs},
+                {"texts", result.stages.textsMs},
+                {"replay", result.stages.replayMs},
+                {"encode", result.stages.encodeMs},
+            }},
+            {"allocationsPerRender", result.allocationsPerRender},
+            {"allocatedBytesPerRender", result.allocatedBytesPerRender},
+            {"outputBytes", result.outputBytes},
+            {"peakRssBytes", result.peakRssBytes},
+        });
+    }
+
+    // 多线程吞吐
+    std::cout << "\n吞吐（每档" << options.seconds << "秒）:" << std::endl;
+    report["throughput"] = json::array();
+    double singleThread = 0.0;
+    for (int threads : threadLevels(options.maxThreads)) {
+        ThroughputResult result = measureThroughput(cases, options, threads);
+        if (threads == 1) {
+            singleThread = result.postersPerSecond;
+        }
+        double scaling = singleThread > 0.0 ? result.postersPerSecond / singleThread : 0.0;
+        std::printf("  %3d线程: %8.2f 张/秒 (%llu张, 加速比 %.2fx)\n", threads, result.postersPerSecond,
+                    static_cast<unsigned long long>(result.posters), scaling);
+        report["throughput"].push_back({
+            {"threads", result.threads},
+            {"posters", result.posters},
+            {"seconds", result.seconds},
+            {"postersPerSecond", result.postersPerSecond},
+        });
+    }
+
+    report["peakRssBytes"] = bench::peakRssBytes();
+    std::cout << "\n峰值RSS: " << bench::peakRssBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    if (!writeJson(options.jsonPath, report)) {
+        std::cerr << "❌ 无法写入 " << options.jsonPath << std::endl;
+        return 1;
+    }
+    std::cout << "结果已写入 " << options.jsonPath << std::endl;
+    return allSucceeded ? 0 : 1;
+}
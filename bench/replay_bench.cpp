@@ -0,0 +1,326 @@
+#include "bench_util.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkSurface.h"
+#include "include/encode/SkPngEncoder.h"
+#include "include/utils/SkNWayCanvas.h"
+
+#include "renderers/tiled_rasterizer.h"
+#include "utils/picture_capture.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace skia_renderer;
+
+namespace {
+
+// 计时画布 - 把每个绘制命令转发给真正的光栅画布，并按命令类型累计耗时
+class TimingCanvas : public SkNWayCanvas {
+public:
+    struct OpStats {
+        uint64_t count = 0;
+        double totalMs = 0.0;
+    };
+
+    TimingCanvas(SkCanvas* target) :
+        SkNWayCanvas(target->getBaseLayerSize().width(), target->getBaseLayerSize().height()) {
+        addCanvas(target);
+    }
+
+    const std::map<std::string, OpStats>& getStats() const { return stats; }
+
+protected:
+    SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+        auto start = bench::Clock::now();
+        SaveLayerStrategy strategy = SkNWayCanvas::getSaveLayerStrategy(rec);
+        record("saveLayer", start);
+        return strategy;
+    }
+
+    // restore时会合成saveLayer创建的图层，耗时计在这里
+    void willRestore() override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::willRestore();
+        record("restore", start);
+    }
+
+    void onDrawPaint(const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawPaint(paint);
+        record("drawPaint", start);
+    }
+
+    void onDrawBehind(const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawBehind(paint);
+        record("drawBehind", start);
+    }
+
+    void onDrawPoints(PointMode mode, size_t count, const SkPoint pts[], const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawPoints(mode, count, pts, paint);
+        record("drawPoints", start);
+    }
+
+    void onDrawRect(const SkRect& rect, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawRect(rect, paint);
+        record("drawRect", start);
+    }
+
+    void onDrawRegion(const SkRegion& region, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawRegion(region, paint);
+        record("drawRegion", start);
+    }
+
+    void onDrawOval(const SkRect& rect, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawOval(rect, paint);
+        record("drawOval", start);
+    }
+
+    void onDrawArc(const SkRect& rect, SkScalar startAngle, SkScalar sweepAngle, bool useCenter,
+                   const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawArc(rect, startAngle, sweepAngle, useCenter, paint);
+        record("drawArc", start);
+    }
+
+    void onDrawRRect(const SkRRect& rrect, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawRRect(rrect, paint);
+        record("drawRRect", start);
+    }
+
+    void onDrawDRRect(const SkRRect& outer, const SkRRect& inner, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawDRRect(outer, inner, paint);
+        record("drawDRRect", start);
+    }
+
+    void onDrawPath(const SkPath& path, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawPath(path, paint);
+        record("drawPath", start);
+    }
+
+    void onDrawImage2(const SkImage* image, SkScalar x, SkScalar y, const SkSamplingOptions& sampling,
+                      const SkPaint* paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawImage2(image, x, y, sampling, paint);
+        record("drawImage", start);
+    }
+
+    void onDrawImageRect2(const SkImage* image, const SkRect& src, const SkRect& dst,
+                          const SkSamplingOptions& sampling, const SkPaint* paint,
+                          SrcRectConstraint constraint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawImageRect2(image, src, dst, sampling, paint, constraint);
+        record("drawImageRect", start);
+    }
+
+    void onDrawImageLattice2(const SkImage* image, const Lattice& lattice, const SkRect& dst,
+                             SkFilterMode filter, const SkPaint* paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawImageLattice2(image, lattice, dst, filter, paint);
+        record("drawImageLattice", start);
+    }
+
+    void onDrawAtlas2(const SkImage* atlas, const SkRSXform xform[], const SkRect tex[],
+                      const SkColor colors[], int count, SkBlendMode mode,
+                      const SkSamplingOptions& sampling, const SkRect* cull,
+                      const SkPaint* paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawAtlas2(atlas, xform, tex, colors, count, mode, sampling, cull, paint);
+        record("drawAtlas", start);
+    }
+
+    void onDrawVerticesObject(const SkVertices* vertices, SkBlendMode mode, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawVerticesObject(vertices, mode, paint);
+        record("drawVertices", start);
+    }
+
+    void onDrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawShadowRec(path, rec);
+        record("drawShadow", start);
+    }
+
+    void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawTextBlob(blob, x, y, paint);
+        record("drawTextBlob", start);
+    }
+
+    void onDrawGlyphRunList(const sktext::GlyphRunList& list, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawGlyphRunList(list, paint);
+        record("drawGlyphRunList", start);
+    }
+
+    void onDrawPatch(const SkPoint cubics[12], const SkColor colors[4], const SkPoint texCoords[4],
+                     SkBlendMode mode, const SkPaint& paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawPatch(cubics, colors, texCoords, mode, paint);
+        record("drawPatch", start);
+    }
+
+    void onDrawPicture(const SkPicture* picture, const SkMatrix* matrix, const SkPaint* paint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawPicture(picture, matrix, paint);
+        record("drawPicture", start);
+    }
+
+    void onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawDrawable(drawable, matrix);
+        record("drawDrawable", start);
+    }
+
+    void onDrawEdgeAAQuad(const SkRect& rect, const SkPoint clip[4], QuadAAFlags aa,
+                          const SkColor4f& color, SkBlendMode mode) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawEdgeAAQuad(rect, clip, aa, color, mode);
+        record("drawEdgeAAQuad", start);
+    }
+
+    void onDrawEdgeAAImageSet2(const ImageSetEntry set[], int count, const SkPoint dstClips[],
+                               const SkMatrix preViewMatrices[], const SkSamplingOptions& sampling,
+                               const SkPaint* paint, SrcRectConstraint constraint) override {
+        auto start = bench::Clock::now();
+        SkNWayCanvas::onDrawEdgeAAImageSet2(set, count, dstClips, preViewMatrices, sampling, paint, constraint);
+        record("drawEdgeAAImageSet", start);
+    }
+
+private:
+    std::map<std::string, OpStats> stats;
+
+    void record(const char* name, bench::Clock::time_point start) {
+        OpStats& op = stats[name];
+        ++op.count;
+        op.totalMs += bench::elapsedMs(start);
+    }
+};
+
+void printUsage(const char* program) {
+    std::cout << "用法: " << program << " <capture.skp> [选项]\n"
+              << "  --iterations N   回放次数（默认10）\n"
+              << "  --tiles N        按N个条带并行回放（默认串行）\n"
+              << "  --png FILE       把最后一次回放结果保存为PNG\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string capturePath = argv[1];
+    int iterations = 10;
+    int tiles = 0;
+    std::string pngPath;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--tiles") == 0 && i + 1 < argc) {
+            tiles = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--png") == 0 && i + 1 < argc) {
+            pngPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    auto loadStart = bench::Clock::now();
+    sk_sp<SkPicture> picture = PictureCapture::loadFromFile(capturePath);
+    if (!picture) {
+        std::cerr << "❌ 无法加载捕获文件: " << capturePath << std::endl;
+        return 1;
+    }
+    double loadMs = bench::elapsedMs(loadStart);
+
+    SkIRect bounds = picture->cullRect().roundOut();
+    SkImageInfo info = SkImageInfo::Make(bounds.width(), bounds.height(),
+                                         kRGBA_8888_SkColorType, kOpaque_SkAlphaType);
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(info);
+    if (!surface) {
+        std::cerr << "❌ 无法创建 " << bounds.width() << "x" << bounds.height() << " 的画布" << std::endl;
+        return 1;
+    }
+
+    std::cout << "📦 " << capturePath << ": " << bounds.width() << "x" << bounds.height()
+              << ", 约" << picture->approximateOpCount(true) << "个绘制命令, 加载 "
+              << loadMs << " ms" << std::endl;
+
+    // 整体回放耗时，第一次回放包含字形缓存和图片解码的预热，单独报告
+    std::vector<double> replayMs;
+    double firstMs = 0.0;
+    for (int i = 0; i <= iterations; ++i) {
+        auto start = bench::Clock::now();
+        if (tiles > 0) {
+            SkPixmap pixmap;
+            surface->peekPixels(&pixmap);
+            TiledRasterizer::replay(picture.get(), pixmap, tiles);
+        } else {
+            surface->getCanvas()->drawPicture(picture);
+        }
+        double ms = bench::elapsedMs(start);
+        if (i == 0) {
+            firstMs = ms;
+        } else {
+            replayMs.push_back(ms);
+        }
+    }
+    std::cout << "\n首次回放（冷）: " << firstMs << " ms" << std::endl;
+    bench::printStats(tiles > 0 ? "回放（" + std::to_string(tiles) + "条带）" : "回放（串行）",
+                      bench::computeStats(replayMs));
+
+    // 逐命令耗时：通过计时画布串行回放
+    TimingCanvas timingCanvas(surface->getCanvas());
+    for (int i = 0; i < iterations; ++i) {
+        picture->playback(&timingCanvas);
+    }
+
+    std::vector<std::pair<std::string, TimingCanvas::OpStats>> ops(
+        timingCanvas.getStats().begin(), timingCanvas.getStats().end());
+    std::sort(ops.begin(), ops.end(), [](const auto& a, const auto& b) {
+        return a.second.totalMs > b.second.totalMs;
+    });
+    double totalMs = 0.0;
+    for (const auto& op : ops) {
+        totalMs += op.second.totalMs;
+    }
+
+    std::printf("\n%-22s %10s %14s %12s %8s\n", "命令", "次数/轮", "耗时/轮(ms)", "平均(us)", "占比");
+    for (const auto& op : ops) {
+        double perIteration = op.second.totalMs / iterations;
+        double averageUs = op.second.totalMs * 1000.0 / op.second.count;
+        double share = totalMs > 0.0 ? op.second.totalMs * 100.0 / totalMs : 0.0;
+        std::printf("%-22s %10.1f %14.3f %12.2f %7.1f%%\n", op.first.c_str(),
+                    static_cast<double>(op.second.count) / iterations, perIteration, averageUs, share);
+    }
+
+    if (!pngPath.empty()) {
+        SkPixmap pixmap;
+        SkFILEWStream out(pngPath.c_str());
+        if (!surface->peekPixels(&pixmap) || !out.isValid() || !SkPngEncoder::Encode(&out, pixmap, {})) {
+            std::cerr << "❌ 无法保存PNG: " << pngPath << std::endl;
+            return 1;
+        }
+        std::cout << "\n回放结果已保存为" << pngPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,363 @@
+#include "bench_util.h"
+
+#include "include/core/SkGraphics.h"
+#include "include/core/SkStream.h"
+
+#include "engine/render_engine.h"
+#include "output/output_sink.h"
+#include "parsers/protocol_parser.h"
+#include "resources/image_cache.h"
+#include "resources/surface_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace skia_renderer;
+
+namespace {
+
+struct SoakOptions {
+    std::string projectsDir = "projects";
+    std::vector<std::string> protocolFiles;     // 为空时扫描projectsDir
+    std::string csvPath;                        // 为空时不写采样CSV
+    uint64_t renders = 200000;
+    double maxMinutes = 0.0;                    // 大于0时到时即停止
+    int sampleEvery = 500;
+    double warmupFraction = 0.1;                // 斜率拟合前丢弃的采样比例
+    double maxRssSlopeKb = 16.0;                // 每1000次渲染允许的RSS增长（KB）
+    double maxLatencyDrift = 0.25;              // 拟合的p50延迟从开始到结束允许的相对增长
+    uint32_t seed = 1;
+};
+
+// 一个采样点，覆盖上一个采样窗口
+struct Sample {
+    uint64_t renders = 0;
+    double elapsedSeconds = 0.0;
+    uint64_t rssBytes = 0;
+    size_t resourceCacheBytes = 0;
+    size_t fontCacheBytes = 0;
+    int fontCacheCount = 0;
+    size_t surfacePoolIdleBytes = 0;
+    size_t imageCacheBytes = 0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double rendersPerSecond = 0.0;
+};
+
+// ==================== 协议变体 ====================
+
+const char* const kBackgrounds[] = {"#FFFFFF", "#F5F0E6", "#1E1E1E", "rgb(230,240,255)", "rgba(255,250,240,1.0)"};
+const char* const kExtraText[] = {"限时优惠", "New Arrival", "青海湖", "Summer Sale 50%", "欢迎光临", "No.", "★"};
+
+class VariantGenerator {
+public:
+    VariantGenerator(std::vector<RenderProtocol> bases, uint32_t seed) :
+        bases(std::move(bases)), rng(seed) {}
+
+    // 基于随机选中的协议生成变体：抖动位置、字号、透明度、背景，替换部分文本并随机选择输出格式
+    RenderProtocol next(uint64_t serial) {
+        RenderProtocol protocol = bases[pick(bases.size())];
+
+        protocol.canvas.background = kBackgrounds[pick(sizeof(kBackgrounds) / sizeof(kBackgrounds[0]))];
+        protocol.canvas.tiledRaster = chance(0.1);
+
+        for (auto& image : protocol.images) {
+            jitterTransform(&image.transform);
+            if (chance(0.1)) {
+                image.transform.rotation = uniform(-10.0f, 10.0f);
+            }
+        }
+
+        for (auto& text : protocol.texts) {
+            jitterTransform(&text.transform);
+            text.style.fontSize *= uniform(0.8f, 1.2f);
+            // 带序号的文本让每次整形的字符串都不同，排除排版缓存的影响
+            if (chance(0.5)) {
+                text.content += " " + std::string(kExtraText[pick(sizeof(kExtraText) / sizeof(kExtraText[0]))]) +
+                                std::to_string(serial);
+            }
+            for (auto& segment : text.richTextSegments) {
+                if (segment.fontSize > 0.0f) {
+                    segment.fontSize *= uniform(0.8f, 1.2f);
+                }
+            }
+        }
+
+        OutputConfig output;
+        switch (pick(3)) {
+            case 0:
+                output.format = "png";
+                output.profile = "fast";
+                output.filename = "soak.png";
+                break;
+            case 1:
+                output.format = "jpeg";
+                output.quality = 70 + static_cast<int>(pick(26));
+                output.filename = "soak.jpg";
+                break;
+            default:
+                output.format = "webp";
+                output.quality = 60 + static_cast<int>(pick(36));
+                output.filename = "soak.webp";
+                break;
+        }
+        protocol.outputs = {output};
+        // 偶尔附带一个缩略图输出，覆盖多输出缩放路径
+        if (chance(0.2)) {
+            OutputConfig thumbnail = output;
+            thumbnail.filename = "thumb_" + output.filename;
+            thumbnail.width = protocol.canvas.width / 4;
+            protocol.outputs.push_back(thumbnail);
+        }
+        return protocol;
+    }
+
+private:
+    std::vector<RenderProtocol> bases;
+    std::mt19937 rng;
+
+    size_t pick(size_t count) {
+        return std::uniform_int_distribution<size_t>(0, count - 1)(rng);
+    }
+
+    bool chance(double probability) {
+        return std::bernoulli_distribution(probability)(rng);
+    }
+
+    float uniform(float low, float high) {
+        return std::uniform_real_distribution<float>(low, high)(rng);
+    }
+
+    void jitterTransform(Transform* transform) {
+        transform->x += uniform(-20.0f, 20.0f);
+        transform->y += uniform(-20.0f, 20.0f);
+        if (chance(0.2)) {
+            transform->opacity = uniform(0.5f, 1.0f);
+        }
+    }
+};
+
+// ==================== 分析 ====================
+
+// 最小二乘拟合 y = a + b*x，返回斜率b，截距写入intercept
+double fitSlope(const std::vector<double>& x, const std::vector<double>& y, double* intercept) {
+    double n = static_cast<double>(x.size());
+    double sumX = std::accumulate(x.begin(), x.end(), 0.0);
+    double sumY = std::accumulate(y.begin(), y.end(), 0.0);
+    double sumXX = 0.0;
+    double sumXY = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sumXX += x[i] * x[i];
+        sumXY += x[i] * y[i];
+    }
+    double denominator = n * sumXX - sumX * sumX;
+    double slope = denominator != 0.0 ? (n * sumXY - sumX * sumY) / denominator : 0.0;
+    *intercept = (sumY - slope * sumX) / n;
+    return slope;
+}
+
+// 丢弃预热期的采样后，检查RSS增长斜率和延迟漂移，全部达标返回true
+bool analyze(const std::vector<Sample>& samples, const SoakOptions& options) {
+    size_t skip = static_cast<size_t>(samples.size() * options.warmupFraction);
+    if (samples.size() - skip < 3) {
+        std::cout << "⚠️  采样点不足，无法判断趋势（至少需要3个预热后的采样）" << std::endl;
+        return true;
+    }
+
+    std::vector<double> renders;
+    std::vector<double> rssKb;
+    std::vector<double> latency;
+    for (size_t i = skip; i < samples.size(); ++i) {
+        renders.push_back(static_cast<double>(samples[i].renders));
+        rssKb.push_back(samples[i].rssBytes / 1024.0);
+        latency.push_back(samples[i].p50Ms);
+    }
+
+    double rssIntercept = 0.0;
+    double rssSlope = fitSlope(renders, rssKb, &rssIntercept) * 1000.0;   // KB / 1000次渲染
+
+    double latencyIntercept = 0.0;
+    double latencySlope = fitSlope(renders, latency, &latencyIntercept);
+    double latencyStart = latencyIntercept + latencySlope * renders.front();
+    double latencyEnd = latencyIntercept + latencySlope * renders.back();
+    double drift = latencyStart > 0.0 ? (latencyEnd - latencyStart) / latencyStart : 0.0;
+
+    bool rssOk = rssSlope <= options.maxRssSlopeKb;
+    bool latencyOk = drift <= options.maxLatencyDrift;
+
+    std::printf("\n=== 趋势（丢弃前%zu个预热采样） ===\n", skip);
+    std::printf("%s RSS增长斜率: %.2f KB/千次 (上限 %.2f)\n", rssOk ? "✅" : "❌", rssSlope, options.maxRssSlopeKb);
+    std::printf("%s p50延迟漂移: %.2f ms -> %.2f ms (%+.1f%%, 上限 %+.1f%%)\n", latencyOk ? "✅" : "❌",
+                latencyStart, latencyEnd, drift * 100.0, options.maxLatencyDrift * 100.0);
+    return rssOk && latencyOk;
+}
+
+bool writeCsv(const std::string& path, const std::vector<Sample>& samples) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "renders,elapsed_s,rss_bytes,resource_cache_bytes,font_cache_bytes,font_cache_count,"
+           "surface_pool_idle_bytes,image_cache_bytes,p50_ms,p99_ms,renders_per_s\n";
+    for (const auto& sample : samples) {
+        out << sample.renders << ',' << sample.elapsedSeconds << ',' << sample.rssBytes << ','
+            << sample.resourceCacheBytes << ',' << sample.fontCacheBytes << ',' << sample.fontCacheCount << ','
+            << sample.surfacePoolIdleBytes << ',' << sample.imageCacheBytes << ',' << sample.p50Ms << ',' << sample.p99Ms << ','
+            << sample.rendersPerSecond << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+void printUsage(const char* program) {
+    std::cout << "用法: " << program << " [选项] [protocol.json...]\n"
+              << "  --renders N           渲染总次数（默认200000）\n"
+              << "  --minutes M           最长运行时间，到时提前结束（默认不限）\n"
+              << "  --sample-every N      每N次渲染采样一次（默认500）\n"
+              << "  --warmup-fraction F   拟合趋势前丢弃的采样比例（默认0.1）\n"
+              << "  --max-rss-slope KB    每千次渲染允许的RSS增长（默认16KB）\n"
+              << "  --max-latency-drift F 允许的p50延迟相对增长（默认0.25）\n"
+              << "  --seed N              变体随机种子（默认1）\n"
+              << "  --csv FILE            把采样写成CSV\n"
+              << "  --projects DIR        协议搜索目录（默认projects）\n";
+}
+
+bool parseOptions(int argc, char* argv[], SoakOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--renders" && hasValue) {
+            options->renders = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--minutes" && hasValue) {
+            options->maxMinutes = std::atof(argv[++i]);
+        } else if (arg == "--sample-every" && hasValue) {
+            options->sampleEvery = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup-fraction" && hasValue) {
+            options->warmupFraction = std::min(0.9, std::max(0.0, std::atof(argv[++i])));
+        } else if (arg == "--max-rss-slope" && hasValue) {
+            options->maxRssSlopeKb = std::atof(argv[++i]);
+        } else if (arg == "--max-latency-drift" && hasValue) {
+            options->maxLatencyDrift = std::atof(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options->seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--csv" && hasValue) {
+            options->csvPath = argv[++i];
+        } else if (arg == "--projects" && hasValue) {
+            options->projectsDir = argv[++i];
+        } else if (arg.rfind("--", 0) == 0) {
+            return false;
+        } else {
+            options->protocolFiles.push_back(arg);
+        }
+    }
+    return options->renders > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    SoakOptions options;
+    if (!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> files = options.protocolFiles.empty()
+        ? bench::findProtocolFiles(options.projectsDir) : options.protocolFiles;
+    std::vector<RenderProtocol> bases;
+    for (const auto& file : files) {
+        ProtocolParser parser;
+        if (parser.loadFromFile(file)) {
+            bases.push_back(parser.getProtocol());
+        } else {
+            std::cout << "⚠️  跳过 " << file << ": " << parser.getErrorMessage() << std::endl;
+        }
+    }
+    if (bases.empty()) {
+        std::cerr << "❌ 没有可用的协议文件" << std::endl;
+        return 1;
+    }
+
+    std::cout << "🔥 soak: " << bases.size() << "个基础协议, " << options.renders << "次渲染, 每"
+              << options.sampleEvery << "次采样, 种子" << options.seed << std::endl;
+    std::printf("%10s %9s %9s %11s %11s %8s %10s %10s %9s %9s %8s\n", "渲染次数", "耗时(s)", "RSS(MB)",
+                "资源缓存(MB)", "字形缓存(MB)", "字形数", "Surface池(MB)", "图片缓存(MB)", "p50(ms)", "p99(ms)",
+                "张/秒");
+
+    // 整个过程只用一个引擎，模拟常驻渲染进程
+    RenderEngine engine;
+    VariantGenerator generator(std::move(bases), options.seed);
+    SkNullWStream stream;
+    StreamOutputSink sink(&stream);
+
+    std::vector<Sample> samples;
+    std::vector<double> window;
+    window.reserve(options.sampleEvery);
+    uint64_t failures = 0;
+    auto start = bench::Clock::now();
+    auto windowStart = start;
+
+    for (uint64_t serial = 1; serial <= options.renders; ++serial) {
+        RenderProtocol protocol = generator.next(serial);
+        auto renderStart = bench::Clock::now();
+        if (!engine.renderToSink(protocol, &sink)) {
+            ++failures;
+            if (failures <= 10) {
+                std::cerr << "渲染失败: " << engine.getErrorMessage() << std::endl;
+            }
+        }
+        window.push_back(bench::elapsedMs(renderStart));
+
+        if (window.size() < static_cast<size_t>(options.sampleEvery) && serial != options.renders) {
+            continue;
+        }
+
+        bench::Stats stats = bench::computeStats(window);
+        Sample sample;
+        sample.renders = serial;
+        sample.elapsedSeconds = bench::elapsedMs(start) / 1000.0;
+        sample.rssBytes = bench::currentRssBytes();
+        sample.resourceCacheBytes = SkGraphics::GetResourceCacheTotalBytesUsed();
+        sample.fontCacheBytes = SkGraphics::GetFontCacheUsed();
+        sample.fontCacheCount = SkGraphics::GetFontCacheCountUsed();
+        sample.surfacePoolIdleBytes = SurfacePool::shared().getStats().idleBytes;
+        sample.imageCacheBytes = ImageCache::shared().getStats().totalBytes;
+        sample.p50Ms = stats.p50;
+        sample.p99Ms = stats.p99;
+        sample.rendersPerSecond = window.size() / (bench::elapsedMs(windowStart) / 1000.0);
+        samples.push_back(sample);
+
+        const double mb = 1024.0 * 1024.0;
+        std::printf("%10llu %9.1f %9.1f %11.1f %11.1f %8d %10.1f %10.1f %9.2f %9.2f %8.1f\n",
+                    static_cast<unsigned long long>(sample.renders), sample.elapsedSeconds,
+                    sample.rssBytes / mb, sample.resourceCacheBytes / mb, sample.fontCacheBytes / mb,
+                    sample.fontCacheCount, sample.surfacePoolIdleBytes / mb, sample.imageCacheBytes / mb, sample.p50Ms, sample.p99Ms,
+                    sample.rendersPerSecond);
+        std::fflush(stdout);
+
+        window.clear();
+        windowStart = bench::Clock::now();
+        if (options.maxMinutes > 0.0 && sample.elapsedSeconds >= options.maxMinutes * 60.0) {
+            std::cout << "达到时间上限，提前结束" << std::endl;
+            break;
+        }
+    }
+
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, samples)) {
+        std::cerr << "❌ 无法写入 " << options.csvPath << std::endl;
+    }
+
+    bool passed = analyze(samples, options);
+    if (failures > 0) {
+        std::cout << "❌ 渲染失败 " << failures << " 次" << std::endl;
+        passed = false;
+    }
+    std::cout << (passed ? "🎉 soak通过" : "⚠️  soak未通过") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,397 @@
+#include "alloc_counter.h"
+#include "bench_util.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkSurface.h"
+
+#include "renderers/text_layout.h"
+#include "renderers/text_renderer.h"
+#include "3rdparty/json/include/nlohmann/json.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace skia_renderer;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr float kContainerWidth = 600.0f;
+constexpr float kContainerHeight = 400.0f;
+constexpr float kFontSize = 32.0f;
+
+struct BenchOptions {
+    std::string fontFamily = "SourceHanSansCN-Normal";
+    std::vector<int> lengths = {16, 64, 256, 1024};
+    std::string filter;         // 只运行名称包含该子串的用例
+    std::string jsonPath;       // 为空时不写JSON
+    int warmup = 3;
+    int iterations = 30;
+};
+
+// 一个计时用例：一个文本元素加一种布局策略
+struct TextCase {
+    std::string name;
+    TextElement element;
+    LayoutStrategy strategy = LayoutStrategy::Auto;
+    int glyphs = 0;
+};
+
+struct CaseResult {
+    bench::Stats layoutUs;
+    bench::Stats paintUs;
+    double layoutAllocations = 0.0;
+    double paintAllocations = 0.0;
+};
+
+// ==================== 语料生成 ====================
+
+const char* const kLatinWords[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do",
+    "eiusmod", "tempor", "incididunt", "ut", "labore", "et", "dolore", "magna", "aliqua", "poster",
+};
+
+// 常用汉字，按UTF-8逐字取用
+const char kCjkPool[] = "春夏秋冬山水花鸟风月青海湖旅游攻略美食甜品服装新品上市限时优惠欢迎光临品质生活温暖阳光";
+
+// UTF-8码点数，作为字形数（这里的语料没有连字和组合字符）
+int countCodePoints(const std::string& text) {
+    int count = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::vector<std::string> splitUtf8(const char* text) {
+    std::vector<std::string> chars;
+    for (const char* p = text; *p;) {
+        int length = 1;
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0xF0) {
+            length = 4;
+        } else if (c >= 0xE0) {
+            length = 3;
+        } else if (c >= 0xC0) {
+            length = 2;
+        }
+        chars.emplace_back(p, length);
+        p += length;
+    }
+    return chars;
+}
+
+std::string makeLatin(int length) {
+    std::string text;
+    for (size_t i = 0; countCodePoints(text) < length; ++i) {
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += kLatinWords[(i * 7) % (sizeof(kLatinWords) / sizeof(kLatinWords[0]))];
+    }
+    return text.substr(0, length);
+}
+
+std::string makeCjk(int length) {
+    static const std::vector<std::string> pool = splitUtf8(kCjkPool);
+    std::string text;
+    for (int i = 0; i < length; ++i) {
+        // 每12个字加一个逗号，给换行算法留出断点
+        text += (i % 12 == 11) ? "，" : pool[(i * 5) % pool.size()];
+    }
+    return text;
+}
+
+std::string makeMixed(int length) {
+    static const std::vector<std::string> pool = splitUtf8(kCjkPool);
+    std::string text;
+    int count = 0;
+    for (size_t i = 0; count < length; ++i) {
+        if (i % 2 == 0) {
+            std::string word = kLatinWords[i % (sizeof(kLatinWords) / sizeof(kLatinWords[0]))];
+            text += word + " ";
+            count += static_cast<int>(word.size()) + 1;
+        } else {
+            for (int j = 0; j < 4 && count < length; ++j, ++count) {
+                text += pool[(i + j) % pool.size()];
+            }
+        }
+    }
+    return text;
+}
+
+std::string makeText(const std::string& script, int length) {
+    if (script == "latin") {
+        return makeLatin(length);
+    }
+    if (script == "cjk") {
+        return makeCjk(length);
+    }
+    return makeMixed(length);
+}
+
+// ==================== 用例构建 ====================
+
+TextElement makeElement(const BenchOptions& options, const std::string& content, TextDisplayMode mode) {
+    TextElement element;
+    element.id = "bench";
+    element.content = content;
+    element.width = kContainerWidth;
+    element.height = kContainerHeight;
+    element.style.fontFamily = options.fontFamily;
+    element.style.fontSize = kFontSize;
+    element.style.displayMode = mode;
+    element.style.hasExplicitDisplayMode = true;
+    if (mode == TextDisplayMode::MultiLine) {
+        element.style.maxLines = 3;
+        element.style.ellipsis = true;
+    } else if (mode == TextDisplayMode::SingleLine) {
+        element.style.ellipsis = true;
+    }
+    return element;
+}
+
+// 把文本切成4个片段，交替使用不同颜色和字号
+TextElement makeRichElement(const BenchOptions& options, const std::string& content,
+                            RichTextRenderStrategy strategy) {
+    TextElement element = makeElement(options, "", TextDisplayMode::SingleLine);
+    element.richTextStrategy = strategy;
+    std::vector<std::string> chars = splitUtf8(content.c_str());
+    const SkColor colors[] = {SK_ColorBLACK, SK_ColorRED, SK_ColorBLUE, 0xFF228B22};
+    size_t segmentLength = (chars.size() + 3) / 4;
+    for (size_t start = 0, index = 0; start < chars.size(); start += segmentLength, ++index) {
+        RichTextSegment segment;
+        for (size_t i = start; i < std::min(chars.size(), start + segmentLength); ++i) {
+            segment.content += chars[i];
+        }
+        segment.fillColor = colors[index % 4];
+        segment.fontSize = index % 2 == 0 ? kFontSize : kFontSize * 0.75f;
+        element.richTextSegments.push_back(segment);
+    }
+    return element;
+}
+
+const char* modeName(TextDisplayMode mode) {
+    switch (mode) {
+        case TextDisplayMode::SingleLine: return "single";
+        case TextDisplayMode::MultiLine: return "multi";
+        case TextDisplayMode::WordWrap: return "wrap";
+        case TextDisplayMode::AutoFit: return "autofit";
+    }
+    return "?";
+}
+
+const char* strategyName(LayoutStrategy strategy) {
+    switch (strategy) {
+        case LayoutStrategy::Auto: return "auto";
+        case LayoutStrategy::Simple: return "simple";
+        case LayoutStrategy::Paragraph: return "paragraph";
+    }
+    return "?";
+}
+
+std::vector<TextCase> buildCases(const BenchOptions& options) {
+    std::vector<TextCase> cases;
+    const TextDisplayMode modes[] = {TextDisplayMode::SingleLine, TextDisplayMode::MultiLine,
+                                     TextDisplayMode::WordWrap, TextDisplayMode::AutoFit};
+    for (const char* script : {"latin", "cjk", "mixed"}) {
+        for (int length : options.lengths) {
+            std::string content = makeText(script, length);
+            std::string suffix = std::string(script) + "/" + std::to_string(length);
+
+            // 普通文本：每种显示模式分别用两种布局引擎
+            for (TextDisplayMode mode : modes) {
+                for (LayoutStrategy strategy : {LayoutStrategy::Simple, LayoutStrategy::Paragraph}) {
+                    TextCase textCase;
+                    textCase.name = std::string(strategyName(strategy)) + "/" + modeName(mode) + "/" + suffix;
+                    textCase.element = makeElement(options, content, mode);
+                    textCase.strategy = strategy;
+                    textCase.glyphs = countCodePoints(content);
+                    cases.push_back(std::move(textCase));
+                }
+            }
+
+            // 富文本：两种渲染策略
+            for (RichTextRenderStrategy strategy : {RichTextRenderStrategy::MeasureText,
+                                                    RichTextRenderStrategy::Paragraph}) {
+                TextCase textCase;
+                textCase.name = std::string(strategy == RichTextRenderStrategy::MeasureText ? "rich-measure"
+                                                                                            : "rich-paragraph")
+                                + "/" + suffix;
+                textCase.element = makeRichElement(options, content, strategy);
+                textCase.glyphs = countCodePoints(content);
+                cases.push_back(std::move(textCase));
+            }
+        }
+    }
+
+    if (!options.filter.empty()) {
+        cases.erase(std::remove_if(cases.begin(), cases.end(), [&](const TextCase& textCase) {
+            return textCase.name.find(options.filter) == std::string::npos;
+        }), cases.end());
+    }
+    return cases;
+}
+
+// ==================== 计时 ====================
+
+// 排版：把渲染录制成Picture，耗时包含字体加载、整形、换行和命令录制
+sk_sp<SkPicture> layout(TextRenderer& renderer, const TextElement& element) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(kContainerWidth * 2, kContainerHeight * 2));
+    renderer.renderText(canvas, element);
+    return recorder.finishRecordingAsPicture();
+}
+
+CaseResult runCase(TextRenderer& renderer, SkSurface* surface, const TextCase& textCase,
+                   const BenchOptions& options) {
+    renderer.setLayoutStrategy(textCase.strategy);
+    SkCanvas* canvas = surface->getCanvas();
+
+    for (int i = 0; i < options.warmup; ++i) {
+        canvas->drawPicture(layout(renderer, textCase.element));
+    }
+
+    std::vector<double> layoutUs;
+    std::vector<double> paintUs;
+    uint64_t layoutAllocations = 0;
+    uint64_t paintAllocations = 0;
+    for (int i = 0; i < options.iterations; ++i) {
+        bench::AllocSnapshot allocStart = bench::AllocCounter::snapshot();
+        auto start = bench::Clock::now();
+        sk_sp<SkPicture> picture = layout(renderer, textCase.element);
+        layoutUs.push_back(bench::elapsedMs(start) * 1000.0);
+        layoutAllocations += bench::AllocCounter::since(allocStart).count;
+
+        canvas->clear(SK_ColorWHITE);
+        allocStart = bench::AllocCounter::snapshot();
+        start = bench::Clock::now();
+        canvas->drawPicture(picture);
+        paintUs.push_back(bench::elapsedMs(start) * 1000.0);
+        paintAllocations += bench::AllocCounter::since(allocStart).count;
+    }
+
+    CaseResult result;
+    result.layoutUs = bench::computeStats(layoutUs);
+    result.paintUs = bench::computeStats(paintUs);
+    result.layoutAllocations = static_cast<double>(layoutAllocations) / options.iterations;
+    result.paintAllocations = static_cast<double>(paintAllocations) / options.iterations;
+    return result;
+}
+
+std::vector<int> parseLengths(const std::string& value) {
+    std::vector<int> lengths;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int length = std::atoi(item.c_str());
+        if (length > 0) {
+            lengths.push_back(length);
+        }
+    }
+    return lengths;
+}
+
+void printUsage(const char* program) {
+    std::cout << "用法: " << program << " [选项]\n"
+              << "  --font NAME      字体（默认SourceHanSansCN-Normal）\n"
+              << "  --lengths LIST   文本长度，逗号分隔（默认16,64,256,1024）\n"
+              << "  --filter TEXT    只运行名称包含TEXT的用例，如 paragraph/wrap 或 cjk/256\n"
+              << "  --warmup N       每个用例的预热次数（默认3）\n"
+              << "  --iterations N   每个用例的计时次数（默认30）\n"
+              << "  --json FILE      同时把结果写成JSON\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--font" && hasValue) {
+            options.fontFamily = argv[++i];
+        } else if (arg == "--lengths" && hasValue) {
+            options.lengths = parseLengths(argv[++i]);
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--warmup" && hasValue) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && hasValue) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+#ifndef NDEBUG
+    std::cout << "⚠️  Debug构建的文本渲染带有大量调试输出，计时结果仅供参考，请使用Release构建" << std::endl;
+#endif
+
+    std::vector<TextCase> cases = buildCases(options);
+    if (cases.empty()) {
+        std::cerr << "❌ 没有匹配的用例" << std::endl;
+        return 1;
+    }
+
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(
+        SkImageInfo::MakeN32Premul(static_cast<int>(kContainerWidth * 2), static_cast<int>(kContainerHeight * 2)));
+    if (!surface) {
+        std::cerr << "❌ 无法创建画布" << std::endl;
+        return 1;
+    }
+
+    TextRenderer renderer;
+    std::printf("%-36s %6s %10s %10s %10s %10s %9s %9s %10s\n", "用例", "字形", "排版p50(us)", "绘制p50(us)",
+                "排版ns/字形", "绘制ns/字形", "排版new", "绘制new", "建议引擎");
+
+    json report = json::array();
+    for (const auto& textCase : cases) {
+        CaseResult result = runCase(renderer, surface.get(), textCase, options);
+        double glyphs = std::max(1, textCase.glyphs);
+        double layoutNsPerGlyph = result.layoutUs.p50 * 1000.0 / glyphs;
+        double paintNsPerGlyph = result.paintUs.p50 * 1000.0 / glyphs;
+        // 富文本不经过布局引擎选择
+        const char* suggested = textCase.element.isRichText()
+            ? "-" : strategyName(TextFeatureAnalyzer::suggestLayoutStrategy(textCase.element));
+
+        std::printf("%-36s %6d %10.1f %10.1f %10.1f %10.1f %9.0f %9.0f %10s\n", textCase.name.c_str(),
+                    textCase.glyphs, result.layoutUs.p50, result.paintUs.p50, layoutNsPerGlyph,
+                    paintNsPerGlyph, result.layoutAllocations, result.paintAllocations, suggested);
+
+        report.push_back({
+            {"name", textCase.name},
+            {"glyphs", textCase.glyphs},
+            {"layoutUs", {{"p50", result.layoutUs.p50}, {"p95", result.layoutUs.p95}, {"mean", result.layoutUs.mean}}},
+            {"paintUs", {{"p50", result.paintUs.p50}, {"p95", result.paintUs.p95}, {"mean", result.paintUs.mean}}},
+            {"layoutNsPerGlyph", layoutNsPerGlyph},
+            {"paintNsPerGlyph", paintNsPerGlyph},
+            {"layoutAllocations", result.layoutAllocations},
+            {"paintAllocations", result.paintAllocations},
+            {"suggestedStrategy", suggested},
+        });
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream out(options.jsonPath);
+        if (!out || !(out << report.dump(2) << std::endl)) {
+            std::cerr << "❌ 无法写入 " << options.jsonPath << std::endl;
+            return 1;
+        }
+        std::cout << "\n结果已写入 " << options.jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -50,6 +50,17 @@ if [ $? -eq 0 ]; then
     echo "  - 渲染器: ./build/simple_example"
     echo "  - 文本样式演示: ./build/text_styles_demo"
     echo "  - 简单测试: ./build/simple_image_test"
+    echo "  - 并行编码测试: ./build/parallel_encoder_test"
+    echo "  - 分块光栅化测试: ./build/tiled_raster_test"
+    echo "  - 区域解码测试: ./build/image_decode_test"
+    echo "  - 字体索引测试: ./build/font_index_test"
+    echo "  - 端到端基准: ./build/poster_bench"
+    echo "  - 文本微基准: ./build/text_bench"
+    echo "  - 编解码基准: ./build/codec_bench"
+    echo "  - 长时间运行测试: ./build/soak_bench"
+    echo "  - 绘制回放基准: ./build/replay_bench <capture.skp>"
+    echo "  - 资源包工具: ./build/asset_bundle build -o <out.bundle> <目录>..."
+    echo "  - 精灵图集工具: ./build/sprite_atlas -o <输出前缀> <目录>..."
 else
     echo "=== 构建失败！ ==="
     exit 1
@@ -10,17 +10,31 @@ int main(int argc, char *argv[]) {
     }
 
     // 如果提供了命令行参数，渲染指定的协议文件
+    // 多个文件时开启异步编码：编码在后台进行，渲染线程直接开始下一张
     if (argc > 1) {
-        std::string protocolFile = argv[1];
-        std::cout << "渲染协议文件: " << protocolFile << std::endl;
-
         skia_renderer::RenderEngine engine;
-        if (engine.renderFromProtocol(protocolFile)) {
-            std::cout << "✅ 渲染成功！" << std::endl;
-        } else {
-            std::cerr << "❌ 渲染失败: " << engine.getErrorMessage() << std::endl;
+        if (argc > 2) {
+            engine.setAsyncEncode(true);
+        }
+
+        int failures = 0;
+        for (int i = 1; i < argc; ++i) {
+            std::string protocolFile = argv[i];
+            std::cout << "渲染协议文件: " << protocolFile << std::endl;
+            if (!engine.renderFromProtocol(protocolFile)) {
+                std::cerr << "❌ 渲染失败: " << engine.getErrorMessage() << std::endl;
+                ++failures;
+            }
+        }
+
+        if (!engine.waitForOutputs()) {
+            std::cerr << "❌ 输出失败: " << engine.getErrorMessage() << std::endl;
+            ++failures;
+        }
+        if (failures > 0) {
             return 1;
         }
+        std::cout << "✅ 渲染成功！" << std::endl;
         return 0;
     }
 
@@ -1,7 +1,7 @@
 #!/bin/bash
 
 # 简单图片对比测试脚本
-# 不修改任何现有源码，独立运行
+# 进程内并行渲染所有测试项目并与基线对比
 
 set -e  # 遇到错误立即退出
 
@@ -18,12 +18,10 @@ fi
 # 创建必要的目录
 mkdir -p tests/baseline
 mkdir -p tests/diff
-mkdir -p output
 
 echo "📁 目录结构:"
 echo "  - tests/baseline/  : 基线图片"
 echo "  - tests/diff/      : 差异图片"
-echo "  - output/          : 当前输出"
 echo ""
 
 # 运行一致性测试（检查渲染是否确定）
@@ -41,7 +39,8 @@ done
 echo "🔄 运行完整图片对比测试..."
 echo ""
 
-./build/simple_image_test run
+status=0
+./build/simple_image_test run || status=$?
 
 echo ""
 echo "=== 测试完成 ==="
@@ -65,11 +64,13 @@ echo ""
 echo "💡 使用说明:"
 echo "  - 运行测试: ./run_simple_test.sh"
 echo "  - 更新基线: ./build/simple_image_test update <project_name>"
-echo "  - 设置容差: ./build/simple_image_test tolerance <value>"
+echo "  - 指定容差运行: ./build/simple_image_test tolerance <value>"
 echo "  - 一致性测试: ./build/simple_image_test consistency <project_name> [iterations]"
 echo ""
 echo "🎯 特点:"
-echo "  - 不修改任何现有源码"
-echo "  - 独立运行渲染程序"
-echo "  - 纯单元测试设计"
-echo "  - 覆盖14个测试项目（包含4种文本模式）" 
\ No newline at end of file
+echo "  - 进程内渲染，不依赖外部渲染程序"
+echo "  - 测试用例并行执行"
+echo "  - SIMD像素对比，报告最大通道差、PSNR和差异区域"
+echo "  - 覆盖14个测试项目（包含4种文本模式）" 
+
+exit $status
@@ -16,12 +16,25 @@ struct Transform {
     float opacity = 1.0f;   // 透明度 (0.0-1.0)，1.0=完全不透明，0.5=半透明，0.0=完全透明
 };
 
+// 图片采样方式 - 图片缩放绘制时的插值方法
+enum class ImageSampling {
+    Inherit,        // 跟随画布的imageSampling（仅用于图片元素）
+    Nearest,        // 最近邻：最快，缩放时有锯齿
+    Linear,         // 双线性：轻度缩放
+    Mipmap,         // 双线性+mipmap：大幅缩小时避免摩尔纹
+    Cubic,          // 双三次（Mitchell）：放大时最平滑
+    Auto            // 按实际缩放比例自动选择
+};
+
 // 画布配置 - 定义渲染画布的尺寸、背景色和调试选项
 struct CanvasConfig {
     int width = 1242;                    // 画布宽度 (像素)，最终图片的宽度
     int height = 1660;                   // 画布高度 (像素)，最终图片的高度
     std::string background = "#FFFFFF";  // 背景颜色，支持#RRGGBB、rgb()、rgba()等格式
     bool debug = false;                  // 调试模式，true时显示文本区域的红色边框
+    bool tiledRaster = false;            // 分块并行光栅化：录制为SkPicture后按水平条带多线程回放，适合大画布
+    int tileCount = 0;                   // 分块数，0表示按线程数和画布高度自动选择
+    ImageSampling imageSampling = ImageSampling::Nearest; // 图片元素默认的采样方式
 };
 
 // 图片元素 - 定义要渲染的图片及其属性
@@ -31,6 +44,7 @@ struct ImageElement {
     Transform transform;    // 变换属性（位置、缩放、旋转、透明度）
     int width = 0;          // 显示宽度 (像素)，0表示使用图片原始宽度
     int height = 0;         // 显示高度 (像素)，0表示使用图片原始高度
+    ImageSampling sampling = ImageSampling::Inherit; // 采样方式，Inherit表示跟随画布设置
 };
 
 // 文本显示模式 - 定义文本的布局和显示策略
@@ -100,9 +114,18 @@ struct TextElement {
 
 // 输出配置 - 定义渲染结果的保存格式和参数
 struct OutputConfig {
-    std::string format = "png";           // 输出格式："png"(无损)或"jpeg"(有损)
+    std::string format = "";              // 输出格式："png"(无损)、"jpeg"(有损)或"webp"，空表示根据文件扩展名推断
     std::string filename = "output.png";  // 输出文件名，包含扩展名
-    int quality = 100;                    // 输出质量 (1-100)，仅对JPEG格式有效
+    int quality = 100;                    // 输出质量 (1-100)，对JPEG和有损WebP有效；无损WebP时表示压缩力度
+    std::string profile = "";             // 编码预设："fast"(最快)、"balanced"(均衡)、"smallest"(最小体积)，空表示balanced
+    int compressionLevel = -1;            // PNG的zlib压缩级别 (0-9)，-1表示跟随预设
+    std::string pngFilter = "";           // PNG行过滤器，如"sub"或"sub,paeth"，可选none/sub/up/avg/paeth/all，空表示跟随预设
+    std::string chromaSubsampling = "";   // JPEG色度采样："420"、"422"、"444"，空表示4:2:0
+    bool lossless = false;                // WebP是否使用无损压缩
+    bool dropAlpha = true;                // 图像完全不透明时去掉alpha通道（PNG写RGB，WebP不写alpha）
+    bool parallelEncode = false;          // PNG/JPEG按水平条带并行编码，适合大尺寸输出
+    int width = 0;                        // 输出宽度，0表示跟随画布（只设置高度时按比例计算）
+    int height = 0;                       // 输出高度，0表示跟随画布（只设置宽度时按比例计算）
 };
 
 // 完整渲染协议 - 包含一次完整渲染所需的所有配置和元素
@@ -110,7 +133,7 @@ struct RenderProtocol {
     CanvasConfig canvas;                  // 画布配置（尺寸、背景、调试）
     std::vector<ImageElement> images;     // 图片元素列表，按顺序渲染（后渲染的在上层）
     std::vector<TextElement> texts;       // 文本元素列表，按顺序渲染（后渲染的在上层）
-    OutputConfig output;                  // 输出配置（格式、文件名、质量）
+    std::vector<OutputConfig> outputs = {OutputConfig()}; // 输出列表，一次渲染编码出所有格式和尺寸
 };
 
 } // namespace skia_renderer 
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+
+namespace skia_renderer {
+
+// 渲染器版本 - 任何会改变渲染结果像素或编码字节的修改都需要递增，
+// 结果缓存以此区分不同版本产生的输出
+constexpr const char* kRendererVersion = "1.1.0";
+
+} // namespace skia_renderer
@@ -1,18 +1,42 @@
 #include "engine/render_engine.h"
+#include "renderers/tiled_rasterizer.h"
+#include "utils/picture_capture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkBBHFactory.h"
+#include <chrono>
 #include <iostream>
+#include <set>
 
 namespace skia_renderer {
 
+namespace {
+
+using StageClock = std::chrono::steady_clock;
+
+double elapsedMs(StageClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(StageClock::now() - start).count();
+}
+
+} // namespace
+
 RenderEngine::RenderEngine() {
     // 初始化组件
     protocolParser = std::make_unique<ProtocolParser>();
     canvasRenderer = std::make_unique<CanvasRenderer>();
     imageRenderer = std::make_unique<ImageRenderer>();
+    imageSource = std::make_shared<ImageSource>();
+    imageRenderer->setImageSource(imageSource);
     textRenderer = std::make_unique<TextRenderer>();
     imageWriter = std::make_unique<ImageWriter>();
+    
+    // 默认将所有输出文件保存到根目录的output文件夹下
+    outputSink = std::make_shared<FileOutputSink>("output/");
+    captureEnabled = false;
 }
 
 RenderEngine::~RenderEngine() {
+    // 编码回调会访问asyncMutex/asyncErrors，必须在它们析构前等待编码线程退出
+    asyncEncoder.reset();
 }
 
 bool RenderEngine::renderFromProtocol(const std::string& protocolFile) {
@@ -25,38 +49,197 @@ bool RenderEngine::renderFromProtocol(const std::string& protocolFile) {
 }
 
 bool RenderEngine::renderFromProtocol(const RenderProtocol& protocol) {
+    if (asyncEncoder) {
+        return submitAsync(protocol);
+    }
+    
+    if (!renderToSink(protocol, outputSink.get())) {
+        return false;
+    }
+    
+    for (const auto& output : protocol.outputs) {
+        std::cout << "海报已保存为" << output.filename << std::endl;
+    }
+    return true;
+}
+
+bool RenderEngine::renderToSink(const RenderProtocol& protocol, OutputSink* sink) {
+    // 命中结果缓存时直接写出已编码的数据，不经过Skia
+    std::string cacheKey;
+    std::vector<sk_sp<SkData>> cached;
+    if (lookupResultCache(protocol, &cacheKey, &cached)) {
+        lastTimings = RenderStageTimings();
+        return writeCachedOutputs(protocol.outputs, cached, sink);
+    }
+    
+    sk_sp<SkPicture> capture;
+    sk_sp<SkImage> image = rasterize(protocol, captureEnabled ? &capture : nullptr);
+    if (!image) {
+        return false;
+    }
+    
+    if (capture && !writeCapture(capture, protocol, sink)) {
+        return false;
+    }
+    
+    auto encodeStart = StageClock::now();
+    if (cacheKey.empty()) {
+        bool success = saveOutputs(image, protocol.outputs, sink);
+        lastTimings.encodeMs = elapsedMs(encodeStart);
+        return success;
+    }
+    
+    // 保存输出，同时留下编码数据写入缓存
+    RecordingOutputSink recording(sink);
+    if (!saveOutputs(image, protocol.outputs, &recording)) {
+        return false;
+    }
+    lastTimings.encodeMs = elapsedMs(encodeStart);
+    storeResultCache(resultCache.get(), cacheKey, protocol.outputs, recording);
+    return true;
+}
+
+bool RenderEngine::renderToData(const RenderProtocol& protocol, sk_sp<SkData>* encodedData) {
+    if (!encodedData) {
+        errorMessage = "输出参数为空";
+        return false;
+    }
+    
+    if (protocol.outputs.empty()) {
+        errorMessage = "没有输出配置";
+        return false;
+    }
+    
+    MemoryOutputSink sink;
+    if (!renderToSink(protocol, &sink)) {
+        return false;
+    }
+    
+    *encodedData = sink.getData(protocol.outputs.front().filename);
+    return *encodedData != nullptr;
+}
+
+sk_sp<SkImage> RenderEngine::renderToImage(const RenderProtocol& protocol) {
+    return rasterize(protocol);
+}
+
+bool RenderEngine::renderToStream(const RenderProtocol& protocol, SkWStream* stream) {
+    if (!stream) {
+        errorMessage = "输出流为空";
+        return false;
+    }
+    
+    StreamOutputSink sink(stream);
+    return renderToSink(protocol, &sink);
+}
+
+sk_sp<SkImage> RenderEngine::rasterize(const RenderProtocol& protocol, sk_sp<SkPicture>* capture) {
+    lastTimings = RenderStageTimings();
+    
+    // 协议解析完成后先在线程池上并发解码所有图片，绘制阶段不再因解码停顿
+    auto decodeStart = StageClock::now();
+    prefetchUrls(protocol);
+    imageRenderer->setDefaultSampling(protocol.canvas.imageSampling);
+    bool prefetched = imageRenderer->prefetchImages(protocol.images,
+                                                    SkISize::Make(protocol.canvas.width, protocol.canvas.height));
+    lastTimings.decodeMs = elapsedMs(decodeStart);
+    if (!prefetched) {
+        errorMessage = imageRenderer->getErrorMessage();
+        return nullptr;
+    }
+    
     // 创建画布
+    auto canvasStart = StageClock::now();
     if (!canvasRenderer->createCanvas(protocol.canvas.width, protocol.canvas.height)) {
         errorMessage = "无法创建画布";
-        return false;
+        return nullptr;
     }
+    lastTimings.canvasMs = elapsedMs(canvasStart);
     
-    // 渲染画布背景
-    if (!renderCanvas(protocol.canvas)) {
-        return false;
+    if (protocol.canvas.tiledRaster || capture) {
+        // 先录制为带R-tree的Picture，再回放到画布（分块模式下按条带并行回放）
+        sk_sp<SkPicture> picture = recordPicture(protocol);
+        if (!picture) {
+            return nullptr;
+        }
+        
+        auto replayStart = StageClock::now();
+        if (protocol.canvas.tiledRaster) {
+            SkPixmap pixmap;
+            if (!canvasRenderer->getSurface()->peekPixels(&pixmap) ||
+                !TiledRasterizer::replay(picture.get(), pixmap, protocol.canvas.tileCount)) {
+                errorMessage = "分块光栅化失败";
+                return nullptr;
+            }
+        } else {
+            canvasRenderer->getCanvas()->drawPicture(picture);
+        }
+        lastTimings.replayMs = elapsedMs(replayStart);
+        
+        if (capture) {
+            *capture = std::move(picture);
+        }
+    } else if (!drawContent(canvasRenderer->getCanvas(), protocol)) {
+        return nullptr;
     }
     
-    // 渲染图片元素
-    if (!renderImages(protocol.images)) {
+    // 取走像素所有权，编码期间渲染线程可以直接开始下一张
+    imageRenderer->clearPrefetched();
+    sk_sp<SkImage> image = canvasRenderer->detachImage();
+    if (!image) {
+        errorMessage = "图像为空";
+    }
+    return image;
+}
+
+sk_sp<SkPicture> RenderEngine::recordPicture(const RenderProtocol& protocol) {
+    SkRTreeFactory rtreeFactory;
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(
+        SkRect::MakeIWH(protocol.canvas.width, protocol.canvas.height), &rtreeFactory);
+    
+    if (!drawContent(canvas, protocol)) {
+        return nullptr;
+    }
+    
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    if (!picture) {
+        errorMessage = "Picture录制失败";
+    }
+    return picture;
+}
+
+bool RenderEngine::drawContent(SkCanvas* canvas, const RenderProtocol& protocol) {
+    if (!canvas) {
+        errorMessage = "画布未初始化";
         return false;
     }
     
-    // 渲染文本元素
-    if (!renderTexts(protocol.texts)) {
+    // 渲染画布背景
+    auto stageStart = StageClock::now();
+    if (!renderCanvas(canvas, protocol.canvas)) {
         return false;
     }
+    lastTimings.canvasMs += elapsedMs(stageStart);
     
-    // 保存输出
-    sk_sp<SkImage> image = canvasRenderer->makeImageSnapshot();
-    if (!saveOutput(image, protocol.output)) {
+    // 渲染图片元素
+    stageStart = StageClock::now();
+    if (!renderImages(canvas, protocol.images)) {
         return false;
     }
+    lastTimings.imagesMs = elapsedMs(stageStart);
     
-    std::cout << "海报已保存为" << protocol.output.filename << std::endl;
-    return true;
+    // 渲染文本元素
+    stageStart = StageClock::now();
+    bool success = renderTexts(canvas, protocol.texts, protocol.canvas.debug);
+    lastTimings.textsMs = elapsedMs(stageStart);
+    return success;
 }
 
 void RenderEngine::setFontManager(std::shared_ptr<FontManager> fontManager) {
+    if (fontManager && imageSource->getAssetBundle()) {
+        fontManager->setAssetBundle(imageSource->getAssetBundle());
+    }
     textRenderer->setFontManager(fontManager);
 }
 
@@ -64,37 +247,275 @@ std::shared_ptr<FontManager> RenderEngine::getFontManager() const {
     return textRenderer->getFontManager();
 }
 
-bool RenderEngine::renderCanvas(const CanvasConfig& canvasConfig) {
-    return canvasRenderer->setBackground(canvasConfig.background);
+void RenderEngine::setOutputSink(std::shared_ptr<OutputSink> sink) {
+    outputSink = sink;
 }
 
-bool RenderEngine::renderImages(const std::vector<ImageElement>& images) {
-    SkCanvas* canvas = canvasRenderer->getCanvas();
-    if (!canvas) {
-        errorMessage = "画布未初始化";
+void RenderEngine::setDecodeBudget(size_t maxImageBytes, size_t maxRenderBytes) {
+    imageRenderer->setDecodeBudget(maxImageBytes, maxRenderBytes);
+}
+
+void RenderEngine::setAssetBundle(std::shared_ptr<const AssetBundle> bundle) {
+    imageSource->setAssetBundle(bundle);
+    imageRenderer->clearPrefetched();
+    if (auto fontManager = getFontManager()) {
+        fontManager->setAssetBundle(bundle);
+    }
+}
+
+std::shared_ptr<const AssetBundle> RenderEngine::getAssetBundle() const {
+    return imageSource->getAssetBundle();
+}
+
+void RenderEngine::setUrlCache(std::shared_ptr<UrlCache> cache) {
+    imageSource->setUrlCache(std::move(cache));
+    imageRenderer->clearPrefetched();
+}
+
+std::shared_ptr<UrlCache> RenderEngine::getUrlCache() const {
+    return imageSource->getUrlCache();
+}
+
+bool RenderEngine::loadSpriteAtlas(const std::string& indexPath) {
+    std::string error;
+    std::shared_ptr<SpriteAtlas> atlas = SpriteAtlas::load(indexPath, &error);
+    if (!atlas) {
+        errorMessage = error;
+        return false;
+    }
+    addSpriteAtlas(atlas);
+    return true;
+}
+
+void RenderEngine::addSpriteAtlas(std::shared_ptr<const SpriteAtlas> atlas) {
+    if (atlas) {
+        spriteAtlases.push_back(std::move(atlas));
+        imageRenderer->setSpriteAtlases(spriteAtlases);
+    }
+}
+
+void RenderEngine::clearSpriteAtlases() {
+    spriteAtlases.clear();
+    imageRenderer->setSpriteAtlases(spriteAtlases);
+}
+
+void RenderEngine::registerImageData(const std::string& name, sk_sp<SkData> data) {
+    imageSource->registerData(name, std::move(data));
+}
+
+bool RenderEngine::unregisterImageData(const std::string& name) {
+    return imageSource->unregisterData(name);
+}
+
+void RenderEngine::clearImageData() {
+    imageSource->clearData();
+}
+
+void RenderEngine::setCaptureEnabled(bool enabled) {
+    captureEnabled = enabled;
+}
+
+bool RenderEngine::writeCapture(const sk_sp<SkPicture>& picture, const RenderProtocol& protocol, OutputSink* sink) {
+    if (!sink || protocol.outputs.empty()) {
+        errorMessage = "捕获输出失败: 没有输出目标";
         return false;
     }
     
-    for (const auto& img : images) {
-        if (!imageRenderer->renderImage(canvas, img)) {
-            errorMessage = "图片渲染失败: " + img.path;
+    std::string name = PictureCapture::captureName(protocol.outputs.front().filename);
+    bool success = sink->write(name, [&](SkWStream* out) {
+        return PictureCapture::serialize(picture.get(), out);
+    });
+    if (!success) {
+        errorMessage = "捕获输出失败: " + name + ": " + sink->getErrorMessage();
+        return false;
+    }
+    std::cout << "绘制命令已捕获到" << name << std::endl;
+    return true;
+}
+
+void RenderEngine::setResultCache(std::shared_ptr<ResultCache> cache) {
+    resultCache = cache;
+}
+
+bool RenderEngine::submitAsync(const RenderProtocol& protocol) {
+    std::string cacheKey;
+    std::vector<sk_sp<SkData>> cached;
+    if (lookupResultCache(protocol, &cacheKey, &cached)) {
+        if (!writeCachedOutputs(protocol.outputs, cached, outputSink.get())) {
             return false;
         }
+        for (const auto& output : protocol.outputs) {
+            std::cout << "海报已保存为" << output.filename << std::endl;
+        }
+        return true;
+    }
+    
+    sk_sp<SkPicture> capture;
+    sk_sp<SkImage> image = rasterize(protocol, captureEnabled ? &capture : nullptr);
+    if (!image) {
+        return false;
+    }
+    
+    if (capture && !writeCapture(capture, protocol, outputSink.get())) {
+        return false;
     }
     
+    // 编码任务持有输出目标，期间调用setOutputSink不会影响已提交的任务
+    std::shared_ptr<OutputSink> target = outputSink;
+    std::shared_ptr<RecordingOutputSink> recording;
+    std::shared_ptr<OutputSink> sink = target;
+    if (!cacheKey.empty()) {
+        recording = std::make_shared<RecordingOutputSink>(target.get());
+        sink = recording;
+    }
+    
+    std::shared_ptr<ResultCache> cache = resultCache;
+    std::vector<OutputConfig> outputs = protocol.outputs;
+    bool submitted = asyncEncoder->submit(std::move(image), outputs, sink,
+        [this, target, recording, cache, cacheKey, outputs](bool success, const std::string& error) {
+            if (success && recording) {
+                storeResultCache(cache.get(), cacheKey, outputs, *recording);
+            }
+            
+            std::lock_guard<std::mutex> lock(asyncMutex);
+            if (!success) {
+                asyncErrors.push_back(error);
+                return;
+            }
+            for (const auto& output : outputs) {
+                std::cout << "海报已保存为" << output.filename << std::endl;
+            }
+        });
+    if (!submitted) {
+        errorMessage = "异步编码器已关闭";
+        return false;
+    }
     return true;
 }
 
-bool RenderEngine::renderTexts(const std::vector<TextElement>& texts) {
-    SkCanvas* canvas = canvasRenderer->getCanvas();
-    if (!canvas) {
-        errorMessage = "画布未初始化";
+bool RenderEngine::lookupResultCache(const RenderProtocol& protocol, std::string* key,
+                                     std::vector<sk_sp<SkData>>* cached) {
+    key->clear();
+    if (!resultCache) {
         return false;
     }
     
-    // 获取debug模式
-    bool debugMode = protocolParser->getProtocol().canvas.debug;
+    // 缓存键需要URL的内容哈希，先并发下载，避免逐个计算时串行等待
+    prefetchUrls(protocol);
     
+    ResultCacheEngineState engineState;
+    engineState.maxImageDecodeBytes = imageRenderer->getMaxImageDecodeBytes();
+    engineState.maxRenderDecodeBytes = imageRenderer->getMaxRenderDecodeBytes();
+    for (const auto& atlas : spriteAtlases) {
+        engineState.spriteAtlases.push_back({atlas->getIndexPath(), atlas->getContentHash()});
+    }
+    
+    // 资源文件无法读取时不使用缓存，交给正常渲染流程报错
+    if (!resultCache->computeKey(protocol, getFontManager().get(), key, imageSource.get(), engineState)) {
+        key->clear();
+        return false;
+    }
+    // 捕获需要真正绘制一遍，不查缓存；保留缓存键，渲染结果照常写入缓存
+    if (captureEnabled) {
+        return false;
+    }
+    return resultCache->lookup(*key, protocol.outputs.size(), cached);
+}
+
+void RenderEngine::prefetchUrls(const RenderProtocol& protocol) {
+    std::vector<std::string> paths;
+    for (const auto& image : protocol.images) {
+        paths.push_back(image.path);
+    }
+    // 下载失败的图片在解码阶段报告错误
+    imageSource->prefetchUrls(paths);
+}
+
+void RenderEngine::storeResultCache(ResultCache* cache, const std::string& key,
+                                    const std::vector<OutputConfig>& outputs,
+                                    const RecordingOutputSink& recording) {
+    // 录制的数据按文件名区分，文件名重复时无法确定每个输出对应的数据，不缓存
+    std::set<std::string> filenames;
+    std::vector<sk_sp<SkData>> encoded;
+    for (const auto& output : outputs) {
+        if (!filenames.insert(output.filename).second) {
+            return;
+        }
+        sk_sp<SkData> data = recording.getData(output.filename);
+        if (!data) {
+            return;
+        }
+        encoded.push_back(std::move(data));
+    }
+    // 写缓存失败不影响本次渲染结果
+    cache->store(key, encoded);
+}
+
+bool RenderEngine::writeCachedOutputs(const std::vector<OutputConfig>& outputs,
+                                      const std::vector<sk_sp<SkData>>& cached, OutputSink* sink) {
+    if (!sink) {
+        errorMessage = "输出目标为空";
+        return false;
+    }
+    
+    for (size_t i = 0; i < outputs.size() && i < cached.size(); ++i) {
+        if (!writeEncodedData(sink, outputs[i].filename, cached[i])) {
+            errorMessage = "图片输出失败: " + outputs[i].filename + ": " + sink->getErrorMessage();
+            return false;
+        }
+    }
+    return true;
+}
+
+void RenderEngine::setAsyncEncode(bool enabled, int workerCount, size_t queueCapacity) {
+    // 先等待并销毁旧的编码器，已提交的任务不会丢失
+    asyncEncoder.reset();
+    if (enabled) {
+        asyncEncoder = std::make_unique<AsyncEncoder>(workerCount, queueCapacity);
+    }
+}
+
+bool RenderEngine::waitForOutputs() {
+    if (asyncEncoder) {
+        asyncEncoder->waitIdle();
+    }
+    
+    std::lock_guard<std::mutex> lock(asyncMutex);
+    if (asyncErrors.empty()) {
+        return true;
+    }
+    
+    errorMessage = "图片输出失败: " + asyncErrors.front();
+    if (asyncErrors.size() > 1) {
+        errorMessage += " (共" + std::to_string(asyncErrors.size()) + "个失败)";
+    }
+    asyncErrors.clear();
+    return false;
+}
+
+bool RenderEngine::renderCanvas(SkCanvas* canvas, const CanvasConfig& canvasConfig) {
+    return canvasRenderer->setBackground(canvas, canvasConfig.background);
+}
+
+bool RenderEngine::renderImages(SkCanvas* canvas, const std::vector<ImageElement>& images) {
+    for (size_t i = 0; i < images.size();) {
+        // 图集中连续的装饰元素一次drawAtlas画完
+        size_t sprites = imageRenderer->renderSprites(canvas, images, i);
+        if (sprites > 0) {
+            i += sprites;
+            continue;
+        }
+        const ImageElement& img = images[i++];
+        if (!imageRenderer->renderImage(canvas, img)) {
+            errorMessage = "图片渲染失败: " + ImageSource::displayName(img.path);
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool RenderEngine::renderTexts(SkCanvas* canvas, const std::vector<TextElement>& texts, bool debugMode) {
     for (const auto& text : texts) {
         if (!textRenderer->renderText(canvas, text, debugMode)) {
             errorMessage = "文本渲染失败: " + text.content;
@@ -105,16 +526,12 @@ bool RenderEngine::renderTexts(const std::vector<TextElement>& texts) {
     return true;
 }
 
-bool RenderEngine::saveOutput(sk_sp<SkImage> image, const OutputConfig& outputConfig) {
-    if (!image) {
-        errorMessage = "图像为空";
+bool RenderEngine::saveOutputs(sk_sp<SkImage> image, const std::vector<OutputConfig>& outputs, OutputSink* sink) {
+    if (!imageWriter->writeImages(image, outputs, sink)) {
+        errorMessage = "图片输出失败: " + imageWriter->getErrorMessage();
         return false;
     }
-    
-    // 将所有输出文件保存到根目录的output文件夹下
-    std::string outputPath = "output/" + outputConfig.filename;
-    
-    return imageWriter->saveImage(image, outputPath, outputConfig.quality);
+    return true;
 }
 
 } // namespace skia_renderer 
\ No newline at end of file
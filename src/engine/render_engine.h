@@ -1,16 +1,35 @@
 #pragma once
 
 #include "core/types.h"
+#include "engine/result_cache.h"
 #include "parsers/protocol_parser.h"
 #include "renderers/canvas_renderer.h"
 #include "renderers/image_renderer.h"
 #include "renderers/text_renderer.h"
+#include "output/async_encoder.h"
 #include "output/image_writer.h"
+#include "output/output_sink.h"
+#include "include/core/SkPicture.h"
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace skia_renderer {
 
+// 最近一次渲染各阶段的耗时（毫秒）
+// 录制模式（分块光栅化或绘制捕获）下前三项是录制耗时，真正的光栅化计入replayMs
+struct RenderStageTimings {
+    double decodeMs = 0.0;      // 图片预取：并发读取与解码（命中ImageCache时接近0）
+    double canvasMs = 0.0;      // 创建画布、绘制背景
+    double imagesMs = 0.0;      // 图片绘制（未预取到的图片在这里加载和解码）
+    double textsMs = 0.0;       // 文本排版与绘制
+    double replayMs = 0.0;      // Picture回放
+    double encodeMs = 0.0;      // 缩放、编码与写出（异步编码时为0）
+    
+    double totalMs() const { return decodeMs + canvasMs + imagesMs + textsMs + replayMs + encodeMs; }
+};
+
 class RenderEngine {
 public:
     RenderEngine();
@@ -22,6 +41,18 @@ public:
     // 从协议对象渲染
     bool renderFromProtocol(const RenderProtocol& protocol);
     
+    // 渲染一次并把所有输出写到指定的输出目标（不影响默认输出目标）
+    bool renderToSink(const RenderProtocol& protocol, OutputSink* sink);
+    
+    // 渲染并返回第一个输出编码后的图片数据，不经过文件系统
+    bool renderToData(const RenderProtocol& protocol, sk_sp<SkData>* encodedData);
+    
+    // 渲染并返回画布快照，不编码也不写任何输出（不经过结果缓存），失败返回nullptr
+    sk_sp<SkImage> renderToImage(const RenderProtocol& protocol);
+    
+    // 渲染并直接编码进调用方提供的流（socket、管道、共享内存等），多个输出依次写入
+    bool renderToStream(const RenderProtocol& protocol, SkWStream* stream);
+    
     // 获取错误信息
     const std::string& getErrorMessage() const { return errorMessage; }
     
@@ -30,9 +61,84 @@ public:
     
     // 获取字体管理器
     std::shared_ptr<FontManager> getFontManager() const;
+    
+    // 设置默认输出目标（默认写到output/目录）
+    void setOutputSink(std::shared_ptr<OutputSink> sink);
+    
+    // 获取默认输出目标
+    std::shared_ptr<OutputSink> getOutputSink() const { return outputSink; }
+    
+    // 开启异步编码：renderFromProtocol渲染完成后把快照交给编码线程，立即返回开始下一张
+    // 编码结果需通过waitForOutputs获取；renderToSink/renderToData/renderToStream始终同步
+    void setAsyncEncode(bool enabled, int workerCount = 0, size_t queueCapacity = 2);
+    
+    // 等待所有异步编码完成，有任务失败时返回false并设置错误信息
+    bool waitForOutputs();
+    
+    // 设置结果缓存，命中时直接返回缓存的编码数据；传nullptr关闭缓存
+    void setResultCache(std::shared_ptr<ResultCache> cache);
+    
+    // 获取结果缓存
+    std::shared_ptr<ResultCache> getResultCache() const { return resultCache; }
+    
+    // 开启绘制捕获：每次渲染把完整的绘制命令流（内嵌图片和字体）写成与第一个输出同名的.skp，
+    // 可用replay_bench离线回放和分析；开启时不查结果缓存（命中就没有绘制可捕获），渲染结果仍写入缓存
+    void setCaptureEnabled(bool enabled);
+    
+    // 设置图片解码预算（像素字节数，默认单张256MB、单次渲染768MB）：渲染前只读文件头估算解码内存，
+    // 单张超出时在不小于显示尺寸的前提下降采样解码，仍超出或总量超出时渲染失败，不会分配这些像素
+    void setDecodeBudget(size_t maxImageBytes, size_t maxRenderBytes);
+    
+    // 设置资源包（AssetBundle::open得到）：包内的图片和注册字体直接从映射的数据读取，
+    // 缓存键使用打包时记录的内容哈希；包内没有的路径仍从文件系统读取。传nullptr关闭
+    void setAssetBundle(std::shared_ptr<const AssetBundle> bundle);
+    
+    // 获取当前资源包
+    std::shared_ptr<const AssetBundle> getAssetBundle() const;
+    
+    // 加载精灵图集（sprite_atlas工具生成的.atlas.json）：图集中的素材不再单独读文件和解码，
+    // 连续的图集元素用一次drawAtlas绘制；原文件已修改的精灵自动跳过。失败时返回false并设置错误信息
+    bool loadSpriteAtlas(const std::string& indexPath);
+    
+    // 添加已加载的图集（多个引擎可共享同一个图集）
+    void addSpriteAtlas(std::shared_ptr<const SpriteAtlas> atlas);
+    
+    // 移除所有图集
+    void clearSpriteAtlases();
+    
+    // 注册内存中的图片编码数据：ImageElement::path等于name时直接使用这份数据，不经过文件系统
+    // （可以用素材原路径注册来覆盖文件）。path也可以直接写data: URI。同名时替换，数据由引擎持有直到移除
+    void registerImageData(const std::string& name, sk_sp<SkData> data);
+    
+    // 移除注册的图片数据，不存在时返回false；已解码的图像仍可能留在ImageCache中，按内容哈希不会被误用
+    bool unregisterImageData(const std::string& name);
+    
+    // 移除所有注册的图片数据
+    void clearImageData();
+    
+    // 设置http(s)图片的URL缓存（可在多个引擎间共享），默认使用进程共享的UrlCache::shared()；
+    // 下载器和是否重新验证在UrlCache上设置。每次渲染前协议中的URL在线程池上并发下载
+    void setUrlCache(std::shared_ptr<UrlCache> cache);
+    
+    // 获取当前URL缓存
+    std::shared_ptr<UrlCache> getUrlCache() const;
+    
+    // 获取最近一次渲染的分阶段耗时，命中结果缓存时各项为0
+    const RenderStageTimings& getLastTimings() const { return lastTimings; }
 
 private:
     std::string errorMessage;
+    std::shared_ptr<OutputSink> outputSink;
+    std::shared_ptr<ResultCache> resultCache;
+    std::shared_ptr<ImageSource> imageSource;
+    std::vector<std::shared_ptr<const SpriteAtlas>> spriteAtlases;
+    bool captureEnabled;
+    RenderStageTimings lastTimings;
+    
+    // 异步编码
+    std::unique_ptr<AsyncEncoder> asyncEncoder;
+    std::mutex asyncMutex;
+    std::vector<std::string> asyncErrors;
     
     // 组件
     std::unique_ptr<ProtocolParser> protocolParser;
@@ -42,10 +148,28 @@ private:
     std::unique_ptr<ImageWriter> imageWriter;
     
     // 渲染方法
-    bool renderCanvas(const CanvasConfig& canvasConfig);
-    bool renderImages(const std::vector<ImageElement>& images);
-    bool renderTexts(const std::vector<TextElement>& texts);
-    bool saveOutput(sk_sp<SkImage> image, const OutputConfig& outputConfig);
+    sk_sp<SkImage> rasterize(const RenderProtocol& protocol, sk_sp<SkPicture>* capture = nullptr);
+    bool writeCapture(const sk_sp<SkPicture>& picture, const RenderProtocol& protocol, OutputSink* sink);
+    sk_sp<SkPicture> recordPicture(const RenderProtocol& protocol);
+    bool drawContent(SkCanvas* canvas, const RenderProtocol& protocol);
+    bool renderCanvas(SkCanvas* canvas, const CanvasConfig& canvasConfig);
+    bool renderImages(SkCanvas* canvas, const std::vector<ImageElement>& images);
+    bool renderTexts(SkCanvas* canvas, const std::vector<TextElement>& texts, bool debugMode);
+    bool saveOutputs(sk_sp<SkImage> image, const std::vector<OutputConfig>& outputs, OutputSink* sink);
+    
+    // 异步渲染：同步光栅化后把快照提交给编码线程
+    bool submitAsync(const RenderProtocol& protocol);
+    
+    // 并发下载协议中尚未缓存的http(s)图片
+    void prefetchUrls(const RenderProtocol& protocol);
+    
+    // 结果缓存：key为空表示不使用缓存，命中时返回true
+    bool lookupResultCache(const RenderProtocol& protocol, std::string* key, std::vector<sk_sp<SkData>>* cached);
+    static void storeResultCache(ResultCache* cache, const std::string& key,
+                                 const std::vector<OutputConfig>& outputs,
+                                 const RecordingOutputSink& recording);
+    bool writeCachedOutputs(const std::vector<OutputConfig>& outputs,
+                            const std::vector<sk_sp<SkData>>& cached, OutputSink* sink);
 };
 
 } // namespace skia_renderer 
\ No newline at end of file
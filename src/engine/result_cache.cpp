@@ -0,0 +1,428 @@
+#include "engine/result_cache.h"
+#include "core/version.h"
+#include "include/core/SkMilestone.h"
+#include "include/core/SkStream.h"
+#include "utils/content_hash.h"
+#include "utils/temp_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace skia_renderer {
+
+namespace {
+
+const char kEntryMagic[4] = {'P', 'R', 'C', '1'};
+const char* kEntryExtension = ".bin";
+
+// 规范化序列化 - 按固定顺序写入字段，字符串带长度前缀，浮点按位写入
+class KeyBuilder {
+public:
+    void addString(const std::string& value) {
+        addInt(static_cast<int64_t>(value.size()));
+        buffer.append(value);
+    }
+    
+    void addInt(int64_t value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    
+    void addFloat(float value) {
+        // -0.0与0.0渲染结果相同
+        if (value == 0.0f) {
+            value = 0.0f;
+        }
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        addInt(bits);
+    }
+    
+    void addBool(bool value) { addInt(value ? 1 : 0); }
+    
+    void addTransform(const Transform& transform) {
+        addFloat(transform.x);
+        addFloat(transform.y);
+        addFloat(transform.scaleX);
+        addFloat(transform.scaleY);
+        addFloat(transform.rotation);
+        addFloat(transform.opacity);
+    }
+    
+    const std::string& data() const { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+std::string lowerExtension(const std::string& filename) {
+    size_t pos = filename.find_last_of('.');
+    if (pos == std::string::npos) {
+        return "";
+    }
+    std::string ext = filename.substr(pos + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
+
+} // namespace
+
+ResultCache::ResultCache(const std::string& directory, uint64_t maxBytes, size_t maxEntries) :
+    directory(directory),
+    maxBytes(maxBytes),
+    maxEntries(maxEntries) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        errorMessage = "无法创建缓存目录: " + directory;
+    }
+    loadIndex();
+}
+
+bool ResultCache::computeKey(const RenderProtocol& protocol, const FontManager* fontManager, std::string* key,
+                             const ImageSource* imageSource, const ResultCacheEngineState& engineState) {
+    KeyBuilder builder;
+    builder.addString(kRendererVersion);
+    builder.addInt(SK_MILESTONE);
+    
+    // 引擎设置：解码预算影响降采样，图集绘制与逐个绘制有舍入差
+    builder.addInt(static_cast<int64_t>(engineState.maxImageDecodeBytes));
+    builder.addInt(static_cast<int64_t>(engineState.maxRenderDecodeBytes));
+    builder.addInt(static_cast<int64_t>(engineState.spriteAtlases.size()));
+    for (const auto& atlas : engineState.spriteAtlases) {
+        builder.addString(atlas.first);
+        builder.addString(atlas.second);
+    }
+    
+    // 画布
+    builder.addInt(protocol.canvas.width);
+    builder.addInt(protocol.canvas.height);
+    builder.addString(protocol.canvas.background);
+    builder.addBool(protocol.canvas.debug);
+    builder.addInt(static_cast<int64_t>(protocol.canvas.imageSampling));
+    
+    // 图片：id不影响渲染结果，路径换成文件内容哈希
+    builder.addInt(static_cast<int64_t>(protocol.images.size()));
+    for (const auto& image : protocol.images) {
+        std::string hash;
+        if (!hashFile(image.path, &hash, imageSource)) {
+            return false;
+        }
+        builder.addString(hash);
+        builder.addTransform(image.transform);
+        builder.addInt(image.width);
+        builder.addInt(image.height);
+        builder.addInt(static_cast<int64_t>(image.sampling));
+    }
+    
+    // 文本
+    std::set<std::string> fontFamilies;
+    builder.addInt(static_cast<int64_t>(protocol.texts.size()));
+    for (const auto& text : protocol.texts) {
+        const TextStyle& style = text.style;
+        builder.addString(text.content);
+        builder.addTransform(text.transform);
+        builder.addFloat(text.width);
+        builder.addFloat(text.height);
+        builder.addString(style.fontFamily);
+        builder.addFloat(style.fontSize);
+        builder.addInt(style.fillColor);
+        builder.addInt(style.strokeColor);
+        builder.addFloat(style.strokeWidth);
+        builder.addBool(style.hasShadow);
+        builder.addFloat(style.shadowDx);
+        builder.addFloat(style.shadowDy);
+        builder.addFloat(style.shadowSigma);
+        builder.addInt(style.shadowColor);
+        builder.addInt(static_cast<int64_t>(style.displayMode));
+        builder.addBool(style.hasExplicitDisplayMode);
+        builder.addInt(style.maxLines);
+        builder.addBool(style.ellipsis);
+        builder.addInt(static_cast<int64_t>(text.richTextStrategy));
+        builder.addFloat(text.letterSpacing);
+        fontFamilies.insert(style.fontFamily);
+        
+        builder.addInt(static_cast<int64_t>(text.richTextSegments.size()));
+        for (const auto& segment : text.richTextSegments) {
+            builder.addString(segment.content);
+            builder.addString(segment.fontFamily);
+            builder.addFloat(segment.fontSize);
+            builder.addInt(segment.fillColor);
+            builder.addInt(segment.strokeColor);
+            builder.addFloat(segment.strokeWidth);
+            builder.addBool(segment.hasShadow);
+            builder.addFloat(segment.shadowDx);
+            builder.addFloat(segment.shadowDy);
+            builder.addFloat(segment.shadowSigma);
+            builder.addInt(segment.shadowColor);
+            if (!segment.fontFamily.empty()) {
+                fontFamilies.insert(segment.fontFamily);
+            }
+        }
+    }
+    
+    // 字体：注册的字体文件按内容哈希，系统字体只能按名称区分
+    for (const auto& family : fontFamilies) {
+        std::string path = fontManager ? fontManager->getFontFilePath(family) : "";
+        std::string hash;
+        if (!path.empty() && !hashFile(path, &hash, imageSource)) {
+            return false;
+        }
+        builder.addString(family);
+        builder.addString(hash);
+    }
+    
+    // 输出：文件名只影响写到哪里，格式未指定时由扩展名决定
+    builder.addInt(static_cast<int64_t>(protocol.outputs.size()));
+    for (const auto& output : protocol.outputs) {
+        builder.addString(output.format.empty() ? lowerExtension(output.filename) : output.format);
+        builder.addInt(output.quality);
+        builder.addString(output.profile);
+        builder.addInt(output.compressionLevel);
+        builder.addString(output.pngFilter);
+        builder.addString(output.chromaSubsampling);
+        builder.addBool(output.lossless);
+        builder.addBool(output.dropAlpha);
+        builder.addBool(output.parallelEncode);
+        builder.addInt(output.width);
+        builder.addInt(output.height);
+    }
+    
+    *key = ContentHash::hex(builder.data().data(), builder.data().size());
+    return true;
+}
+
+bool ResultCache::lookup(const std::string& key, size_t outputCount, std::vector<sk_sp<SkData>>* outputs) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entries.find(key) == entries.end()) {
+            ++stats.misses;
+            return false;
+        }
+    }
+    
+    // 条目文件以mmap方式读取，各输出是同一块映射的子区间，不发生拷贝
+    std::string path = entryPath(key);
+    sk_sp<SkData> data = SkData::MakeFromFileName(path.c_str());
+    std::vector<sk_sp<SkData>> result;
+    bool valid = data && data->size() >= sizeof(kEntryMagic) + sizeof(uint32_t) &&
+                 std::memcmp(data->data(), kEntryMagic, sizeof(kEntryMagic)) == 0;
+    if (valid) {
+        const uint8_t* bytes = data->bytes();
+        uint32_t count;
+        std::memcpy(&count, bytes + sizeof(kEntryMagic), sizeof(count));
+        size_t offset = sizeof(kEntryMagic) + sizeof(count) + count * sizeof(uint64_t);
+        valid = count == outputCount && offset <= data->size();
+        for (uint32_t i = 0; valid && i < count; ++i) {
+            uint64_t size;
+            std::memcpy(&size, bytes + sizeof(kEntryMagic) + sizeof(count) + i * sizeof(uint64_t), sizeof(size));
+            if (size > data->size() - offset) {
+                valid = false;
+                break;
+            }
+            result.push_back(SkData::MakeSubset(data.get(), offset, size));
+            offset += size;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!valid) {
+        // 条目损坏或被外部删除
+        std::remove(path.c_str());
+        removeLocked(key);
+        ++stats.misses;
+        return false;
+    }
+    
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        lru.splice(lru.begin(), lru, it->second.lruPosition);
+    }
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    
+    ++stats.hits;
+    *outputs = std::move(result);
+    return true;
+}
+
+bool ResultCache::store(const std::string& key, const std::vector<sk_sp<SkData>>& outputs) {
+    uint64_t totalSize = sizeof(kEntryMagic) + sizeof(uint32_t) + outputs.size() * sizeof(uint64_t);
+    for (const auto& data : outputs) {
+        if (!data) {
+            return false;
+        }
+        totalSize += data->size();
+    }
+    if (totalSize > maxBytes) {
+        // 单个条目超过上限时不缓存
+        return false;
+    }
+    
+    // 先写临时文件再重命名，其他进程不会读到写了一半的条目
+    std::string path = entryPath(key);
+    std::string tempPath = TempFile::pathFor(path);
+    {
+        SkFILEWStream out(tempPath.c_str());
+        if (!out.isValid()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            errorMessage = "无法写入缓存文件: " + tempPath;
+            return false;
+        }
+        uint32_t count = static_cast<uint32_t>(outputs.size());
+        bool ok = out.write(kEntryMagic, sizeof(kEntryMagic)) && out.write(&count, sizeof(count));
+        for (const auto& data : outputs) {
+            uint64_t size = data->size();
+            ok = ok && out.write(&size, sizeof(size));
+        }
+        for (const auto& data : outputs) {
+            ok = ok && out.write(data->data(), data->size());
+        }
+        out.flush();
+        if (!ok) {
+            std::remove(tempPath.c_str());
+            std::lock_guard<std::mutex> lock(mutex);
+            errorMessage = "写入缓存文件失败: " + tempPath;
+            return false;
+        }
+    }
+    
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        std::remove(tempPath.c_str());
+        std::lock_guard<std::mutex> lock(mutex);
+        errorMessage = "无法提交缓存文件: " + path;
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    removeLocked(key);
+    lru.push_front(key);
+    entries[key] = {totalSize, lru.begin()};
+    stats.totalBytes += totalSize;
+    evictLocked();
+    return true;
+}
+
+void ResultCache::setLimits(uint64_t maxBytes, size_t maxEntries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->maxBytes = maxBytes;
+    this->maxEntries = maxEntries;
+    evictLocked();
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!lru.empty()) {
+        std::string key = lru.back();
+        std::remove(entryPath(key).c_str());
+        removeLocked(key);
+    }
+}
+
+ResultCache::Stats ResultCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = stats;
+    result.entryCount = entries.size();
+    return result;
+}
+
+std::string ResultCache::getErrorMessage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errorMessage;
+}
+
+void ResultCache::loadIndex() {
+    // 写入时崩溃的进程会留下临时文件，它们不计入缓存大小，只能在这里清理
+    TempFile::removeStale(directory);
+    
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, std::pair<std::string, uint64_t>>> found;
+    for (const auto& item : fs::directory_iterator(directory, ec)) {
+        if (!item.is_regular_file(ec) || item.path().extension() != kEntryExtension) {
+            continue;
+        }
+        found.push_back({item.last_write_time(ec), {item.path().stem().string(), item.file_size(ec)}});
+    }
+    
+    // 按修改时间从旧到新插入到LRU头部，最终头部为最近使用
+    std::sort(found.begin(), found.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& item : found) {
+        lru.push_front(item.second.first);
+        entries[item.second.first] = {item.second.second, lru.begin()};
+        stats.totalBytes += item.second.second;
+    }
+    evictLocked();
+}
+
+bool ResultCache::hashFile(const std::string& sourcePath, std::string* hash, const ImageSource* imageSource) {
+    // 内存数据、URL和资源包的哈希已预先算好（算法与下面相同），data: URI按URI本身哈希
+    if (imageSource && imageSource->contentHash(sourcePath, hash)) {
+        return true;
+    }
+    
+    // file:// URL按本地文件处理
+    std::string path = ImageSource::filePath(sourcePath);
+    std::error_code ec;
+    uint64_t size = fs::file_size(path, ec);
+    if (ec) {
+        std::lock_guard<std::mutex> lock(mutex);
+        errorMessage = "无法读取资源文件: " + path;
+        return false;
+    }
+    int64_t modifiedTime = fs::last_write_time(path, ec).time_since_epoch().count();
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = fileHashes.find(path);
+        if (it != fileHashes.end() && it->second.size == size && it->second.modifiedTime == modifiedTime) {
+            *hash = it->second.hash;
+            return true;
+        }
+    }
+    
+    sk_sp<SkData> data = SkData::MakeFromFileName(path.c_str());
+    if (!data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        errorMessage = "无法读取资源文件: " + path;
+        return false;
+    }
+    *hash = ContentHash::hex(data->data(), data->size());
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    fileHashes[path] = {size, modifiedTime, *hash};
+    return true;
+}
+
+void ResultCache::evictLocked() {
+    while (!lru.empty() &&
+           (stats.totalBytes > maxBytes || (maxEntries > 0 && entries.size() > maxEntries))) {
+        std::string key = lru.back();
+        std::remove(entryPath(key).c_str());
+        removeLocked(key);
+        ++stats.evictions;
+    }
+}
+
+void ResultCache::removeLocked(const std::string& key) {
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return;
+    }
+    stats.totalBytes -= it->second.bytes;
+    lru.erase(it->second.lruPosition);
+    entries.erase(it);
+}
+
+std::string ResultCache::entryPath(const std::string& key) const {
+    return (fs::path(directory) / (key + kEntryExtension)).string();
+}
+
+} // namespace skia_renderer
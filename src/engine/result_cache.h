@@ -0,0 +1,109 @@
+#pragma once
+
+#include "core/types.h"
+#include "resources/image_source.h"
+#include "resources/font_manager.h"
+#include "include/core/SkData.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace skia_renderer {
+
+// 协议之外会改变渲染结果的引擎设置，同样计入缓存键
+struct ResultCacheEngineState {
+    // 解码预算（像素字节数）：决定是否降采样解码以及渲染能否成功
+    size_t maxImageDecodeBytes = 0;
+    size_t maxRenderDecodeBytes = 0;
+    // 已加载的精灵图集，按加载顺序记录索引路径和内容哈希
+    std::vector<std::pair<std::string, std::string>> spriteAtlases;
+};
+
+// 渲染结果缓存 - 以内容寻址，命中时直接返回已编码的输出，不再经过Skia
+//
+// 缓存键 = 规范化后的RenderProtocol + 所有引用的图片/字体文件内容哈希 + 引擎设置 + 渲染器版本，
+// 与协议文件的格式、元素id、输出文件名无关，只要渲染结果字节相同就能命中。
+// 每个条目是目录下的一个文件，包含该协议全部输出的编码数据；按最近使用时间淘汰，
+// 访问时间记录在文件修改时间上，进程重启后LRU顺序仍然有效。
+class ResultCache {
+public:
+    // maxBytes为磁盘占用上限，maxEntries为条目数上限（0表示不限制）
+    explicit ResultCache(const std::string& directory,
+                         uint64_t maxBytes = 512ull * 1024 * 1024,
+                         size_t maxEntries = 0);
+    
+    // 计算缓存键，引用的资源文件无法读取时返回false（此时不应使用缓存）；
+    // 给出imageSource时，内存数据、data: URI、http(s) URL和资源包内的文件直接使用其内容哈希，不读文件
+    bool computeKey(const RenderProtocol& protocol, const FontManager* fontManager, std::string* key,
+                    const ImageSource* imageSource = nullptr,
+                    const ResultCacheEngineState& engineState = ResultCacheEngineState());
+    
+    // 查找缓存，命中时按protocol.outputs的顺序返回所有输出的编码数据
+    bool lookup(const std::string& key, size_t outputCount, std::vector<sk_sp<SkData>>* outputs);
+    
+    // 写入缓存，超出上限时淘汰最久未使用的条目
+    bool store(const std::string& key, const std::vector<sk_sp<SkData>>& outputs);
+    
+    // 修改容量上限并立即淘汰
+    void setLimits(uint64_t maxBytes, size_t maxEntries = 0);
+    
+    // 删除所有条目
+    void clear();
+    
+    // 统计信息
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t totalBytes = 0;
+        size_t entryCount = 0;
+    };
+    Stats getStats() const;
+    
+    // 获取错误信息
+    std::string getErrorMessage() const;
+
+private:
+    struct Entry {
+        uint64_t bytes = 0;
+        std::list<std::string>::iterator lruPosition;
+    };
+    
+    // 文件内容哈希的记忆，文件大小和修改时间不变时不再重新读取
+    struct FileHash {
+        uint64_t size = 0;
+        int64_t modifiedTime = 0;
+        std::string hash;
+    };
+    
+    std::string directory;
+    uint64_t maxBytes;
+    size_t maxEntries;
+    
+    mutable std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    std::list<std::string> lru;            // 头部为最近使用
+    std::map<std::string, FileHash> fileHashes;
+    Stats stats;
+    std::string errorMessage;
+    
+    // 扫描目录重建索引
+    void loadIndex();
+    
+    // 计算文件内容哈希
+    bool hashFile(const std::string& path, std::string* hash, const ImageSource* imageSource);
+    
+    // 淘汰直到满足上限，需持有mutex
+    void evictLocked();
+    
+    // 删除条目，需持有mutex
+    void removeLocked(const std::string& key);
+    
+    std::string entryPath(const std::string& key) const;
+};
+
+} // namespace skia_renderer
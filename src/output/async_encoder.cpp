@@ -0,0 +1,88 @@
+#include "output/async_encoder.h"
+#include "output/image_writer.h"
+#include "utils/thread_pool.h"
+#include <algorithm>
+
+namespace skia_renderer {
+
+AsyncEncoder::AsyncEncoder(int workerCount, size_t queueCapacity) :
+    queueCapacity(std::max<size_t>(queueCapacity, 1)),
+    activeJobs(0),
+    stopping(false) {
+    if (workerCount <= 0) {
+        workerCount = std::max(1, ThreadPool::threadCount() - 1);
+    }
+    
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+AsyncEncoder::~AsyncEncoder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool AsyncEncoder::submit(sk_sp<SkImage> image, const std::vector<OutputConfig>& outputs,
+                          std::shared_ptr<OutputSink> sink, Callback callback) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this]() { return stopping || queue.size() < queueCapacity; });
+    if (stopping) {
+        return false;
+    }
+    
+    queue.push_back({std::move(image), outputs, std::move(sink), std::move(callback)});
+    lock.unlock();
+    notEmpty.notify_one();
+    return true;
+}
+
+void AsyncEncoder::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return queue.empty() && activeJobs == 0; });
+}
+
+void AsyncEncoder::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this]() { return stopping || !queue.empty(); });
+            // 退出前先把已提交的任务做完
+            if (queue.empty()) {
+                return;
+            }
+            job = std::move(queue.front());
+            queue.pop_front();
+            ++activeJobs;
+        }
+        notFull.notify_one();
+        
+        ImageWriter writer;
+        bool success = writer.writeImages(job.image, job.outputs, job.sink.get());
+        if (job.callback) {
+            job.callback(success, success ? std::string() : writer.getErrorMessage());
+        }
+        
+        // 尽早释放整张位图
+        job = Job();
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeJobs;
+            if (queue.empty() && activeJobs == 0) {
+                idle.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/types.h"
+#include "output/output_sink.h"
+#include "include/core/SkImage.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace skia_renderer {
+
+// 异步编码流水线 - 渲染线程提交快照后立即开始下一张，编码线程在后台消费队列
+// 队列有上限：编码跟不上时submit会阻塞，避免待编码的整张位图无限堆积
+class AsyncEncoder {
+public:
+    // 编码完成回调，success为false时error为错误信息；在编码线程中调用
+    using Callback = std::function<void(bool success, const std::string& error)>;
+    
+    // workerCount为0时使用CPU核数减一（给渲染线程留一个核），queueCapacity为排队等待编码的最大任务数
+    explicit AsyncEncoder(int workerCount = 0, size_t queueCapacity = 2);
+    
+    // 等待所有已提交的任务编码完成后退出编码线程
+    ~AsyncEncoder();
+    
+    // 提交一个编码任务，图像像素由任务持有，调用方之后不能再修改
+    // 队列已满时阻塞直到有空位，编码器已关闭时返回false
+    bool submit(sk_sp<SkImage> image, const std::vector<OutputConfig>& outputs,
+                std::shared_ptr<OutputSink> sink, Callback callback = nullptr);
+    
+    // 阻塞直到队列为空且没有正在编码的任务
+    void waitIdle();
+    
+    // 编码线程数
+    int getWorkerCount() const { return static_cast<int>(workers.size()); }
+
+private:
+    struct Job {
+        sk_sp<SkImage> image;
+        std::vector<OutputConfig> outputs;
+        std::shared_ptr<OutputSink> sink;
+        Callback callback;
+    };
+    
+    std::vector<std::thread> workers;
+    std::deque<Job> queue;
+    size_t queueCapacity;
+    int activeJobs;
+    bool stopping;
+    
+    std::mutex mutex;
+    std::condition_variable notEmpty;   // 有新任务或需要退出
+    std::condition_variable notFull;    // 队列有空位
+    std::condition_variable idle;       // 队列为空且没有任务在编码
+    
+    // 编码线程主循环
+    void workerLoop();
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,91 @@
+#include "output/image_scaler.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkSamplingOptions.h"
+#include <algorithm>
+#include <cmath>
+
+namespace skia_renderer {
+
+ImageScaler::ImageScaler(sk_sp<SkImage> source) {
+    if (source) {
+        levels.push_back(std::move(source));
+    }
+}
+
+sk_sp<SkImage> ImageScaler::scaleTo(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return nullptr;
+    }
+    
+    sk_sp<SkImage> base;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (levels.empty()) {
+            return nullptr;
+        }
+        if (levels[0]->width() == width && levels[0]->height() == height) {
+            return levels[0];
+        }
+        
+        // 找到不小于目标尺寸的最小层级，不存在时逐级减半生成
+        size_t level = 0;
+        while (true) {
+            int halfWidth = (levels[level]->width() + 1) / 2;
+            int halfHeight = (levels[level]->height() + 1) / 2;
+            if (halfWidth < width || halfHeight < height) {
+                break;
+            }
+            if (level + 1 == levels.size()) {
+                sk_sp<SkImage> half = resample(levels[level], halfWidth, halfHeight,
+                                               SkSamplingOptions(SkFilterMode::kLinear));
+                if (!half) {
+                    break;
+                }
+                levels.push_back(std::move(half));
+            }
+            ++level;
+        }
+        base = levels[level];
+    }
+    
+    if (base->width() == width && base->height() == height) {
+        return base;
+    }
+    // 最后一步缩放比例在(0.5, 1]之间（或放大），三次插值不会出现混叠
+    return resample(base, width, height, SkSamplingOptions(SkCubicResampler::Mitchell()));
+}
+
+void ImageScaler::resolveSize(int sourceWidth, int sourceHeight,
+                              int configWidth, int configHeight,
+                              int* width, int* height) {
+    if (configWidth > 0 && configHeight > 0) {
+        *width = configWidth;
+        *height = configHeight;
+    } else if (configWidth > 0) {
+        *width = configWidth;
+        *height = std::max(1, static_cast<int>(std::lround(
+            static_cast<double>(sourceHeight) * configWidth / sourceWidth)));
+    } else if (configHeight > 0) {
+        *height = configHeight;
+        *width = std::max(1, static_cast<int>(std::lround(
+            static_cast<double>(sourceWidth) * configHeight / sourceHeight)));
+    } else {
+        *width = sourceWidth;
+        *height = sourceHeight;
+    }
+}
+
+sk_sp<SkImage> ImageScaler::resample(const sk_sp<SkImage>& image, int width, int height,
+                                     const SkSamplingOptions& sampling) {
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(image->imageInfo().makeWH(width, height))) {
+        return nullptr;
+    }
+    if (!image->scalePixels(bitmap.pixmap(), sampling, SkImage::kDisallow_CachingHint)) {
+        return nullptr;
+    }
+    bitmap.setImmutable();
+    return bitmap.asImage();
+}
+
+} // namespace skia_renderer
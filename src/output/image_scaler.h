@@ -0,0 +1,34 @@
+#pragma once
+
+#include "include/core/SkImage.h"
+#include <mutex>
+#include <vector>
+
+namespace skia_renderer {
+
+// 高质量缩小链 - 从同一张渲染结果生成多个尺寸的图像
+// 先用2:1双线性（等价于2x2盒式滤波）逐级减半到不小于目标尺寸的层级，再用Mitchell三次插值缩放到目标尺寸
+// 各层级按需生成并缓存，多个缩略图共享中间层级，原图只被完整读取一次
+class ImageScaler {
+public:
+    explicit ImageScaler(sk_sp<SkImage> source);
+    
+    // 获取指定尺寸的图像，尺寸与原图相同时直接返回原图，失败返回nullptr
+    // 可以被多个线程同时调用
+    sk_sp<SkImage> scaleTo(int width, int height);
+    
+    // 根据配置的宽高计算目标尺寸：都为0时保持原尺寸，只设置一个时按原图比例计算另一个
+    static void resolveSize(int sourceWidth, int sourceHeight,
+                            int configWidth, int configHeight,
+                            int* width, int* height);
+
+private:
+    std::mutex mutex;
+    std::vector<sk_sp<SkImage>> levels; // levels[0]为原图，之后每级宽高减半
+    
+    // 把图像重采样到指定尺寸
+    static sk_sp<SkImage> resample(const sk_sp<SkImage>& image, int width, int height,
+                                   const SkSamplingOptions& sampling);
+};
+
+} // namespace skia_renderer
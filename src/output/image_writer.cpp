@@ -1,11 +1,50 @@
 #include "output/image_writer.h"
-#include "include/encode/SkJpegEncoder.h"
+#include "output/image_scaler.h"
+#include "output/parallel_encoder.h"
+#include "utils/thread_pool.h"
 #include <iostream>
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 
 namespace skia_renderer {
 
+namespace {
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value;
+}
+
+} // namespace
+
+// ==================== EncoderProfile 实现 ====================
+
+bool EncoderProfile::fromName(const std::string& name, EncoderProfile* profile) {
+    std::string lowerName = toLower(name);
+    EncoderProfile result;
+    
+    if (lowerName == "fast") {
+        // 单一过滤器省去libpng逐行试探，低zlib级别大幅减少deflate耗时
+        result.pngZLibLevel = 1;
+        result.pngFilters = SkPngEncoder::FilterFlag::kSub;
+        result.webpLosslessEffort = 0.0f;
+    } else if (lowerName.empty() || lowerName == "balanced") {
+        // 与libpng/libwebp默认值一致
+    } else if (lowerName == "smallest") {
+        result.pngZLibLevel = 9;
+        result.pngFilters = SkPngEncoder::FilterFlag::kAll;
+        result.webpLosslessEffort = 100.0f;
+    } else {
+        return false;
+    }
+    
+    *profile = result;
+    return true;
+}
+
+// ==================== ImageWriter 实现 ====================
+
 ImageWriter::ImageWriter() {
 }
 
@@ -13,78 +52,308 @@ ImageWriter::~ImageWriter() {
 }
 
 bool ImageWriter::saveAsPng(sk_sp<SkImage> image, const std::string& filename) {
-    if (!image) {
-        errorMessage = "图像为空";
+    OutputConfig outputConfig;
+    outputConfig.format = "png";
+    outputConfig.filename = filename;
+    
+    FileOutputSink sink("");
+    return writeImage(image, outputConfig, &sink);
+}
+
+bool ImageWriter::saveAsJpeg(sk_sp<SkImage> image, const std::string& filename, int quality) {
+    OutputConfig outputConfig;
+    outputConfig.format = "jpeg";
+    outputConfig.filename = filename;
+    outputConfig.quality = quality;
+    
+    FileOutputSink sink("");
+    return writeImage(image, outputConfig, &sink);
+}
+
+bool ImageWriter::saveImage(sk_sp<SkImage> image, const std::string& filename, int quality) {
+    OutputConfig outputConfig;
+    outputConfig.filename = filename;
+    outputConfig.quality = quality;
+    
+    FileOutputSink sink("");
+    return writeImage(image, outputConfig, &sink);
+}
+
+bool ImageWriter::encodeImage(sk_sp<SkImage> image, SkWStream* stream, const OutputConfig& outputConfig) {
+    if (!stream) {
+        errorMessage = "输出流为空";
+        return false;
+    }
+    
+    OutputFormat format;
+    EncoderProfile profile;
+    if (!resolveFormat(outputConfig, &format) || !resolveProfile(outputConfig, &profile)) {
         return false;
     }
     
     SkPixmap pixmap;
-    if (!image->peekPixels(&pixmap)) {
-        errorMessage = "无法获取像素数据";
+    if (!peekPixels(image, &pixmap)) {
         return false;
     }
     
-    SkFILEWStream out(filename.c_str());
-    if (!out.isValid()) {
-        errorMessage = "无法打开输出文件: " + filename;
+    if (outputConfig.dropAlpha) {
+        pixmap = dropAlphaIfOpaque(pixmap);
+    }
+    
+    switch (format) {
+    case OutputFormat::JPEG:
+        return encodeJpeg(pixmap, stream, outputConfig.quality, profile, outputConfig.parallelEncode);
+    case OutputFormat::WebP:
+        return encodeWebp(pixmap, stream, outputConfig.quality, outputConfig.lossless, profile);
+    case OutputFormat::PNG:
+    default:
+        return encodePng(pixmap, stream, profile, outputConfig.parallelEncode);
+    }
+}
+
+sk_sp<SkData> ImageWriter::encodeImage(sk_sp<SkImage> image, const OutputConfig& outputConfig) {
+    SkDynamicMemoryWStream out;
+    if (!encodeImage(image, &out, outputConfig)) {
+        return nullptr;
+    }
+    return out.detachAsData();
+}
+
+bool ImageWriter::writeImage(sk_sp<SkImage> image, const OutputConfig& outputConfig, OutputSink* sink) {
+    if (!sink) {
+        errorMessage = "输出目标为空";
         return false;
     }
     
-    SkPngEncoder::Options options;
-    if (!SkPngEncoder::Encode(&out, pixmap, options)) {
-        errorMessage = "PNG编码失败";
+    errorMessage.clear();
+    bool success = sink->write(outputConfig.filename, [&](SkWStream* out) {
+        return encodeImage(image, out, outputConfig);
+    });
+    
+    if (!success && errorMessage.empty()) {
+        errorMessage = sink->getErrorMessage();
+    }
+    return success;
+}
+
+bool ImageWriter::writeImages(sk_sp<SkImage> image, const std::vector<OutputConfig>& outputs, OutputSink* sink) {
+    if (!image) {
+        errorMessage = "图像为空";
+        return false;
+    }
+    
+    if (!sink) {
+        errorMessage = "输出目标为空";
+        return false;
+    }
+    
+    if (outputs.size() == 1 && outputs[0].width <= 0 && outputs[0].height <= 0) {
+        return writeImage(image, outputs[0], sink);
+    }
+    
+    // 先按尺寸生成所有变体（共享缩小链的中间层级），再并发编码
+    ImageScaler scaler(image);
+    std::vector<sk_sp<SkImage>> variants(outputs.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        int width, height;
+        ImageScaler::resolveSize(image->width(), image->height(),
+                                 outputs[i].width, outputs[i].height, &width, &height);
+        variants[i] = scaler.scaleTo(width, height);
+        if (!variants[i]) {
+            errorMessage = "图片缩放失败: " + outputs[i].filename;
+            return false;
+        }
+    }
+    
+    // ImageWriter会记录错误信息，每个任务使用独立的实例
+    errorMessage.clear();
+    std::vector<std::string> errors(outputs.size());
+    ThreadPool::parallelFor(static_cast<int>(outputs.size()), [&](int i) {
+        ImageWriter writer;
+        if (!writer.writeImage(variants[i], outputs[i], sink)) {
+            errors[i] = writer.getErrorMessage();
+            if (errors[i].empty()) {
+                errors[i] = "未知错误";
+            }
+        }
+    });
+    
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        if (!errors[i].empty()) {
+            errorMessage = outputs[i].filename + ": " + errors[i];
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ImageWriter::resolveFormat(const OutputConfig& outputConfig, OutputFormat* format) {
+    std::string name = toLower(outputConfig.format);
+    if (name.empty()) {
+        name = getFileExtension(outputConfig.filename);
+        if (name != "jpg" && name != "jpeg" && name != "webp") {
+            // 默认保存为PNG
+            name = "png";
+        }
+    }
+    
+    if (name == "png") {
+        *format = OutputFormat::PNG;
+    } else if (name == "jpg" || name == "jpeg") {
+        *format = OutputFormat::JPEG;
+    } else if (name == "webp") {
+        *format = OutputFormat::WebP;
+    } else {
+        errorMessage = "不支持的输出格式: " + outputConfig.format;
         return false;
     }
+    return true;
+}
+
+bool ImageWriter::resolveProfile(const OutputConfig& outputConfig, EncoderProfile* profile) {
+    if (!EncoderProfile::fromName(outputConfig.profile, profile)) {
+        errorMessage = "未知的编码预设: " + outputConfig.profile;
+        return false;
+    }
+    
+    // 单项配置覆盖预设
+    if (outputConfig.compressionLevel >= 0) {
+        profile->pngZLibLevel = std::min(outputConfig.compressionLevel, 9);
+    }
+    
+    if (!outputConfig.pngFilter.empty()) {
+        if (!parsePngFilters(outputConfig.pngFilter, &profile->pngFilters)) {
+            errorMessage = "无效的PNG过滤器: " + outputConfig.pngFilter;
+            return false;
+        }
+    }
     
+    if (!outputConfig.chromaSubsampling.empty()) {
+        if (outputConfig.chromaSubsampling == "420") {
+            profile->jpegDownsample = SkJpegEncoder::Downsample::k420;
+        } else if (outputConfig.chromaSubsampling == "422") {
+            profile->jpegDownsample = SkJpegEncoder::Downsample::k422;
+        } else if (outputConfig.chromaSubsampling == "444") {
+            profile->jpegDownsample = SkJpegEncoder::Downsample::k444;
+        } else {
+            errorMessage = "无效的JPEG色度采样: " + outputConfig.chromaSubsampling;
+            return false;
+        }
+    }
     return true;
 }
 
-bool ImageWriter::saveAsJpeg(sk_sp<SkImage> image, const std::string& filename, int quality) {
+bool ImageWriter::peekPixels(const sk_sp<SkImage>& image, SkPixmap* pixmap) {
     if (!image) {
         errorMessage = "图像为空";
         return false;
     }
     
-    SkPixmap pixmap;
-    if (!image->peekPixels(&pixmap)) {
+    if (!image->peekPixels(pixmap)) {
         errorMessage = "无法获取像素数据";
         return false;
     }
+    return true;
+}
+
+SkPixmap ImageWriter::dropAlphaIfOpaque(const SkPixmap& pixmap) {
+    // 画布本身以kOpaque创建时编码器已经不会写alpha，这里只处理带alpha但实际全不透明的图像
+    if (pixmap.alphaType() == kOpaque_SkAlphaType || !pixmap.computeIsOpaque()) {
+        return pixmap;
+    }
+    return SkPixmap(pixmap.info().makeAlphaType(kOpaque_SkAlphaType), pixmap.addr(), pixmap.rowBytes());
+}
+
+bool ImageWriter::encodePng(const SkPixmap& pixmap, SkWStream* stream, const EncoderProfile& profile, bool parallel) {
+    if (parallel && ParallelEncoder::supportsPixmap(pixmap)) {
+        if (!ParallelEncoder::encodePng(stream, pixmap, profile.pngZLibLevel, profile.pngFilters)) {
+            errorMessage = "PNG并行编码失败";
+            return false;
+        }
+        return true;
+    }
     
-    SkFILEWStream out(filename.c_str());
-    if (!out.isValid()) {
-        errorMessage = "无法打开输出文件: " + filename;
+    SkPngEncoder::Options options;
+    options.fZLibLevel = profile.pngZLibLevel;
+    options.fFilterFlags = profile.pngFilters;
+    if (!SkPngEncoder::Encode(stream, pixmap, options)) {
+        errorMessage = "PNG编码失败";
         return false;
     }
+    return true;
+}
+
+bool ImageWriter::encodeJpeg(const SkPixmap& pixmap, SkWStream* stream, int quality, const EncoderProfile& profile, bool parallel) {
+    if (parallel && ParallelEncoder::supportsPixmap(pixmap)) {
+        if (!ParallelEncoder::encodeJpeg(stream, pixmap, quality, profile.jpegDownsample)) {
+            errorMessage = "JPEG并行编码失败";
+            return false;
+        }
+        return true;
+    }
     
     SkJpegEncoder::Options options;
     options.fQuality = quality;
-    if (!SkJpegEncoder::Encode(&out, pixmap, options)) {
+    options.fDownsample = profile.jpegDownsample;
+    if (!SkJpegEncoder::Encode(stream, pixmap, options)) {
         errorMessage = "JPEG编码失败";
         return false;
     }
-    
     return true;
 }
 
-bool ImageWriter::saveImage(sk_sp<SkImage> image, const std::string& filename, int quality) {
-    std::string extension = getFileExtension(filename);
-    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
-    
-    if (extension == "png") {
-        return saveAsPng(image, filename);
-    } else if (extension == "jpg" || extension == "jpeg") {
-        return saveAsJpeg(image, filename, quality);
+bool ImageWriter::encodeWebp(const SkPixmap& pixmap, SkWStream* stream, int quality, bool lossless, const EncoderProfile& profile) {
+    SkWebpEncoder::Options options;
+    if (lossless) {
+        // 无损模式下fQuality控制压缩力度而不是画质
+        options.fCompression = SkWebpEncoder::Compression::kLossless;
+        options.fQuality = profile.webpLosslessEffort;
     } else {
-        // 默认保存为PNG
-        return saveAsPng(image, filename);
+        options.fCompression = SkWebpEncoder::Compression::kLossy;
+        options.fQuality = static_cast<float>(std::clamp(quality, 1, 100));
+    }
+    if (!SkWebpEncoder::Encode(stream, pixmap, options)) {
+        errorMessage = "WebP编码失败";
+        return false;
     }
+    return true;
+}
+
+bool ImageWriter::parsePngFilters(const std::string& filters, SkPngEncoder::FilterFlag* flags) {
+    int result = 0;
+    std::stringstream ss(toLower(filters));
+    std::string item;
+    
+    while (std::getline(ss, item, ',')) {
+        item.erase(std::remove(item.begin(), item.end(), ' '), item.end());
+        if (item == "none") {
+            result |= static_cast<int>(SkPngEncoder::FilterFlag::kNone);
+        } else if (item == "sub") {
+            result |= static_cast<int>(SkPngEncoder::FilterFlag::kSub);
+        } else if (item == "up") {
+            result |= static_cast<int>(SkPngEncoder::FilterFlag::kUp);
+        } else if (item == "avg") {
+            result |= static_cast<int>(SkPngEncoder::FilterFlag::kAvg);
+        } else if (item == "paeth") {
+            result |= static_cast<int>(SkPngEncoder::FilterFlag::kPaeth);
+        } else if (item == "all") {
+            result |= static_cast<int>(SkPngEncoder::FilterFlag::kAll);
+        } else {
+            return false;
+        }
+    }
+    
+    if (result == 0) {
+        return false;
+    }
+    *flags = static_cast<SkPngEncoder::FilterFlag>(result);
+    return true;
 }
 
 std::string ImageWriter::getFileExtension(const std::string& filename) {
     size_t pos = filename.find_last_of('.');
     if (pos != std::string::npos) {
-        return filename.substr(pos + 1);
+        return toLower(filename.substr(pos + 1));
     }
     return "";
 }
@@ -98,4 +367,4 @@ bool ImageWriter::isFileWritable(const std::string& filename) {
     return false;
 }
 
-} // namespace skia_renderer 
\ No newline at end of file
+} // namespace skia_renderer 
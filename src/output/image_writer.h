@@ -1,12 +1,39 @@
 #pragma once
 
+#include "core/types.h"
+#include "output/output_sink.h"
+#include "include/core/SkData.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkPixmap.h"
+#include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
+#include "include/encode/SkWebpEncoder.h"
 #include "include/core/SkStream.h"
 #include <string>
+#include <vector>
 
 namespace skia_renderer {
 
+// 输出格式
+enum class OutputFormat {
+    PNG,
+    JPEG,
+    WebP
+};
+
+// 编码预设 - 在编码速度和输出体积之间取舍
+// fast: 最快，体积偏大；balanced: 与各编码器默认值一致；smallest: 最小体积，最慢
+// 预设只调整PNG和无损WebP：SkJpegEncoder没有速度/体积参数，JPEG由质量和色度采样（单独配置）决定
+struct EncoderProfile {
+    int pngZLibLevel = 6;                                                     // PNG zlib压缩级别
+    SkPngEncoder::FilterFlag pngFilters = SkPngEncoder::FilterFlag::kAll;     // PNG行过滤器
+    SkJpegEncoder::Downsample jpegDownsample = SkJpegEncoder::Downsample::k420; // JPEG色度采样（不随预设变化）
+    float webpLosslessEffort = 75.0f;                                         // 无损WebP压缩力度 (0-100)
+    
+    // 按名称获取预设，未知名称返回false
+    static bool fromName(const std::string& name, EncoderProfile* profile);
+};
+
 class ImageWriter {
 public:
     ImageWriter();
@@ -21,17 +48,49 @@ public:
     // 保存图像（根据扩展名自动选择格式）
     bool saveImage(sk_sp<SkImage> image, const std::string& filename, int quality = 100);
     
+    // 按输出配置把图像编码进任意流
+    bool encodeImage(sk_sp<SkImage> image, SkWStream* stream, const OutputConfig& outputConfig);
+    
+    // 按输出配置把图像编码为内存数据，失败返回nullptr
+    sk_sp<SkData> encodeImage(sk_sp<SkImage> image, const OutputConfig& outputConfig);
+    
+    // 按输出配置编码并写到指定的输出目标
+    bool writeImage(sk_sp<SkImage> image, const OutputConfig& outputConfig, OutputSink* sink);
+    
+    // 从同一张图像生成所有输出：按各自尺寸缩放后在线程池上并发编码，任意一个失败即返回false
+    bool writeImages(sk_sp<SkImage> image, const std::vector<OutputConfig>& outputs, OutputSink* sink);
+    
+    // 解析输出格式：优先使用format字段，为空时根据文件扩展名推断，默认PNG
+    bool resolveFormat(const OutputConfig& outputConfig, OutputFormat* format);
+    
+    // 合并预设与OutputConfig中的单项覆盖
+    bool resolveProfile(const OutputConfig& outputConfig, EncoderProfile* profile);
+    
     // 获取错误信息
     const std::string& getErrorMessage() const { return errorMessage; }
 
 private:
     std::string errorMessage;
     
-    // 获取文件扩展名
+    // 获取可直接编码的像素
+    bool peekPixels(const sk_sp<SkImage>& image, SkPixmap* pixmap);
+    
+    // 图像实际不透明时把像素重新解释为不透明，使编码器不写alpha通道
+    SkPixmap dropAlphaIfOpaque(const SkPixmap& pixmap);
+    
+    // 编码到流
+    bool encodePng(const SkPixmap& pixmap, SkWStream* stream, const EncoderProfile& profile, bool parallel);
+    bool encodeJpeg(const SkPixmap& pixmap, SkWStream* stream, int quality, const EncoderProfile& profile, bool parallel);
+    bool encodeWebp(const SkPixmap& pixmap, SkWStream* stream, int quality, bool lossless, const EncoderProfile& profile);
+    
+    // 解析PNG过滤器字符串，如"sub,paeth"
+    bool parsePngFilters(const std::string& filters, SkPngEncoder::FilterFlag* flags);
+    
+    // 获取文件扩展名（小写）
     std::string getFileExtension(const std::string& filename);
     
     // 检查文件是否可写
     bool isFileWritable(const std::string& filename);
 };
 
-} // namespace skia_renderer 
\ No newline at end of file
+} // namespace skia_renderer 
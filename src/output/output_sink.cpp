@@ -0,0 +1,159 @@
+#include "output/output_sink.h"
+#include <cstdio>
+
+namespace skia_renderer {
+
+// ==================== FileOutputSink 实现 ====================
+
+FileOutputSink::FileOutputSink(const std::string& directory) :
+    directory(directory) {
+}
+
+bool FileOutputSink::write(const std::string& name, const EncodeFunc& encode) {
+    std::string path = directory + name;
+
+    bool success = false;
+    {
+        SkFILEWStream out(path.c_str());
+        if (!out.isValid()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            errorMessage = "无法打开输出文件: " + path;
+            return false;
+        }
+        success = encode(&out);
+        out.flush();
+    }
+
+    if (!success) {
+        // 不保留编码失败的半成品文件
+        std::remove(path.c_str());
+        std::lock_guard<std::mutex> lock(mutex);
+        errorMessage = "编码失败: " + path;
+    }
+    return success;
+}
+
+std::string FileOutputSink::getErrorMessage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errorMessage;
+}
+
+// ==================== StreamOutputSink 实现 ====================
+
+StreamOutputSink::StreamOutputSink(SkWStream* stream) :
+    stream(stream) {
+}
+
+bool StreamOutputSink::write(const std::string& /*name*/, const EncodeFunc& encode) {
+    if (!stream) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    bool success = encode(stream);
+    stream->flush();
+    return success;
+}
+
+// ==================== CallbackOutputSink 实现 ====================
+
+CallbackOutputSink::CallbackOutputSink(Callback callback) :
+    callback(std::move(callback)) {
+}
+
+bool CallbackOutputSink::write(const std::string& name, const EncodeFunc& encode) {
+    if (!callback) {
+        return false;
+    }
+
+    SkDynamicMemoryWStream out;
+    if (!encode(&out)) {
+        return false;
+    }
+    return callback(name, out.detachAsData());
+}
+
+// ==================== MemoryOutputSink 实现 ====================
+
+bool MemoryOutputSink::write(const std::string& name, const EncodeFunc& encode) {
+    SkDynamicMemoryWStream out;
+    if (!encode(&out)) {
+        return false;
+    }
+
+    sk_sp<SkData> data = out.detachAsData();
+    std::lock_guard<std::mutex> lock(mutex);
+    outputs[name] = std::move(data);
+    return true;
+}
+
+sk_sp<SkData> MemoryOutputSink::getData(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = outputs.find(name);
+    if (it != outputs.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+std::map<std::string, sk_sp<SkData>> MemoryOutputSink::getAllData() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return outputs;
+}
+
+void MemoryOutputSink::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    outputs.clear();
+}
+
+// ==================== RecordingOutputSink 实现 ====================
+
+RecordingOutputSink::RecordingOutputSink(OutputSink* target) :
+    target(target) {
+}
+
+bool RecordingOutputSink::write(const std::string& name, const EncodeFunc& encode) {
+    if (!target) {
+        return false;
+    }
+
+    SkDynamicMemoryWStream out;
+    if (!encode(&out)) {
+        return false;
+    }
+
+    sk_sp<SkData> data = out.detachAsData();
+    if (!writeEncodedData(target, name, data)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    outputs[name] = std::move(data);
+    return true;
+}
+
+std::string RecordingOutputSink::getErrorMessage() const {
+    return target ? target->getErrorMessage() : "";
+}
+
+sk_sp<SkData> RecordingOutputSink::getData(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = outputs.find(name);
+    if (it != outputs.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+// ==================== 工具函数 ====================
+
+bool writeEncodedData(OutputSink* sink, const std::string& name, const sk_sp<SkData>& data) {
+    if (!sink || !data) {
+        return false;
+    }
+    return sink->write(name, [&](SkWStream* out) {
+        return out->write(data->data(), data->size());
+    });
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "include/core/SkData.h"
+#include "include/core/SkStream.h"
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace skia_renderer {
+
+// 输出目标接口 - 决定编码后的字节写到哪里（文件、内存、socket、管道等）
+// 编码器只面向SkWStream写数据，Sink负责提供流并在编码结束后完成提交
+class OutputSink {
+public:
+    // 编码回调：把图片编码进给定的流，返回编码是否成功
+    using EncodeFunc = std::function<bool(SkWStream*)>;
+
+    virtual ~OutputSink() = default;
+
+    // 写出一个输出，name为OutputConfig中的filename
+    // 实现需保证可以被多个线程同时调用
+    virtual bool write(const std::string& name, const EncodeFunc& encode) = 0;
+
+    // 获取错误信息
+    virtual std::string getErrorMessage() const { return ""; }
+};
+
+// 文件输出 - 写到 directory + name，编码失败时删除不完整的文件
+class FileOutputSink : public OutputSink {
+public:
+    explicit FileOutputSink(const std::string& directory = "output/");
+
+    bool write(const std::string& name, const EncodeFunc& encode) override;
+    std::string getErrorMessage() const override;
+
+    const std::string& getDirectory() const { return directory; }
+
+private:
+    std::string directory;
+    mutable std::mutex mutex;
+    std::string errorMessage;
+};
+
+// 流输出 - 直接编码进调用方提供的流（socket、管道、共享内存等），不拥有该流
+class StreamOutputSink : public OutputSink {
+public:
+    explicit StreamOutputSink(SkWStream* stream);
+
+    bool write(const std::string& name, const EncodeFunc& encode) override;
+
+private:
+    SkWStream* stream;
+    std::mutex mutex; // 多个输出共用同一个流时串行写入
+};
+
+// 回调输出 - 编码到内存后把完整的SkData交给回调
+class CallbackOutputSink : public OutputSink {
+public:
+    using Callback = std::function<bool(const std::string& name, sk_sp<SkData> data)>;
+
+    explicit CallbackOutputSink(Callback callback);
+
+    bool write(const std::string& name, const EncodeFunc& encode) override;
+
+private:
+    Callback callback;
+};
+
+// 内存输出 - 按name保存编码结果，供调用方读取
+class MemoryOutputSink : public OutputSink {
+public:
+    bool write(const std::string& name, const EncodeFunc& encode) override;
+
+    // 获取指定输出的编码数据，不存在时返回nullptr
+    sk_sp<SkData> getData(const std::string& name) const;
+
+    // 获取所有输出
+    std::map<std::string, sk_sp<SkData>> getAllData() const;
+
+    // 清空已保存的输出
+    void clear();
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, sk_sp<SkData>> outputs;
+};
+
+// 记录输出 - 把编码结果转发给目标Sink，同时保留一份编码数据（用于写入结果缓存等）
+// 不拥有目标Sink，调用方需保证其生命周期
+class RecordingOutputSink : public OutputSink {
+public:
+    explicit RecordingOutputSink(OutputSink* target);
+
+    bool write(const std::string& name, const EncodeFunc& encode) override;
+    std::string getErrorMessage() const override;
+
+    // 获取指定输出的编码数据，不存在时返回nullptr
+    sk_sp<SkData> getData(const std::string& name) const;
+
+private:
+    OutputSink* target;
+    mutable std::mutex mutex;
+    std::map<std::string, sk_sp<SkData>> outputs;
+};
+
+// 把已经编码好的数据写到输出目标
+bool writeEncodedData(OutputSink* sink, const std::string& name, const sk_sp<SkData>& data);
+
+} // namespace skia_renderer
@@ -0,0 +1,623 @@
+#include "output/parallel_encoder.h"
+#include "utils/thread_pool.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkData.h"
+#include "include/encode/SkICC.h"
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "third_party/externals/zlib/zlib.h"
+#include "third_party/externals/libjpeg-turbo/jpeglib.h"
+
+namespace skia_renderer {
+
+namespace {
+
+// ==================== 色彩空间 ====================
+
+// 与Skia编码器写入的ICC配置相同：由色彩空间的转换函数和到XYZD50的矩阵生成，没有色彩空间时返回nullptr
+sk_sp<SkData> iccProfileFor(const SkPixmap& pixmap) {
+    const SkColorSpace* colorSpace = pixmap.colorSpace();
+    skcms_Matrix3x3 toXYZD50;
+    if (!colorSpace || !colorSpace->toXYZD50(&toXYZD50)) {
+        return nullptr;
+    }
+    skcms_TransferFunction transferFn;
+    colorSpace->transferFn(&transferFn);
+    return SkWriteICCProfile(transferFn, toXYZD50);
+}
+
+// ==================== PNG 辅助 ====================
+
+constexpr size_t kDeflateWindowSize = 32768;    // deflate窗口大小，也是预置字典的最大长度
+constexpr size_t kPngTargetStripBytes = 256 * 1024; // 自动切分时每个条带的目标数据量
+
+enum PngFilterType : uint8_t {
+    kFilterNone = 0,
+    kFilterSub = 1,
+    kFilterUp = 2,
+    kFilterAvg = 3,
+    kFilterPaeth = 4
+};
+
+inline uint8_t paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return static_cast<uint8_t>(a);
+    }
+    if (pb <= pc) {
+        return static_cast<uint8_t>(b);
+    }
+    return static_cast<uint8_t>(c);
+}
+
+// 按指定过滤器过滤一行，prior为上一行（第一行时为nullptr），返回绝对值和用于挑选过滤器
+uint32_t filterRow(uint8_t type, const uint8_t* row, const uint8_t* prior, size_t length, int bpp, uint8_t* out) {
+    const size_t step = std::min(static_cast<size_t>(bpp), length);
+    switch (type) {
+    case kFilterSub:
+        memcpy(out, row, step);
+        for (size_t i = step; i < length; ++i) {
+            out[i] = static_cast<uint8_t>(row[i] - row[i - step]);
+        }
+        break;
+    case kFilterUp:
+        if (!prior) {
+            memcpy(out, row, length);
+            break;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            out[i] = static_cast<uint8_t>(row[i] - prior[i]);
+        }
+        break;
+    case kFilterAvg:
+        if (!prior) {
+            memcpy(out, row, step);
+            for (size_t i = step; i < length; ++i) {
+                out[i] = static_cast<uint8_t>(row[i] - (row[i - step] >> 1));
+            }
+            break;
+        }
+        for (size_t i = 0; i < step; ++i) {
+            out[i] = static_cast<uint8_t>(row[i] - (prior[i] >> 1));
+        }
+        for (size_t i = step; i < length; ++i) {
+            out[i] = static_cast<uint8_t>(row[i] - ((row[i - step] + prior[i]) >> 1));
+        }
+        break;
+    case kFilterPaeth:
+        if (!prior) {
+            // 没有上一行时Paeth退化为Sub
+            return filterRow(kFilterSub, row, prior, length, bpp, out);
+        }
+        for (size_t i = 0; i < step; ++i) {
+            out[i] = static_cast<uint8_t>(row[i] - prior[i]);
+        }
+        for (size_t i = step; i < length; ++i) {
+            out[i] = static_cast<uint8_t>(row[i] - paethPredictor(row[i - step], prior[i], prior[i - step]));
+        }
+        break;
+    default:
+        memcpy(out, row, length);
+        break;
+    }
+
+    // 与libpng一致：把字节当作有符号数求绝对值和
+    uint32_t sum = 0;
+    for (size_t i = 0; i < length; ++i) {
+        sum += out[i] < 128 ? out[i] : 256 - out[i];
+    }
+    return sum;
+}
+
+// 过滤一行并写入 [过滤类型 | 过滤后数据]，多个候选过滤器时选绝对值和最小的
+void filterRowBest(int allowedFlags, const uint8_t* row, const uint8_t* prior, size_t length, int bpp,
+                   uint8_t* out, std::vector<uint8_t>& scratch) {
+    static const struct {
+        SkPngEncoder::FilterFlag flag;
+        uint8_t type;
+    } kFilters[] = {
+        {SkPngEncoder::FilterFlag::kNone, kFilterNone},
+        {SkPngEncoder::FilterFlag::kSub, kFilterSub},
+        {SkPngEncoder::FilterFlag::kUp, kFilterUp},
+        {SkPngEncoder::FilterFlag::kAvg, kFilterAvg},
+        {SkPngEncoder::FilterFlag::kPaeth, kFilterPaeth},
+    };
+
+    uint32_t bestSum = UINT32_MAX;
+    for (const auto& filter : kFilters) {
+        if (!(allowedFlags & static_cast<int>(filter.flag))) {
+            continue;
+        }
+        uint32_t sum = filterRow(filter.type, row, prior, length, bpp, scratch.data());
+        if (sum < bestSum) {
+            bestSum = sum;
+            out[0] = filter.type;
+            memcpy(out + 1, scratch.data(), length);
+        }
+    }
+}
+
+void writeBigEndian32(uint8_t* dst, uint32_t value) {
+    dst[0] = static_cast<uint8_t>(value >> 24);
+    dst[1] = static_cast<uint8_t>(value >> 16);
+    dst[2] = static_cast<uint8_t>(value >> 8);
+    dst[3] = static_cast<uint8_t>(value);
+}
+
+bool writePngChunk(SkWStream* stream, const char type[4], const uint8_t* data, size_t length, uint32_t crc) {
+    uint8_t header[8];
+    writeBigEndian32(header, static_cast<uint32_t>(length));
+    memcpy(header + 4, type, 4);
+    uint8_t trailer[4];
+    writeBigEndian32(trailer, crc);
+    return stream->write(header, sizeof(header))
+        && (length == 0 || stream->write(data, length))
+        && stream->write(trailer, sizeof(trailer));
+}
+
+uint32_t pngChunkCrc(const char type[4], const uint8_t* data, size_t length) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(type), 4);
+    if (length > 0) {
+        crc = crc32(crc, data, static_cast<uInt>(length));
+    }
+    return static_cast<uint32_t>(crc);
+}
+
+// 色彩空间信息，与SkPngEncoder一致：sRGB写sRGB块（感知意图），其他色彩空间写压缩的iCCP块
+bool writePngColorSpace(SkWStream* stream, const SkPixmap& pixmap) {
+    if (!pixmap.colorSpace()) {
+        return true;
+    }
+    if (pixmap.colorSpace()->isSRGB()) {
+        const uint8_t intent = 0;
+        return writePngChunk(stream, "sRGB", &intent, 1, pngChunkCrc("sRGB", &intent, 1));
+    }
+
+    sk_sp<SkData> icc = iccProfileFor(pixmap);
+    if (!icc) {
+        return true;
+    }
+    // 配置名"Skia"、结束符、压缩方法0，之后是zlib压缩的配置
+    static const char kProfileName[] = "Skia";
+    uLongf compressedSize = compressBound(static_cast<uLong>(icc->size()));
+    std::vector<uint8_t> chunk(sizeof(kProfileName) + 1 + compressedSize);
+    memcpy(chunk.data(), kProfileName, sizeof(kProfileName));
+    chunk[sizeof(kProfileName)] = 0;
+    if (compress2(chunk.data() + sizeof(kProfileName) + 1, &compressedSize, icc->bytes(),
+                  static_cast<uLong>(icc->size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return false;
+    }
+    chunk.resize(sizeof(kProfileName) + 1 + compressedSize);
+    return writePngChunk(stream, "iCCP", chunk.data(), chunk.size(), pngChunkCrc("iCCP", chunk.data(), chunk.size()));
+}
+
+// PNG压缩条带
+struct PngStrip {
+    int firstRow = 0;
+    int rowCount = 0;
+    size_t offset = 0;              // 在过滤后数据中的偏移
+    size_t length = 0;              // 过滤后数据长度
+    std::vector<uint8_t> compressed;
+    uint32_t adler = 1;
+    uint32_t crc = 0;
+    bool success = false;
+};
+
+bool deflateStrip(const uint8_t* filtered, PngStrip& strip, int zlibLevel, bool isLast) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // 负的windowBits表示raw deflate，zlib头和Adler-32由调用方统一写出
+    if (deflateInit2(&zs, zlibLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    // 以前一条带末尾的数据作为预置字典，保证跨条带的匹配不损失压缩率
+    if (strip.offset > 0) {
+        size_t dictLength = std::min(strip.offset, kDeflateWindowSize);
+        deflateSetDictionary(&zs, filtered + strip.offset - dictLength, static_cast<uInt>(dictLength));
+    }
+
+    strip.compressed.resize(deflateBound(&zs, static_cast<uLong>(strip.length)) + 64);
+    zs.next_in = const_cast<Bytef*>(filtered + strip.offset);
+    zs.avail_in = static_cast<uInt>(strip.length);
+    zs.next_out = strip.compressed.data();
+    zs.avail_out = static_cast<uInt>(strip.compressed.size());
+
+    // 非末尾条带用Z_SYNC_FLUSH：输出字节对齐且不设置BFINAL，可以直接与下一条带拼接
+    int flush = isLast ? Z_FINISH : Z_SYNC_FLUSH;
+    int result = Z_OK;
+    while (true) {
+        result = deflate(&zs, flush);
+        if (result == Z_STREAM_ERROR) {
+            break;
+        }
+        bool finished = isLast ? (result == Z_STREAM_END) : (zs.avail_in == 0 && zs.avail_out > 0);
+        if (finished) {
+            break;
+        }
+        // 输出缓冲不足时扩容继续
+        size_t used = strip.compressed.size() - zs.avail_out;
+        strip.compressed.resize(strip.compressed.size() * 2);
+        zs.next_out = strip.compressed.data() + used;
+        zs.avail_out = static_cast<uInt>(strip.compressed.size() - used);
+    }
+
+    strip.compressed.resize(strip.compressed.size() - zs.avail_out);
+    deflateEnd(&zs);
+    if (result == Z_STREAM_ERROR) {
+        return false;
+    }
+
+    strip.adler = static_cast<uint32_t>(adler32(adler32(0L, Z_NULL, 0), filtered + strip.offset, static_cast<uInt>(strip.length)));
+    strip.crc = pngChunkCrc("IDAT", strip.compressed.data(), strip.compressed.size());
+    return true;
+}
+
+// ==================== JPEG 辅助 ====================
+
+struct JpegErrorManager {
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr cinfo) {
+    JpegErrorManager* error = reinterpret_cast<JpegErrorManager*>(cinfo->err);
+    longjmp(error->jump, 1);
+}
+
+void jpegSilentOutput(j_common_ptr) {
+}
+
+// JPEG编码条带
+struct JpegStrip {
+    int firstRow = 0;
+    int rowCount = 0;
+    int firstMcuRow = 0;
+    std::vector<uint8_t> encoded;
+    size_t entropyBegin = 0;    // SOS段之后的熵编码数据起点
+    size_t entropyEnd = 0;      // EOI之前
+    bool success = false;
+};
+
+void setSamplingFactors(jpeg_compress_struct* cinfo, SkJpegEncoder::Downsample downsample) {
+    int h = 1;
+    int v = 1;
+    switch (downsample) {
+    case SkJpegEncoder::Downsample::k420: h = 2; v = 2; break;
+    case SkJpegEncoder::Downsample::k422: h = 2; v = 1; break;
+    case SkJpegEncoder::Downsample::k444: h = 1; v = 1; break;
+    }
+    cinfo->comp_info[0].h_samp_factor = h;
+    cinfo->comp_info[0].v_samp_factor = v;
+    for (int i = 1; i < cinfo->num_components; ++i) {
+        cinfo->comp_info[i].h_samp_factor = 1;
+        cinfo->comp_info[i].v_samp_factor = 1;
+    }
+}
+
+// icc非空时写入APP2段（与SkJpegEncoder一致），只有第一个条带的文件头会被使用
+bool encodeJpegStrip(const SkPixmap& pixmap, JpegStrip& strip, int quality, SkJpegEncoder::Downsample downsample,
+                     const SkData* icc) {
+    jpeg_compress_struct cinfo;
+    JpegErrorManager error;
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+
+    cinfo.err = jpeg_std_error(&error.pub);
+    error.pub.error_exit = jpegErrorExit;
+    error.pub.output_message = jpegSilentOutput;
+    if (setjmp(error.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        free(buffer);
+        return false;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &buffer, &size);
+
+    cinfo.image_width = pixmap.width();
+    cinfo.image_height = strip.rowCount;
+    cinfo.input_components = 4;
+    cinfo.in_color_space = pixmap.colorType() == kBGRA_8888_SkColorType ? JCS_EXT_BGRA : JCS_EXT_RGBA;
+
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, std::clamp(quality, 1, 100), TRUE);
+    setSamplingFactors(&cinfo, downsample);
+    // 所有条带必须使用同一套Huffman表，因此不做Huffman优化
+    cinfo.optimize_coding = FALSE;
+    // 每个MCU行之后插入RST标记，条带边界正好落在重启点上
+    cinfo.restart_in_rows = 1;
+
+    jpeg_start_compress(&cinfo, TRUE);
+    if (icc) {
+        // "ICC_PROFILE\0"、序号、总段数，之后是配置数据；配置较大时分成多个段
+        static const char kIccSignature[] = "ICC_PROFILE";
+        constexpr size_t kHeaderSize = sizeof(kIccSignature) + 2;
+        constexpr size_t kMaxPayload = 65533 - kHeaderSize;
+        size_t segmentCount = (icc->size() + kMaxPayload - 1) / kMaxPayload;
+        std::vector<uint8_t> segment;
+        for (size_t i = 0; i < segmentCount && segmentCount <= 255; ++i) {
+            size_t offset = i * kMaxPayload;
+            size_t length = std::min(kMaxPayload, icc->size() - offset);
+            segment.assign(kHeaderSize + length, 0);
+            memcpy(segment.data(), kIccSignature, sizeof(kIccSignature));
+            segment[sizeof(kIccSignature)] = static_cast<uint8_t>(i + 1);
+            segment[sizeof(kIccSignature) + 1] = static_cast<uint8_t>(segmentCount);
+            memcpy(segment.data() + kHeaderSize, icc->bytes() + offset, length);
+            jpeg_write_marker(&cinfo, JPEG_APP0 + 2, segment.data(), static_cast<unsigned int>(segment.size()));
+        }
+    }
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = const_cast<JSAMPROW>(static_cast<const JSAMPLE*>(pixmap.addr(0, strip.firstRow + cinfo.next_scanline)));
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+
+    strip.encoded.assign(buffer, buffer + size);
+    free(buffer);
+    jpeg_destroy_compress(&cinfo);
+    return true;
+}
+
+// 找到SOS段之后的熵编码数据区间，必要时把SOF中的高度改为整图高度
+bool locateJpegSegments(std::vector<uint8_t>& data, JpegStrip& strip, int fullHeight) {
+    size_t pos = 2; // 跳过SOI
+    while (pos + 4 <= data.size()) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = data[pos + 1];
+        size_t length = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+        if (marker >= 0xC0 && marker <= 0xC2 && pos + 9 <= data.size() && fullHeight > 0) {
+            // SOF: FF Cx Lh Ll P Yh Yl Xh Xl
+            data[pos + 5] = static_cast<uint8_t>(fullHeight >> 8);
+            data[pos + 6] = static_cast<uint8_t>(fullHeight);
+        }
+        pos += 2 + length;
+        if (marker == 0xDA) {
+            strip.entropyBegin = pos;
+            break;
+        }
+    }
+
+    if (strip.entropyBegin == 0 || data.size() < strip.entropyBegin + 2
+        || data[data.size() - 2] != 0xFF || data[data.size() - 1] != 0xD9) {
+        return false;
+    }
+    strip.entropyEnd = data.size() - 2;
+    return true;
+}
+
+// 按全局MCU行号重写条带内的RST序号：第i个RST位于全局第(firstMcuRow + i + 1)个MCU行之前
+void renumberRestartMarkers(JpegStrip& strip) {
+    int index = 0;
+    for (size_t i = strip.entropyBegin; i + 1 < strip.entropyEnd; ++i) {
+        if (strip.encoded[i] != 0xFF) {
+            continue;
+        }
+        uint8_t next = strip.encoded[i + 1];
+        if (next >= 0xD0 && next <= 0xD7) {
+            strip.encoded[i + 1] = static_cast<uint8_t>(0xD0 + ((strip.firstMcuRow + index) & 7));
+            ++index;
+        }
+        // 0xFF 0x00为字节填充，跳过第二个字节
+        ++i;
+    }
+}
+
+} // namespace
+
+// ==================== ParallelEncoder 实现 ====================
+
+bool ParallelEncoder::supportsPixmap(const SkPixmap& pixmap) {
+    return pixmap.addr() != nullptr
+        && pixmap.width() > 0 && pixmap.height() > 0
+        && (pixmap.colorType() == kRGBA_8888_SkColorType || pixmap.colorType() == kBGRA_8888_SkColorType);
+}
+
+bool ParallelEncoder::encodePng(SkWStream* stream, const SkPixmap& pixmap, int zlibLevel,
+                                SkPngEncoder::FilterFlag filters, int stripCount) {
+    if (!stream || !supportsPixmap(pixmap)) {
+        return false;
+    }
+
+    const int width = pixmap.width();
+    const int height = pixmap.height();
+    const bool opaque = pixmap.alphaType() == kOpaque_SkAlphaType;
+    const int bpp = opaque ? 3 : 4;
+    const size_t rowLength = static_cast<size_t>(width) * bpp;
+    const size_t filteredRowLength = rowLength + 1;
+    zlibLevel = std::clamp(zlibLevel, 0, 9);
+    int allowedFilters = static_cast<int>(filters) & static_cast<int>(SkPngEncoder::FilterFlag::kAll);
+    if (allowedFilters == 0) {
+        allowedFilters = static_cast<int>(SkPngEncoder::FilterFlag::kNone);
+    }
+
+    // 切分条带
+    int rowsPerStrip = 0;
+    if (stripCount > 0) {
+        rowsPerStrip = (height + stripCount - 1) / stripCount;
+    } else {
+        rowsPerStrip = static_cast<int>(std::max<size_t>(8, kPngTargetStripBytes / filteredRowLength));
+    }
+    rowsPerStrip = std::clamp(rowsPerStrip, 1, height);
+    std::vector<PngStrip> strips;
+    for (int y = 0; y < height; y += rowsPerStrip) {
+        PngStrip strip;
+        strip.firstRow = y;
+        strip.rowCount = std::min(rowsPerStrip, height - y);
+        strip.offset = static_cast<size_t>(y) * filteredRowLength;
+        strip.length = static_cast<size_t>(strip.rowCount) * filteredRowLength;
+        strips.push_back(std::move(strip));
+    }
+    const int count = static_cast<int>(strips.size());
+
+    // 第一阶段：转换为非预乘的RGB/RGBA字节
+    std::vector<uint8_t> raw(rowLength * height);
+    SkImageInfo rowInfo = SkImageInfo::Make(width, 1, kRGBA_8888_SkColorType,
+                                            opaque ? kOpaque_SkAlphaType : kUnpremul_SkAlphaType);
+    ThreadPool::parallelFor(count, [&](int index) {
+        const PngStrip& strip = strips[index];
+        std::vector<uint8_t> rgba(static_cast<size_t>(width) * 4);
+        for (int y = strip.firstRow; y < strip.firstRow + strip.rowCount; ++y) {
+            uint8_t* dst = raw.data() + rowLength * y;
+            if (!pixmap.readPixels(rowInfo, opaque ? rgba.data() : dst, width * 4, 0, y)) {
+                memset(dst, 0, rowLength);
+                continue;
+            }
+            if (opaque) {
+                for (int x = 0; x < width; ++x) {
+                    memcpy(dst + x * 3, rgba.data() + x * 4, 3);
+                }
+            }
+        }
+    });
+
+    // 第二阶段：行过滤，上一行总是取自完整图像，与串行编码一致
+    std::vector<uint8_t> filtered(filteredRowLength * height);
+    ThreadPool::parallelFor(count, [&](int index) {
+        const PngStrip& strip = strips[index];
+        std::vector<uint8_t> scratch(rowLength);
+        for (int y = strip.firstRow; y < strip.firstRow + strip.rowCount; ++y) {
+            const uint8_t* row = raw.data() + rowLength * y;
+            const uint8_t* prior = y > 0 ? row - rowLength : nullptr;
+            filterRowBest(allowedFilters, row, prior, rowLength, bpp,
+                          filtered.data() + filteredRowLength * y, scratch);
+        }
+    });
+    raw = std::vector<uint8_t>();
+
+    // 第三阶段：各条带独立deflate
+    ThreadPool::parallelFor(count, [&](int index) {
+        strips[index].success = deflateStrip(filtered.data(), strips[index], zlibLevel, index == count - 1);
+    });
+    for (const auto& strip : strips) {
+        if (!strip.success) {
+            return false;
+        }
+    }
+
+    // 合并Adler-32
+    uint32_t adler = strips[0].adler;
+    for (int i = 1; i < count; ++i) {
+        adler = static_cast<uint32_t>(adler32_combine(adler, strips[i].adler, static_cast<z_off_t>(strips[i].length)));
+    }
+
+    // 输出PNG：签名、IHDR、sRGB/iCCP、zlib头、各条带IDAT、Adler-32、IEND
+    static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    if (!stream->write(kSignature, sizeof(kSignature))) {
+        return false;
+    }
+
+    uint8_t ihdr[13];
+    writeBigEndian32(ihdr, static_cast<uint32_t>(width));
+    writeBigEndian32(ihdr + 4, static_cast<uint32_t>(height));
+    ihdr[8] = 8;                // 位深
+    ihdr[9] = opaque ? 2 : 6;   // 颜色类型：RGB / RGBA
+    ihdr[10] = 0;               // 压缩方法
+    ihdr[11] = 0;               // 过滤方法
+    ihdr[12] = 0;               // 无隔行
+    if (!writePngChunk(stream, "IHDR", ihdr, sizeof(ihdr), pngChunkCrc("IHDR", ihdr, sizeof(ihdr)))
+        || !writePngColorSpace(stream, pixmap)) {
+        return false;
+    }
+
+    // zlib头：CMF=0x78（deflate，32KB窗口），FLEVEL与zlib自身的取值规则一致
+    int flevel = zlibLevel < 2 ? 0 : (zlibLevel < 6 ? 1 : (zlibLevel == 6 ? 2 : 3));
+    uint8_t zlibHeader[2] = {0x78, static_cast<uint8_t>(flevel << 6)};
+    zlibHeader[1] = static_cast<uint8_t>(zlibHeader[1] + 31 - ((zlibHeader[0] * 256 + zlibHeader[1]) % 31));
+    if (!writePngChunk(stream, "IDAT", zlibHeader, 2, pngChunkCrc("IDAT", zlibHeader, 2))) {
+        return false;
+    }
+
+    for (const auto& strip : strips) {
+        if (!writePngChunk(stream, "IDAT", strip.compressed.data(), strip.compressed.size(), strip.crc)) {
+            return false;
+        }
+    }
+
+    uint8_t adlerBytes[4];
+    writeBigEndian32(adlerBytes, adler);
+    if (!writePngChunk(stream, "IDAT", adlerBytes, 4, pngChunkCrc("IDAT", adlerBytes, 4))) {
+        return false;
+    }
+
+    return writePngChunk(stream, "IEND", nullptr, 0, pngChunkCrc("IEND", nullptr, 0));
+}
+
+bool ParallelEncoder::encodeJpeg(SkWStream* stream, const SkPixmap& pixmap, int quality,
+                                 SkJpegEncoder::Downsample downsample, int stripCount) {
+    if (!stream || !supportsPixmap(pixmap) || pixmap.height() > 65535 || pixmap.width() > 65535) {
+        return false;
+    }
+
+    const int height = pixmap.height();
+    const int mcuHeight = downsample == SkJpegEncoder::Downsample::k420 ? 16 : 8;
+    const int mcuRows = (height + mcuHeight - 1) / mcuHeight;
+
+    // 条带高度必须是MCU高度的整数倍，只有最后一个条带允许不满
+    if (stripCount <= 0) {
+        stripCount = ThreadPool::threadCount() * 2;
+    }
+    stripCount = std::clamp(stripCount, 1, mcuRows);
+    const int mcuRowsPerStrip = (mcuRows + stripCount - 1) / stripCount;
+
+    std::vector<JpegStrip> strips;
+    for (int mcuRow = 0; mcuRow < mcuRows; mcuRow += mcuRowsPerStrip) {
+        JpegStrip strip;
+        strip.firstMcuRow = mcuRow;
+        strip.firstRow = mcuRow * mcuHeight;
+        strip.rowCount = std::min(mcuRowsPerStrip * mcuHeight, height - strip.firstRow);
+        strips.push_back(std::move(strip));
+    }
+    const int count = static_cast<int>(strips.size());
+
+    sk_sp<SkData> icc = iccProfileFor(pixmap);
+    ThreadPool::parallelFor(count, [&](int index) {
+        JpegStrip& strip = strips[index];
+        strip.success = encodeJpegStrip(pixmap, strip, quality, downsample, index == 0 ? icc.get() : nullptr)
+            && locateJpegSegments(strip.encoded, strip, index == 0 ? height : 0);
+        if (strip.success) {
+            renumberRestartMarkers(strip);
+        }
+    });
+    for (const auto& strip : strips) {
+        if (!strip.success) {
+            return false;
+        }
+    }
+
+    // 文件头（SOI到SOS）取第一个条带，SOF高度已改为整图高度
+    const JpegStrip& first = strips[0];
+    if (!stream->write(first.encoded.data(), first.entropyBegin)) {
+        return false;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const JpegStrip& strip = strips[i];
+        if (i > 0) {
+            // 条带之间补一个RST，编码器在这里重置DC预测，与新条带从零开始预测一致
+            uint8_t restart[2] = {0xFF, static_cast<uint8_t>(0xD0 + ((strip.firstMcuRow - 1) & 7))};
+            if (!stream->write(restart, 2)) {
+                return false;
+            }
+        }
+        if (!stream->write(strip.encoded.data() + strip.entropyBegin, strip.entropyEnd - strip.entropyBegin)) {
+            return false;
+        }
+    }
+
+    static const uint8_t kEndOfImage[2] = {0xFF, 0xD9};
+    return stream->write(kEndOfImage, 2);
+}
+
+} // namespace skia_renderer
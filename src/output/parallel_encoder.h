@@ -0,0 +1,46 @@
+#pragma once
+
+#include "include/core/SkPixmap.h"
+#include "include/core/SkStream.h"
+#include "include/encode/SkJpegEncoder.h"
+#include "include/encode/SkPngEncoder.h"
+
+namespace skia_renderer {
+
+/**
+ * 并行条带编码器 - 把大图切成水平条带在线程池上并发压缩，输出仍是标准PNG/JPEG码流
+ *
+ * PNG（pigz方式）：
+ * - 先并行完成行过滤，每行的Up/Avg/Paeth过滤都参考真实的上一行，与串行编码一致
+ * - 每个条带独立做raw deflate，以前一条带末尾32KB的过滤后数据作为预置字典
+ * - 非末尾条带以Z_SYNC_FLUSH结束（字节对齐、不带结束标记），拼接后是一个合法的zlib流
+ * - Adler-32通过adler32_combine按顺序合并
+ *
+ * JPEG：
+ * - 条带高度取MCU高度的整数倍，每个条带用同一套量化表和标准Huffman表独立编码
+ * - 每个MCU行后插入RST标记，条带之间补一个RST，并按全局行号重写RST序号
+ * - DCT系数与串行编码完全相同，解码后的像素一致
+ *
+ * 像素带色彩空间时写入与Skia编码器相同的色彩信息：PNG为sRGB块或iCCP块，JPEG为ICC配置的APP2段
+ *
+ * 只支持RGBA_8888/BGRA_8888像素，其他格式请回退到Skia编码器
+ */
+class ParallelEncoder {
+public:
+    // 是否支持该像素格式
+    static bool supportsPixmap(const SkPixmap& pixmap);
+
+    // 并行编码PNG，stripCount为0时按图像大小自动切分，为1时等价于串行编码
+    static bool encodePng(SkWStream* stream, const SkPixmap& pixmap,
+                          int zlibLevel = 6,
+                          SkPngEncoder::FilterFlag filters = SkPngEncoder::FilterFlag::kAll,
+                          int stripCount = 0);
+
+    // 并行编码JPEG，stripCount为0时按线程数自动切分，为1时等价于串行编码
+    static bool encodeJpeg(SkWStream* stream, const SkPixmap& pixmap,
+                           int quality = 100,
+                           SkJpegEncoder::Downsample downsample = SkJpegEncoder::Downsample::k420,
+                           int stripCount = 0);
+};
+
+} // namespace skia_renderer
@@ -1,6 +1,7 @@
 #include "parsers/protocol_parser.h"
 #include "utils/color_parser.h"
 #include <fstream>
+#include <set>
 #include <sstream>
 #include <iostream>
 
@@ -39,6 +40,7 @@ bool ProtocolParser::loadFromString(const std::string& jsonString) {
 
 bool ProtocolParser::parseProtocol(const json& j) {
     valid = false;
+    protocol = RenderProtocol();
     
     // 解析画布配置
     if (j.contains("canvas")) {
@@ -64,9 +66,13 @@ bool ProtocolParser::parseProtocol(const json& j) {
         }
     }
     
-    // 解析输出配置
-    if (j.contains("output")) {
-        if (!parseOutput(j["output"])) {
+    // 解析输出配置，"output"可以是单个对象或数组，"outputs"为数组
+    if (j.contains("outputs")) {
+        if (!parseOutputs(j["outputs"])) {
+            return false;
+        }
+    } else if (j.contains("output")) {
+        if (!parseOutputs(j["output"])) {
             return false;
         }
     }
@@ -80,6 +86,9 @@ bool ProtocolParser::parseCanvas(const json& j) {
     protocol.canvas.height = parseInt(j, "height", 1660);
     protocol.canvas.background = parseString(j, "background", "#FFFFFF");
     protocol.canvas.debug = parseBool(j, "debug", false);
+    protocol.canvas.tiledRaster = parseBool(j, "tiledRaster", false);
+    protocol.canvas.tileCount = parseInt(j, "tileCount", 0);
+    protocol.canvas.imageSampling = parseSampling(j, "imageSampling", ImageSampling::Nearest);
     return true;
 }
 
@@ -96,6 +105,7 @@ bool ProtocolParser::parseImages(const json& j) {
         img.path = parseString(imgJson, "path", "");
         img.width = parseInt(imgJson, "width", 0);
         img.height = parseInt(imgJson, "height", 0);
+        img.sampling = parseSampling(imgJson, "sampling", ImageSampling::Inherit);
         
         if (!parseTransform(imgJson, img.transform)) {
             return false;
@@ -151,10 +161,55 @@ bool ProtocolParser::parseTexts(const json& j) {
     return true;
 }
 
-bool ProtocolParser::parseOutput(const json& j) {
-    protocol.output.format = parseString(j, "format", "png");
-    protocol.output.filename = parseString(j, "filename", "output.png");
-    protocol.output.quality = parseInt(j, "quality", 100);
+bool ProtocolParser::parseOutputs(const json& j) {
+    protocol.outputs.clear();
+    
+    if (j.is_object()) {
+        OutputConfig output;
+        if (!parseOutput(j, output)) {
+            return false;
+        }
+        protocol.outputs.push_back(output);
+        return true;
+    }
+    
+    if (!j.is_array() || j.empty()) {
+        errorMessage = "输出配置必须是对象或非空数组";
+        return false;
+    }
+    
+    // 输出目标按文件名区分各个输出，文件名重复时后写的会覆盖先写的
+    std::set<std::string> filenames;
+    for (const auto& outputJson : j) {
+        OutputConfig output;
+        if (!parseOutput(outputJson, output)) {
+            return false;
+        }
+        if (!filenames.insert(output.filename).second) {
+            errorMessage = "输出文件名重复: " + output.filename;
+            return false;
+        }
+        protocol.outputs.push_back(output);
+    }
+    return true;
+}
+
+bool ProtocolParser::parseOutput(const json& j, OutputConfig& output) {
+    output.format = parseString(j, "format", "");
+    output.filename = parseString(j, "filename", "output.png");
+    output.quality = parseInt(j, "quality", 100);
+    output.profile = parseString(j, "profile", "");
+    output.compressionLevel = parseInt(j, "compressionLevel", -1);
+    output.pngFilter = parseString(j, "pngFilter", "");
+    output.chromaSubsampling = parseString(j, "chromaSubsampling", "");
+    if (j.contains("chromaSubsampling") && j["chromaSubsampling"].is_number()) {
+        output.chromaSubsampling = std::to_string(j["chromaSubsampling"].get<int>());
+    }
+    output.lossless = parseBool(j, "lossless", false);
+    output.dropAlpha = parseBool(j, "dropAlpha", true);
+    output.parallelEncode = parseBool(j, "parallelEncode", false);
+    output.width = parseInt(j, "width", 0);
+    output.height = parseInt(j, "height", 0);
     return true;
 }
 
@@ -226,6 +281,22 @@ bool ProtocolParser::parseBool(const json& j, const std::string& key, bool defau
     return defaultValue;
 }
 
+ImageSampling ProtocolParser::parseSampling(const json& j, const std::string& key, ImageSampling defaultValue) {
+    std::string value = parseString(j, key, "");
+    if (value == "nearest") {
+        return ImageSampling::Nearest;
+    } else if (value == "linear") {
+        return ImageSampling::Linear;
+    } else if (value == "mipmap") {
+        return ImageSampling::Mipmap;
+    } else if (value == "cubic") {
+        return ImageSampling::Cubic;
+    } else if (value == "auto") {
+        return ImageSampling::Auto;
+    }
+    return defaultValue; // 未设置或无法识别时使用默认值
+}
+
 bool ProtocolParser::parseRichTextSegments(const json& j, std::vector<RichTextSegment>& segments) {
     if (!j.is_array()) {
         errorMessage = "richTextSegments必须是数组";
@@ -38,7 +38,8 @@ private:
     bool parseCanvas(const json& j);
     bool parseImages(const json& j);
     bool parseTexts(const json& j);
-    bool parseOutput(const json& j);
+    bool parseOutputs(const json& j);
+    bool parseOutput(const json& j, OutputConfig& output);
     bool parseTransform(const json& j, Transform& transform);
     bool parseTextStyle(const json& j, TextStyle& style);
     bool parseRichTextSegments(const json& j, std::vector<RichTextSegment>& segments);
@@ -48,6 +49,7 @@ private:
     std::string parseString(const json& j, const std::string& key, const std::string& defaultValue = "");
     int parseInt(const json& j, const std::string& key, int defaultValue = 0);
     bool parseBool(const json& j, const std::string& key, bool defaultValue = false);
+    ImageSampling parseSampling(const json& j, const std::string& key, ImageSampling defaultValue);
 };
 
 } // namespace skia_renderer 
\ No newline at end of file
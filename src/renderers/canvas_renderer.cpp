@@ -1,4 +1,5 @@
 #include "renderers/canvas_renderer.h"
+#include "resources/surface_pool.h"
 #include <iostream>
 
 namespace skia_renderer {
@@ -16,7 +17,11 @@ bool CanvasRenderer::createCanvas(int width, int height) {
         SkColorType::kRGBA_8888_SkColorType,
         SkAlphaType::kOpaque_SkAlphaType);
 
-    surface = SkSurfaces::Raster(info);
+    // 优先从Surface池获取，复用上一张同尺寸海报的像素内存
+    surface = SurfacePool::shared().acquire(info);
+    if (!surface) {
+        surface = SkSurfaces::Raster(info);
+    }
     if (!surface) {
         std::cerr << "无法创建Surface" << std::endl;
         return false;
@@ -30,13 +35,17 @@ bool CanvasRenderer::createCanvas(int width, int height) {
 }
 
 bool CanvasRenderer::setBackground(const std::string &backgroundColor) {
-    if (!canvas) {
+    return setBackground(canvas, backgroundColor);
+}
+
+bool CanvasRenderer::setBackground(SkCanvas *targetCanvas, const std::string &backgroundColor) {
+    if (!targetCanvas) {
         std::cerr << "画布未初始化" << std::endl;
         return false;
     }
 
     SkColor color = parseBackgroundColor(backgroundColor);
-    canvas->clear(color);
+    targetCanvas->clear(color);
     return true;
 }
 
@@ -55,6 +64,17 @@ sk_sp<SkImage> CanvasRenderer::makeImageSnapshot() {
     return surface->makeImageSnapshot();
 }
 
+sk_sp<SkImage> CanvasRenderer::detachImage() {
+    if (!surface) {
+        return nullptr;
+    }
+    // 池中Surface直接把像素包装为图像；Surface随即释放，不会再有写入
+    sk_sp<SkImage> image = SurfacePool::shared().detachImage(surface);
+    canvas = nullptr;
+    surface.reset();
+    return image;
+}
+
 SkColor CanvasRenderer::parseBackgroundColor(const std::string &colorString) {
     return ColorParser::parseColor(colorString);
 }
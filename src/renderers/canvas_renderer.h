@@ -13,12 +13,15 @@ public:
     CanvasRenderer();
     ~CanvasRenderer();
     
-    // 创建画布
+    // 创建画布，像素内存可能来自Surface池，内容未定义，绘制前需先setBackground
     bool createCanvas(int width, int height);
     
     // 设置背景
     bool setBackground(const std::string& backgroundColor);
     
+    // 在指定画布上绘制背景（用于录制Picture等不直接绘制到Surface的场景）
+    bool setBackground(SkCanvas* canvas, const std::string& backgroundColor);
+    
     // 获取画布
     SkCanvas* getCanvas() const;
     
@@ -27,6 +30,11 @@ public:
     
     // 获取图像快照
     sk_sp<SkImage> makeImageSnapshot();
+    
+    // 取走渲染结果：像素直接交给返回的图像（池中Surface零拷贝）并释放Surface
+    // Surface不再存在，之后也就不会触发写时复制；图像释放后像素内存回到Surface池
+    // 下一次渲染需要重新createCanvas
+    sk_sp<SkImage> detachImage();
 
 private:
     sk_sp<SkSurface> surface;
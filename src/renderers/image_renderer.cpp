@@ -1,9 +1,81 @@
 #include "renderers/image_renderer.h"
+#include "resources/image_cache.h"
+#include "resources/image_decoder.h"
+#include "utils/thread_pool.h"
+#include "include/core/SkMatrix.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
 #include <iostream>
+#include <map>
 
 namespace skia_renderer {
 
-ImageRenderer::ImageRenderer() {
+namespace {
+
+// 可见区域向外扩展的原图像素数，保证边缘像素采样时邻近像素也已解码
+constexpr int kRegionMargin = 2;
+
+// 可见区域占原图面积超过该比例时直接解码整张图，整图结果可以被其他摆放方式复用
+constexpr double kFullDecodeAreaRatio = 0.75;
+
+// 自动采样：缩小到该比例以下使用mipmap
+constexpr float kMipmapScaleThreshold = 0.5f;
+
+// 原图像素到画布像素的完整变换：元素变换 × 原图到目标矩形的缩放
+SkMatrix elementMatrix(const ImageElement& imageElement, const SkISize& imageSize) {
+    const Transform& transform = imageElement.transform;
+    SkMatrix matrix = SkMatrix::Translate(transform.x, transform.y);
+    matrix.preScale(transform.scaleX, transform.scaleY);
+    matrix.preRotate(transform.rotation);
+    matrix.preScale(static_cast<float>(imageElement.width) / imageSize.width(),
+                    static_cast<float>(imageElement.height) / imageSize.height());
+    return matrix;
+}
+
+// 默认解码预算：单张256MB（约8000x8000），单次渲染768MB
+constexpr size_t kDefaultMaxImageDecodeBytes = 256 * 1024 * 1024;
+constexpr size_t kDefaultMaxRenderDecodeBytes = 768 * 1024 * 1024;
+
+// 解码为N32像素需要的字节数，带mipmap时加上金字塔约1/3
+size_t estimateDecodeBytes(const SkISize& size, int sampleSize, bool mipmaps) {
+    SkISize sampled = ImageDecoder::sampledSize(size, sampleSize);
+    size_t bytes = static_cast<size_t>(sampled.width()) * static_cast<size_t>(sampled.height()) * 4;
+    return mipmaps ? bytes + bytes / 3 : bytes;
+}
+
+// 只含平移、旋转和等比缩放的矩阵可以表示为RSXform（drawAtlas的逐精灵变换）
+bool matrixToRSXform(const SkMatrix& matrix, SkRSXform* xform) {
+    if (matrix.hasPerspective()) {
+        return false;
+    }
+    float scaleX = matrix.getScaleX();
+    float skewX = matrix.getSkewX();
+    float skewY = matrix.getSkewY();
+    float scaleY = matrix.getScaleY();
+    float tolerance = 1e-5f * std::max(1.0f, std::abs(scaleX) + std::abs(skewY));
+    if (std::abs(scaleX - scaleY) > tolerance || std::abs(skewX + skewY) > tolerance ||
+        scaleX * scaleX + skewY * skewY <= 0.0f) {
+        return false;
+    }
+    *xform = SkRSXform::Make(scaleX, skewY, matrix.getTranslateX(), matrix.getTranslateY());
+    return true;
+}
+
+std::string formatMegabytes(size_t bytes) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1fMB", bytes / (1024.0 * 1024.0));
+    return text;
+}
+
+} // namespace
+
+ImageRenderer::ImageRenderer() :
+    imageSource(std::make_shared<ImageSource>()),
+    defaultSampling(ImageSampling::Nearest),
+    maxImageDecodeBytes(kDefaultMaxImageDecodeBytes),
+    maxRenderDecodeBytes(kDefaultMaxRenderDecodeBytes) {
 }
 
 ImageRenderer::~ImageRenderer() {
@@ -15,10 +87,27 @@ bool ImageRenderer::renderImage(SkCanvas *canvas, const ImageElement &imageEleme
         return false;
     }
 
-    // 加载图片
-    sk_sp<SkImage> image = loadImage(imageElement.path);
+    // 优先使用预取阶段解码好的图像
+    sk_sp<SkImage> image;
+    SkIRect region;
+    SkISize dimensions;
+    auto prefetchedImage = prefetched.find(imageElement.path);
+    if (prefetchedImage != prefetched.end()) {
+        if (!prefetchedImage->second.visible) {
+            return true;
+        }
+        image = prefetchedImage->second.image;
+        region = prefetchedImage->second.region;
+        dimensions = prefetchedImage->second.dimensions;
+    } else {
+        image = loadImage(imageElement.path);
+        if (image) {
+            dimensions = image->dimensions();
+            region = SkIRect::MakeSize(dimensions);
+        }
+    }
     if (!image) {
-        std::cerr << "无法加载图片: " << imageElement.path << std::endl;
+        std::cerr << "无法加载图片: " << ImageSource::displayName(imageElement.path) << std::endl;
         return false;
     }
 
@@ -32,7 +121,8 @@ bool ImageRenderer::renderImage(SkCanvas *canvas, const ImageElement &imageEleme
     applyTransform(canvas, imageElement.transform);
     
     // 2. 然后在变换后的坐标系中绘制图片（矩形+绘制参数）
-    drawImage(canvas, image, imageElement);
+    SkSamplingOptions sampling = samplingOptions(resolveSampling(imageElement, defaultSampling, dimensions));
+    drawImage(canvas, image, region, dimensions, sampling, imageElement);
     
     // 【状态恢复】弹出栈顶状态，恢复到save()时刻的状态
     // 效果：完全清除applyTransform()造成的变换，回到进入函数时的状态
@@ -43,17 +133,392 @@ bool ImageRenderer::renderImage(SkCanvas *canvas, const ImageElement &imageEleme
 }
 
 sk_sp<SkImage> ImageRenderer::loadImage(const std::string &imagePath) {
-    sk_sp<SkData> data = SkData::MakeFromFileName(imagePath.c_str());
-    if (!data) {
+    std::string key = imageSource->cacheKey(imagePath);
+    if (key.empty()) {
         return nullptr;
     }
-
-    return SkImages::DeferredFromEncodedData(data);
+    
+    sk_sp<SkImage> image = ImageCache::shared().find(key);
+    if (image) {
+        return image;
+    }
+    
+    // 先读文件头检查单张预算，超出时不分配像素
+    sk_sp<SkData> data = imageSource->load(imagePath);
+    SkISize dimensions;
+    if (!data || !ImageDecoder::readDimensions(data, &dimensions)) {
+        return nullptr;
+    }
+    size_t bytes = estimateDecodeBytes(dimensions, 1, false);
+    if (bytes > maxImageDecodeBytes) {
+        std::cerr << "图片解码超出单张预算: " << ImageSource::displayName(imagePath) << " 需要"
+                  << formatMegabytes(bytes) << "，上限" << formatMegabytes(maxImageDecodeBytes) << std::endl;
+        return nullptr;
+    }
+    
+    // 延迟图像只在第一次绘制时解码，这里立即解码为光栅图像，把解码留在调用线程
+    SkIRect decodedRegion;
+    image = ImageDecoder::decode(data, SkIRect::MakeEmpty(), &decodedRegion);
+    if (image) {
+        ImageCache::shared().insert(key, image);
+    }
+    return image;
 }
 
 bool ImageRenderer::isValidImage(const std::string &imagePath) {
-    sk_sp<SkImage> image = loadImage(imagePath);
-    return image != nullptr;
+    sk_sp<SkData> data = imageSource->load(imagePath);
+    return data && SkImages::DeferredFromEncodedData(data) != nullptr;
+}
+
+bool ImageRenderer::prefetchImages(const std::vector<ImageElement>& images, const SkISize& canvasSize) {
+    clearPrefetched();
+    errorMessage.clear();
+    
+    // 同一素材只解码一次，解码区域为所有引用它的元素可见区域的并集；由图集合批绘制的元素不需要解码
+    std::map<std::string, std::vector<const ImageElement*>> elementsByPath;
+    SpriteDraw sprite;
+    for (const auto& image : images) {
+        if (!findSprite(image, &sprite)) {
+            elementsByPath[image.path].push_back(&image);
+        }
+    }
+    std::vector<DecodePlan> plans;
+    for (auto& entry : elementsByPath) {
+        DecodePlan plan;
+        plan.path = entry.first;
+        plan.elements = std::move(entry.second);
+        plans.push_back(std::move(plan));
+    }
+    std::vector<char> probed(plans.size(), 0);
+    std::vector<char> succeeded(plans.size(), 0);
+    std::vector<PrefetchedImage> decoded(plans.size());
+    
+    auto forEachPlan = [&](const std::function<void(int)>& task) {
+        if (plans.size() == 1) {
+            task(0);
+        } else if (plans.size() > 1) {
+            ThreadPool::parallelFor(static_cast<int>(plans.size()), task);
+        }
+    };
+    
+    // 第一步：只读文件头，确定每个素材的解码区域、降采样倍数和需要分配的像素字节数
+    forEachPlan([&](int i) {
+        probed[i] = probeImage(canvasSize, &plans[i]);
+    });
+    
+    // 第二步：在分配任何像素之前检查预算
+    size_t renderBytes = 0;
+    for (size_t i = 0; i < plans.size(); ++i) {
+        if (!probed[i]) {
+            continue;
+        }
+        if (!plans[i].error.empty()) {
+            errorMessage = plans[i].error;
+            return false;
+        }
+        renderBytes += plans[i].decodeBytes;
+    }
+    if (renderBytes > maxRenderDecodeBytes) {
+        errorMessage = "图片解码超出单次渲染预算: 需要解码" + formatMegabytes(renderBytes) + "像素，上限" +
+                       formatMegabytes(maxRenderDecodeBytes);
+        return false;
+    }
+    
+    // 第三步：并发解码
+    forEachPlan([&](int i) {
+        if (probed[i]) {
+            succeeded[i] = decodePlan(&plans[i], &decoded[i]);
+        }
+    });
+    
+    // 无法读取或解码的图片不放入预取表，renderImage会重试一次并报告错误
+    for (size_t i = 0; i < plans.size(); ++i) {
+        if (succeeded[i]) {
+            prefetched[plans[i].path] = std::move(decoded[i]);
+        }
+    }
+    return true;
+}
+
+bool ImageRenderer::probeImage(const SkISize& canvasSize, DecodePlan* plan) const {
+    SkISize dimensions = SkISize::MakeEmpty();
+    std::string key = imageSource->cacheKey(plan->path, &dimensions);
+    if (key.empty()) {
+        return false;
+    }
+    
+    // 原图尺寸：资源包内的图片使用打包时记录的尺寸，其次使用记忆，否则只解析文件头，不解码像素
+    ImageCache& cache = ImageCache::shared();
+    if (dimensions.isEmpty() && !cache.findDimensions(key, &dimensions)) {
+        plan->data = imageSource->load(plan->path);
+        if (!plan->data || !ImageDecoder::readDimensions(plan->data, &dimensions)) {
+            return false;
+        }
+        cache.insertDimensions(key, dimensions);
+    }
+    plan->dimensions = dimensions;
+    
+    SkIRect region = SkIRect::MakeEmpty();
+    float maxScale = 0.0f;
+    for (const ImageElement* element : plan->elements) {
+        SkIRect visible = visibleSourceRect(*element, dimensions, canvasSize);
+        if (!visible.isEmpty()) {
+            region.join(visible);
+            maxScale = std::max(maxScale, elementMatrix(*element, dimensions).getMaxScale());
+        }
+        plan->needsMipmaps |= resolveSampling(*element, defaultSampling, dimensions) == ImageSampling::Mipmap;
+    }
+    if (region.isEmpty()) {
+        plan->region = region;
+        return true;
+    }
+    
+    SkIRect fullBounds = SkIRect::MakeSize(dimensions);
+    double areaRatio = static_cast<double>(region.width()) * region.height() /
+                       (static_cast<double>(dimensions.width()) * dimensions.height());
+    // mipmap金字塔由解码出的像素逐级减半生成，从区域生成时各层的像素网格随区域原点偏移，
+    // 与整图的金字塔不同；需要mipmap的素材总是解码整张图，结果与区域无关
+    if (areaRatio >= kFullDecodeAreaRatio || plan->needsMipmaps) {
+        region = fullBounds;
+    }
+    
+    // 超出单张预算时尝试降采样：降采样后仍不小于显示尺寸（sampleSize * 最大缩放比例 <= 1）才不损失清晰度
+    int sampleSize = 1;
+    size_t bytes = estimateDecodeBytes(region.size(), 1, plan->needsMipmaps);
+    if (bytes > maxImageDecodeBytes) {
+        while (bytes > maxImageDecodeBytes && maxScale > 0.0f && sampleSize * 2 * maxScale <= 1.0f) {
+            sampleSize *= 2;
+            bytes = estimateDecodeBytes(dimensions, sampleSize, plan->needsMipmaps);
+        }
+        if (sampleSize > 1) {
+            region = fullBounds;    // 降采样总是解码整张图
+        }
+        if (bytes > maxImageDecodeBytes) {
+            plan->error = "图片解码超出单张预算: " + ImageSource::displayName(plan->path) + " (" +
+                          std::to_string(dimensions.width()) + "x" + std::to_string(dimensions.height()) + ") 需要解码" + formatMegabytes(bytes) +
+                          "像素，上限" + formatMegabytes(maxImageDecodeBytes) + "，显示尺寸不允许进一步降采样";
+            return true;
+        }
+    }
+    plan->region = region;
+    plan->sampleSize = sampleSize;
+    
+    // 整图与区域结果分别缓存，区域键带上区域坐标，降采样键带上倍数
+    plan->cacheKey = key;
+    if (region != fullBounds) {
+        plan->cacheKey += "#" + std::to_string(region.left()) + "," + std::to_string(region.top()) + "," +
+                          std::to_string(region.right()) + "," + std::to_string(region.bottom());
+    }
+    if (sampleSize > 1) {
+        plan->cacheKey += "@" + std::to_string(sampleSize);
+    }
+    
+    // 已在缓存中的素材不需要分配新像素
+    plan->cached = cache.find(plan->cacheKey, &plan->cachedRegion);
+    plan->decodeBytes = plan->cached ? 0 : bytes;
+    return true;
+}
+
+bool ImageRenderer::decodePlan(DecodePlan* plan, PrefetchedImage* result) const {
+    result->dimensions = plan->dimensions;
+    if (plan->region.isEmpty()) {
+        result->visible = false;
+        return true;
+    }
+    
+    ImageCache& cache = ImageCache::shared();
+    sk_sp<SkImage> image = std::move(plan->cached);
+    SkIRect sourceRegion = plan->cachedRegion;
+    if (!image) {
+        if (!plan->data) {
+            plan->data = imageSource->load(plan->path);
+        }
+        SkIRect fullBounds = SkIRect::MakeSize(plan->dimensions);
+        image = ImageDecoder::decode(plan->data, plan->region == fullBounds ? SkIRect::MakeEmpty() : plan->region,
+                                     &sourceRegion, plan->sampleSize);
+        if (!image) {
+            return false;
+        }
+        cache.insert(plan->cacheKey, image, sourceRegion);
+    }
+    
+    // 需要mipmap的素材在解码线程上一次性生成金字塔，替换缓存中的条目，之后的缩小绘制不再重建
+    if (plan->needsMipmaps && !image->hasMipmaps()) {
+        sk_sp<SkImage> mipmapped = image->withDefaultMipmaps();
+        if (mipmapped && mipmapped->hasMipmaps()) {
+            image = std::move(mipmapped);
+            cache.insert(plan->cacheKey, image, sourceRegion);
+        }
+    }
+    
+    result->image = std::move(image);
+    result->region = sourceRegion;
+    return true;
+}
+
+void ImageRenderer::clearPrefetched() {
+    prefetched.clear();
+}
+
+size_t ImageRenderer::renderSprites(SkCanvas* canvas, const std::vector<ImageElement>& images, size_t start) {
+    if (!canvas || spriteAtlases.empty()) {
+        return 0;
+    }
+    
+    // 同一图集、同一采样方式的连续元素合成一批，保持与逐个绘制相同的前后顺序
+    std::vector<SkRSXform> xforms;
+    std::vector<SkRect> textures;
+    std::vector<SkColor> colors;
+    const SpriteAtlas* atlas = nullptr;
+    ImageSampling sampling = ImageSampling::Nearest;
+    bool allOpaque = true;
+    size_t end = start;
+    for (; end < images.size(); ++end) {
+        SpriteDraw sprite;
+        if (!findSprite(images[end], &sprite) ||
+            (atlas && (sprite.atlas != atlas || sprite.sampling != sampling))) {
+            break;
+        }
+        atlas = sprite.atlas;
+        sampling = sprite.sampling;
+        xforms.push_back(sprite.xform);
+        textures.push_back(sprite.texture);
+        // 透明度与drawImage的paint alpha相同，通过kModulate乘到精灵像素上
+        U8CPU alpha = static_cast<U8CPU>(images[end].transform.opacity * 255);
+        colors.push_back(SkColorSetA(SK_ColorWHITE, alpha));
+        allOpaque &= alpha == 0xFF;
+    }
+    if (xforms.empty()) {
+        return 0;
+    }
+    
+    canvas->drawAtlas(atlas->getImage().get(), xforms.data(), textures.data(), allOpaque ? nullptr : colors.data(),
+                      static_cast<int>(xforms.size()), SkBlendMode::kModulate, samplingOptions(sampling), nullptr,
+                      nullptr);
+    return end - start;
+}
+
+bool ImageRenderer::findSprite(const ImageElement& imageElement, SpriteDraw* sprite) const {
+    if (spriteAtlases.empty() || imageElement.width <= 0 || imageElement.height <= 0 ||
+        ImageSource::isDataUri(imageElement.path) || imageSource->hasData(imageElement.path)) {
+        return false;
+    }
+    
+    SkIRect rect;
+    const SpriteAtlas* atlas = nullptr;
+    for (const auto& candidate : spriteAtlases) {
+        if (candidate->find(imageElement.path, &rect)) {
+            atlas = candidate.get();
+            break;
+        }
+    }
+    if (!atlas) {
+        return false;
+    }
+    
+    // mipmap会跨越精灵边界采样，这类元素仍按文件单独解码绘制
+    SkISize size = rect.size();
+    ImageSampling sampling = resolveSampling(imageElement, defaultSampling, size);
+    if (sampling == ImageSampling::Mipmap ||
+        !matrixToRSXform(elementMatrix(imageElement, size), &sprite->xform)) {
+        return false;
+    }
+    sprite->atlas = atlas;
+    sprite->texture = SkRect::Make(rect);
+    sprite->sampling = sampling;
+    return true;
+}
+
+void ImageRenderer::setSpriteAtlases(std::vector<std::shared_ptr<const SpriteAtlas>> atlases) {
+    spriteAtlases = std::move(atlases);
+    clearPrefetched();
+}
+
+void ImageRenderer::setImageSource(std::shared_ptr<ImageSource> source) {
+    imageSource = source ? std::move(source) : std::make_shared<ImageSource>();
+    clearPrefetched();
+}
+
+SkIRect ImageRenderer::visibleSourceRect(const ImageElement& imageElement, const SkISize& imageSize,
+                                         const SkISize& canvasSize) {
+    if (imageElement.width <= 0 || imageElement.height <= 0 || imageSize.isEmpty()) {
+        return SkIRect::MakeEmpty();
+    }
+    
+    // 把画布边界反变换到原图像素坐标
+    SkMatrix matrix = elementMatrix(imageElement, imageSize);
+    SkMatrix inverse;
+    if (!matrix.invert(&inverse)) {
+        return SkIRect::MakeEmpty();
+    }
+    SkRect source = inverse.mapRect(SkRect::Make(canvasSize));
+    if (!source.intersect(SkRect::Make(imageSize))) {
+        return SkIRect::MakeEmpty();
+    }
+    
+    // 缩小绘制时一个画布像素覆盖多个原图像素，边距按缩小倍数放大
+    float minScale = matrix.getMinScale();
+    int margin = kRegionMargin;
+    if (minScale > 0.0f && minScale < 1.0f) {
+        margin = static_cast<int>(std::min(std::ceil(kRegionMargin / minScale), 1024.0f));
+    }
+    SkIRect region = source.roundOut().makeOutset(margin, margin);
+    if (!region.intersect(SkIRect::MakeSize(imageSize))) {
+        return SkIRect::MakeEmpty();
+    }
+    return region;
+}
+
+ImageSampling ImageRenderer::resolveSampling(const ImageElement& imageElement, ImageSampling canvasSampling,
+                                             const SkISize& imageSize) {
+    ImageSampling sampling = imageElement.sampling == ImageSampling::Inherit ? canvasSampling
+                                                                               : imageElement.sampling;
+    if (sampling == ImageSampling::Inherit) {
+        sampling = ImageSampling::Nearest;
+    }
+    if (sampling != ImageSampling::Auto) {
+        return sampling;
+    }
+    if (imageElement.width <= 0 || imageElement.height <= 0 || imageSize.isEmpty()) {
+        return ImageSampling::Nearest;
+    }
+    
+    // 自动选择：像素对齐的1:1绘制用最近邻（结果与原图完全相同），
+    // 大幅缩小用mipmap，放大用三次插值，其余（轻度缩小、旋转）用双线性
+    SkMatrix matrix = elementMatrix(imageElement, imageSize);
+    if (matrix.isTranslate() &&
+        SkScalarIsInt(matrix.getTranslateX()) && SkScalarIsInt(matrix.getTranslateY())) {
+        return ImageSampling::Nearest;
+    }
+    if (matrix.getMinScale() < kMipmapScaleThreshold) {
+        return ImageSampling::Mipmap;
+    }
+    if (matrix.getMaxScale() > 1.0f + SK_ScalarNearlyZero) {
+        return ImageSampling::Cubic;
+    }
+    return ImageSampling::Linear;
+}
+
+SkSamplingOptions ImageRenderer::samplingOptions(ImageSampling sampling) {
+    switch (sampling) {
+        case ImageSampling::Linear:
+            return SkSamplingOptions(SkFilterMode::kLinear);
+        case ImageSampling::Mipmap:
+            return SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kLinear);
+        case ImageSampling::Cubic:
+            return SkSamplingOptions(SkCubicResampler::Mitchell());
+        default:
+            return SkSamplingOptions();
+    }
+}
+
+void ImageRenderer::setDefaultSampling(ImageSampling sampling) {
+    defaultSampling = sampling;
+}
+
+void ImageRenderer::setDecodeBudget(size_t maxImageBytes, size_t maxRenderBytes) {
+    maxImageDecodeBytes = maxImageBytes;
+    maxRenderDecodeBytes = maxRenderBytes;
 }
 
 void ImageRenderer::applyTransform(SkCanvas *canvas, const Transform &transform) {
@@ -63,7 +528,9 @@ void ImageRenderer::applyTransform(SkCanvas *canvas, const Transform &transform)
     canvas->rotate(transform.rotation);                // 旋转：围绕当前原点旋转坐标系
 }
 
-void ImageRenderer::drawImage(SkCanvas *canvas, sk_sp<SkImage> image, const ImageElement &imageElement) {
+void ImageRenderer::drawImage(SkCanvas *canvas, sk_sp<SkImage> image, const SkIRect &region,
+                              const SkISize &dimensions, const SkSamplingOptions &sampling,
+                              const ImageElement &imageElement) {
     // 【第二层：目标矩形】- 定义图片在当前坐标系中的绘制区域
     // 
     // 【精确理解】(0,0) = 经过变换之后的起始位置！
@@ -76,18 +543,33 @@ void ImageRenderer::drawImage(SkCanvas *canvas, sk_sp<SkImage> image, const Imag
     // 
     // 结果：SkRect(0,0,w,h) 从变换后的起始位置开始绘制
     SkRect dstRect = SkRect::MakeXYWH(0, 0, imageElement.width, imageElement.height);
+    
+    // 区域解码的图像只覆盖原图的一部分，按相同比例只画到目标矩形的对应部分，
+    // 映射关系与整图绘制完全一致，可见像素不变
+    if (region != SkIRect::MakeSize(dimensions)) {
+        float scaleX = static_cast<float>(imageElement.width) / dimensions.width();
+        float scaleY = static_cast<float>(imageElement.height) / dimensions.height();
+        dstRect = SkRect::MakeLTRB(region.left() * scaleX, region.top() * scaleY,
+                                   region.right() * scaleX, region.bottom() * scaleY);
+    }
 
     // 【第三层：绘制参数】- 控制绘制的视觉效果（颜色、透明度等）
     SkPaint paint;
     // 将0.0-1.0的透明度转换为0-255的Alpha值
     paint.setAlpha(static_cast<U8CPU>(imageElement.transform.opacity * 255));
+    
+    // 不透明快速路径：不透明图像、完全不透明且轴对齐绘制时，src-over的结果就是源像素，
+    // 改用kSrc跳过混合计算；像素对齐的1:1绘制会进一步走Skia的逐行拷贝（sprite blitter）
+    if (image->isOpaque() && paint.getAlpha() == 0xFF && canvas->getTotalMatrix().rectStaysRect()) {
+        paint.setBlendMode(SkBlendMode::kSrc);
+    }
 
     // 最终绘制：将源图片绘制到目标矩形，应用Paint效果
     // image: 源图片数据
     // dstRect: 目标矩形（已经在变换后的坐标系中）
-    // SkSamplingOptions(): 采样选项（图片缩放时的插值方法）
+    // sampling: 采样选项（图片缩放时的插值方法，由元素/画布的采样方式决定）
     // &paint: 绘制参数（透明度等视觉效果）
-    canvas->drawImageRect(image, dstRect, SkSamplingOptions(), &paint);
+    canvas->drawImageRect(image, dstRect, sampling, &paint);
 }
 
 } // namespace skia_renderer
@@ -1,12 +1,20 @@
 #pragma once
 
 #include "core/types.h"
+#include "resources/image_source.h"
+#include "resources/sprite_atlas.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkData.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkRSXform.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkSize.h"
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace skia_renderer {
 
@@ -18,18 +26,112 @@ public:
     // 渲染图片元素
     bool renderImage(SkCanvas* canvas, const ImageElement& imageElement);
     
-    // 加载图片
+    // 从start开始，把连续的、可由图集合批的元素用一次drawAtlas画出，返回画出的元素数；
+    // 返回0表示images[start]不在图集中或不能合批（镜像/非等比缩放、mipmap采样），应走renderImage
+    size_t renderSprites(SkCanvas* canvas, const std::vector<ImageElement>& images, size_t start);
+    
+    // 设置精灵图集：图集中的素材不再单独读文件和解码，直接从图集取像素
+    void setSpriteAtlases(std::vector<std::shared_ptr<const SpriteAtlas>> atlases);
+    
+    // 加载并立即解码图片，返回光栅图像；解码结果进入共享的ImageCache
     sk_sp<SkImage> loadImage(const std::string& imagePath);
     
-    // 检查图片是否有效
+    // 检查图片是否有效（只解析文件头，不解码像素）
     bool isValidImage(const std::string& imagePath);
+    
+    // 预取：在共享线程池上并发读取和解码所有图片元素，之后renderImage直接使用解码好的图像，
+    // 绘制时不再停下来解码；多图海报的解码耗时接近最慢的一张而不是所有图片之和。
+    // 只解码画布内可见的区域（同一素材的多个元素取可见区域的并集），完全不可见的元素不解码也不绘制。
+    // 解码前先只读文件头检查解码预算，超出时返回false并设置错误信息，不分配任何像素
+    bool prefetchImages(const std::vector<ImageElement>& images, const SkISize& canvasSize);
+    
+    // 释放预取的图像（图像仍可能留在ImageCache中）
+    void clearPrefetched();
+    
+    // 设置解码预算（像素字节数）：单张图片超出时尝试降采样解码（不小于显示尺寸），仍超出则拒绝；
+    // 单次渲染新解码的像素总量超出时拒绝渲染（已在ImageCache中的不计入）
+    void setDecodeBudget(size_t maxImageBytes, size_t maxRenderBytes);
+    size_t getMaxImageDecodeBytes() const { return maxImageDecodeBytes; }
+    size_t getMaxRenderDecodeBytes() const { return maxRenderDecodeBytes; }
+    
+    // 获取错误信息
+    const std::string& getErrorMessage() const { return errorMessage; }
+    
+    // 设置图片来源（内存数据、data: URI、资源包、文件系统），默认只读文件系统和data: URI
+    void setImageSource(std::shared_ptr<ImageSource> source);
+    
+    // 设置画布默认采样方式（元素未指定sampling时使用）
+    void setDefaultSampling(ImageSampling sampling);
+    
+    // 确定元素实际使用的采样方式（Nearest/Linear/Mipmap/Cubic），Auto按原图到画布的实际缩放比例选择
+    static ImageSampling resolveSampling(const ImageElement& imageElement, ImageSampling canvasSampling,
+                                         const SkISize& imageSize);
+    
+    // 采样方式对应的Skia采样参数
+    static SkSamplingOptions samplingOptions(ImageSampling sampling);
+    
+    // 元素在画布内可见部分对应的原图像素区域（已向外扩展几个像素供采样使用），不可见时为空
+    static SkIRect visibleSourceRect(const ImageElement& imageElement, const SkISize& imageSize,
+                                     const SkISize& canvasSize);
 
 private:
+    // 预取得到的图像，region为image在原图中的位置；visible为false表示元素完全在画布外
+    struct PrefetchedImage {
+        sk_sp<SkImage> image;
+        SkIRect region = SkIRect::MakeEmpty();
+        SkISize dimensions = SkISize::MakeEmpty();
+        bool visible = true;
+    };
+    
+    // 一个素材的解码计划，由文件头探测得到
+    struct DecodePlan {
+        std::string path;
+        std::vector<const ImageElement*> elements;  // 引用该素材的元素
+        sk_sp<SkData> data;                         // 探测时读取的文件，解码时复用
+        SkISize dimensions = SkISize::MakeEmpty();  // 原图尺寸
+        SkIRect region = SkIRect::MakeEmpty();      // 要解码的原图区域，为空表示完全不可见
+        int sampleSize = 1;                         // 降采样倍数
+        bool needsMipmaps = false;
+        std::string cacheKey;                       // ImageCache键，包含区域和降采样倍数
+        sk_sp<SkImage> cached;                      // 探测时已命中缓存的图像
+        SkIRect cachedRegion = SkIRect::MakeEmpty();
+        size_t decodeBytes = 0;                     // 需要新分配的像素字节数
+        std::string error;                          // 超出单张预算时的错误信息
+    };
+    
+    // 一个元素在图集中的绘制参数
+    struct SpriteDraw {
+        const SpriteAtlas* atlas = nullptr;
+        SkRect texture = SkRect::MakeEmpty();   // 在图集中的位置
+        SkRSXform xform;                        // 精灵像素到画布的等比变换
+        ImageSampling sampling = ImageSampling::Nearest;
+    };
+    
+    // 本次渲染预取的图像，键为图片路径
+    std::unordered_map<std::string, PrefetchedImage> prefetched;
+    std::shared_ptr<ImageSource> imageSource;
+    std::vector<std::shared_ptr<const SpriteAtlas>> spriteAtlases;
+    ImageSampling defaultSampling;
+    size_t maxImageDecodeBytes;
+    size_t maxRenderDecodeBytes;
+    std::string errorMessage;
+    
+    // 只读文件头，确定解码区域、降采样倍数和像素字节数；文件无法读取时返回false
+    bool probeImage(const SkISize& canvasSize, DecodePlan* plan) const;
+    
+    // 按计划解码，需要mipmap时同时生成金字塔，结果进入ImageCache
+    bool decodePlan(DecodePlan* plan, PrefetchedImage* result) const;
+
+    
+    // 元素能否从图集合批绘制：素材在图集中、没有注册同名的内存数据、变换只含平移旋转和等比缩放、不使用mipmap
+    bool findSprite(const ImageElement& imageElement, SpriteDraw* sprite) const;
+    
     // 应用变换
     void applyTransform(SkCanvas* canvas, const Transform& transform);
     
-    // 绘制图片
-    void drawImage(SkCanvas* canvas, sk_sp<SkImage> image, const ImageElement& imageElement);
+    // 绘制图片，region为image在原图（尺寸dimensions）中的位置
+    void drawImage(SkCanvas* canvas, sk_sp<SkImage> image, const SkIRect& region, const SkISize& dimensions,
+                   const SkSamplingOptions& sampling, const ImageElement& imageElement);
 };
 
 } // namespace skia_renderer 
\ No newline at end of file
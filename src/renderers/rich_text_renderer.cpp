@@ -10,7 +10,6 @@
 #include "modules/skparagraph/include/ParagraphStyle.h"
 #include "modules/skparagraph/include/TextStyle.h"
 #include "include/core/SkFontMgr.h"
-#include "include/ports/SkFontMgr_mac_ct.h"
 #include "include/core/SkMaskFilter.h"
 
 namespace skia_renderer {
@@ -62,6 +61,11 @@ bool MeasureTextRichTextRenderer::renderRichText(SkCanvas* canvas,
         return false;
     }
     
+    float opacity = std::clamp(textElement.transform.opacity, 0.0f, 1.0f);
+    if (opacity <= 0.0f) {
+        return true;
+    }
+    
     // 保存画布状态
     canvas->save();
     
@@ -77,21 +81,22 @@ bool MeasureTextRichTextRenderer::renderRichText(SkCanvas* canvas,
     std::cout << "调试: MeasureText富文本渲染 - 片段数量: " << textElement.richTextSegments.size() << std::endl;
     #endif
     
-    // 逐个渲染每个富文本片段
+    // 先完成布局：计算每个片段的样式、位置和绘制范围
+    std::vector<SegmentLayout> layouts;
+    layouts.reserve(textElement.richTextSegments.size());
     for (const auto& segment : textElement.richTextSegments) {
-        // 合并样式
-        TextStyle mergedStyle = mergeStyles(textElement.style, segment);
+        SegmentLayout layout;
+        layout.style = mergeStyles(textElement.style, segment);
+        layout.x = currentX;
         
-        // 渲染片段
-        renderSegment(canvas, segment, mergedStyle, currentX, baseY, fontManager);
-        
-        // 计算下一个片段的X位置
         /**
          segmentWidth：文本紧贴的边界框宽度
          letterSpacing：片段之间的字间距, 如果为0则为字体本身的字间距, 如果设置为正值, 则为本身的字间距加上增量的字间距
          */
-        float segmentWidth = calculateSegmentWidth(segment, mergedStyle, fontManager);
+        float segmentWidth = calculateSegmentWidth(segment, layout.style, fontManager, &layout.bounds);
+        layout.bounds.offset(currentX, baseY);
         currentX += segmentWidth + textElement.letterSpacing;
+        layouts.push_back(layout);
         
         #ifndef NDEBUG
         std::cout << "调试: 片段\"" << segment.content << "\" - 宽度: " << segmentWidth 
@@ -99,17 +104,66 @@ bool MeasureTextRichTextRenderer::renderRichText(SkCanvas* canvas,
         #endif
     }
     
+    // 半透明文本：片段互不重叠且没有描边和阴影时，每个像素只被绘制一次，
+    // 透明度可以直接乘进画笔；否则用只覆盖文本范围的图层合成，避免整张画布大小的图层
+    float paintAlpha = 1.0f;
+    bool useLayer = false;
+    if (opacity < 1.0f) {
+        if (canFoldOpacity(layouts)) {
+            paintAlpha = opacity;
+        } else {
+            SkRect layerBounds = SkRect::MakeEmpty();
+            for (const auto& layout : layouts) {
+                layerBounds.join(layout.bounds);
+            }
+            // 抗锯齿边缘
+            layerBounds.outset(1.0f, 1.0f);
+            
+            SkPaint opacityPaint;
+            opacityPaint.setAlphaf(opacity);
+            canvas->saveLayer(&layerBounds, &opacityPaint);
+            useLayer = true;
+        }
+    }
+    
+    // 逐个渲染每个富文本片段
+    for (size_t i = 0; i < layouts.size(); ++i) {
+        renderSegment(canvas, textElement.richTextSegments[i], layouts[i].style,
+                      layouts[i].x, baseY, fontManager, paintAlpha);
+    }
+    
+    if (useLayer) {
+        canvas->restore(); // 合成图层
+    }
+    
     // 恢复画布状态
     canvas->restore();
     
     return true;
 }
 
+bool MeasureTextRichTextRenderer::canFoldOpacity(const std::vector<SegmentLayout>& layouts) const {
+    for (size_t i = 0; i < layouts.size(); ++i) {
+        const TextStyle& style = layouts[i].style;
+        if (style.hasShadow || style.strokeWidth > 0.0f) {
+            return false;
+        }
+        // 片段按x递增排列，只有负字间距或字形外伸时才可能与前面的片段重叠
+        for (size_t j = 0; j < i; ++j) {
+            if (SkRect::Intersects(layouts[i].bounds, layouts[j].bounds)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 void MeasureTextRichTextRenderer::renderSegment(SkCanvas* canvas,
                                                const RichTextSegment& segment,
                                                const TextStyle& mergedStyle,
                                                float x, float y,
-                                               FontManager* fontManager) {
+                                               FontManager* fontManager,
+                                               float alpha) {
     // 加载字体
     auto typeface = fontManager->loadFont(mergedStyle.fontFamily);
     if (!typeface) {
@@ -126,6 +180,7 @@ void MeasureTextRichTextRenderer::renderSegment(SkCanvas* canvas,
         SkPaint shadowPaint;
         shadowPaint.setColor(mergedStyle.shadowColor);
         shadowPaint.setStyle(SkPaint::kFill_Style);
+        shadowPaint.setAlphaf(shadowPaint.getAlphaf() * alpha);
         
         // TODO: 添加阴影模糊效果支持
         // 目前简化实现，不支持模糊
@@ -143,6 +198,7 @@ void MeasureTextRichTextRenderer::renderSegment(SkCanvas* canvas,
         strokePaint.setColor(mergedStyle.strokeColor);
         strokePaint.setStyle(SkPaint::kStroke_Style);
         strokePaint.setStrokeWidth(mergedStyle.strokeWidth);
+        strokePaint.setAlphaf(strokePaint.getAlphaf() * alpha);
         
         canvas->drawString(segment.content.c_str(), x, y, font, strokePaint);
     }
@@ -151,13 +207,15 @@ void MeasureTextRichTextRenderer::renderSegment(SkCanvas* canvas,
     SkPaint fillPaint;
     fillPaint.setColor(mergedStyle.fillColor);
     fillPaint.setStyle(SkPaint::kFill_Style);
+    fillPaint.setAlphaf(fillPaint.getAlphaf() * alpha);
     
     canvas->drawString(segment.content.c_str(), x, y, font, fillPaint);
 }
 
 float MeasureTextRichTextRenderer::calculateSegmentWidth(const RichTextSegment& segment,
                                                         const TextStyle& mergedStyle,
-                                                        FontManager* fontManager) {
+                                                        FontManager* fontManager,
+                                                        SkRect* drawBounds) {
     // 加载字体
     auto typeface = fontManager->loadFont(mergedStyle.fontFamily);
     if (!typeface) {
@@ -167,7 +225,22 @@ float MeasureTextRichTextRenderer::calculateSegmentWidth(const RichTextSegment&
     SkFont font(typeface, mergedStyle.fontSize);
     
     // 使用measureText精确测量
-    return font.measureText(segment.content.c_str(), segment.content.size(), SkTextEncoding::kUTF8);
+    SkRect bounds = SkRect::MakeEmpty();
+    float width = font.measureText(segment.content.c_str(), segment.content.size(), SkTextEncoding::kUTF8, &bounds);
+    
+    if (drawBounds) {
+        // 字形边界（相对基线原点）加上描边和阴影的外扩
+        if (mergedStyle.strokeWidth > 0.0f) {
+            bounds.outset(mergedStyle.strokeWidth * 0.5f, mergedStyle.strokeWidth * 0.5f);
+        }
+        if (mergedStyle.hasShadow) {
+            SkRect shadowBounds = bounds.makeOffset(mergedStyle.shadowDx, mergedStyle.shadowDy);
+            shadowBounds.outset(mergedStyle.shadowSigma * 3.0f, mergedStyle.shadowSigma * 3.0f);
+            bounds.join(shadowBounds);
+        }
+        *drawBounds = bounds;
+    }
+    return width;
 }
 
 float MeasureTextRichTextRenderer::calculateTotalWidth(const TextElement& textElement,
@@ -200,7 +273,7 @@ bool ParagraphRichTextRenderer::renderRichText(SkCanvas* canvas,
     try {
         // 创建字体集合
         auto fontCollection = sk_make_sp<skia::textlayout::FontCollection>();
-        fontCollection->setDefaultFontManager(SkFontMgr_New_CoreText(nullptr));
+        fontCollection->setDefaultFontManager(FontManager::platformFontMgr());
         
         // 创建段落样式
         skia::textlayout::ParagraphStyle paragraphStyle;
@@ -254,17 +327,37 @@ bool ParagraphRichTextRenderer::renderRichText(SkCanvas* canvas,
         float layoutWidth = textElement.width > 0 ? textElement.width : 1000.0f;
         paragraph->layout(layoutWidth);
         
+        float opacity = std::clamp(textElement.transform.opacity, 0.0f, 1.0f);
+        if (opacity <= 0.0f) {
+            return true;
+        }
+        
         // 保存画布状态并应用变换
-        canvas->save();
+        int saveCount = canvas->save();
         canvas->translate(textElement.transform.x, textElement.transform.y);
         canvas->scale(textElement.transform.scaleX, textElement.transform.scaleY);
         canvas->rotate(textElement.transform.rotation);
         
+        // 半透明时用只覆盖段落范围的图层合成，字形可能超出行框，按最大字号外扩
+        if (opacity < 1.0f) {
+            float margin = textElement.style.fontSize;
+            for (const auto& segment : textElement.richTextSegments) {
+                margin = std::max(margin, segment.fontSize);
+            }
+            SkRect layerBounds = SkRect::MakeWH(std::max(layoutWidth, paragraph->getMaxIntrinsicWidth()),
+                                                paragraph->getHeight());
+            layerBounds.outset(margin, margin);
+            
+            SkPaint opacityPaint;
+            opacityPaint.setAlphaf(opacity);
+            canvas->saveLayer(&layerBounds, &opacityPaint);
+        }
+        
         // 渲染段落
         paragraph->paint(canvas, 0, 0);
         
-        // 恢复画布状态
-        canvas->restore();
+        // 恢复画布状态（同时合成图层）
+        canvas->restoreToCount(saveCount);
         
         return true;
         
@@ -279,7 +372,7 @@ float ParagraphRichTextRenderer::calculateTotalWidth(const TextElement& textElem
     try {
         // 创建字体集合
         auto fontCollection = sk_make_sp<skia::textlayout::FontCollection>();
-        fontCollection->setDefaultFontManager(SkFontMgr_New_CoreText(nullptr));
+        fontCollection->setDefaultFontManager(FontManager::platformFontMgr());
         
         // 创建段落样式
         skia::textlayout::ParagraphStyle paragraphStyle;
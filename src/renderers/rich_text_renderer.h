@@ -4,7 +4,9 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
 #include <memory>
+#include <vector>
 
 namespace skia_renderer {
 
@@ -65,6 +67,7 @@ protected:
  * - 精确控制：使用SkFont::measureText精确测量每个片段宽度
  * - 高性能：直接使用Skia基础API，开销小
  * - 灵活性高：可以精确控制每个片段的位置和样式
+ * - 半透明：透明度由渲染器自行处理，能折叠进画笔时不创建图层，否则图层只覆盖文本范围
  */
 class MeasureTextRichTextRenderer : public IRichTextRenderer {
 public:
@@ -79,20 +82,36 @@ public:
 
 private:
     /**
-     * 渲染单个富文本片段
+     * 片段布局结果
+     */
+    struct SegmentLayout {
+        TextStyle style;                        // 合并后的样式
+        float x = 0.0f;                         // 片段起点X
+        SkRect bounds = SkRect::MakeEmpty();    // 绘制范围（含描边和阴影）
+    };
+    
+    /**
+     * 渲染单个富文本片段，alpha为折叠进画笔的透明度
      */
     void renderSegment(SkCanvas* canvas,
                       const RichTextSegment& segment,
                       const TextStyle& mergedStyle,
                       float x, float y,
-                      FontManager* fontManager);
+                      FontManager* fontManager,
+                      float alpha = 1.0f);
     
     /**
-     * 计算单个片段的宽度
+     * 计算单个片段的宽度，drawBounds非空时返回相对基线原点的绘制范围
      */
     float calculateSegmentWidth(const RichTextSegment& segment,
                                const TextStyle& mergedStyle,
-                               FontManager* fontManager);
+                               FontManager* fontManager,
+                               SkRect* drawBounds = nullptr);
+    
+    /**
+     * 透明度能否直接乘进画笔：片段互不重叠且没有描边和阴影
+     */
+    bool canFoldOpacity(const std::vector<SegmentLayout>& layouts) const;
 };
 
 /**
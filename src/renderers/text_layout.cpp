@@ -1,4 +1,5 @@
 #include "renderers/text_layout.h"
+#include "resources/font_manager.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -11,7 +12,6 @@
 #include "modules/skparagraph/include/ParagraphStyle.h"
 #include "modules/skparagraph/include/TextStyle.h"
 #include "include/core/SkFontMgr.h"
-#include "include/ports/SkFontMgr_mac_ct.h"
 
 namespace skia_renderer {
 
@@ -177,7 +177,7 @@ void ParagraphTextLayoutEngine::renderParagraph(SkCanvas* canvas, const TextElem
         auto fontCollection = sk_make_sp<skia::textlayout::FontCollection>();
         
         // 使用系统默认字体管理器
-        auto fontMgr = SkFontMgr_New_CoreText(nullptr);
+        auto fontMgr = FontManager::platformFontMgr();
         if (fontMgr) {
             fontCollection->setDefaultFontManager(fontMgr);
         }
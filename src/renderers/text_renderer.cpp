@@ -40,24 +40,8 @@ bool TextRenderer::renderText(SkCanvas *canvas, const TextElement &textElement,
         std::cout << "调试: 使用富文本渲染策略: " << richTextRenderer->getStrategyName() << std::endl;
         #endif
         
-        // 应用透明度
-        if (textElement.transform.opacity < 1.0f) {
-            canvas->save();
-            SkPaint opacityPaint;
-            opacityPaint.setAlphaf(textElement.transform.opacity);
-            canvas->saveLayer(nullptr, &opacityPaint);
-        }
-        
-        // 渲染富文本
-        bool success = richTextRenderer->renderRichText(canvas, textElement, fontManager.get());
-        
-        // 恢复透明度状态
-        if (textElement.transform.opacity < 1.0f) {
-            canvas->restore(); // 恢复saveLayer
-            canvas->restore(); // 恢复save
-        }
-        
-        return success;
+        // 渲染富文本，透明度由富文本渲染器按文本范围处理（必要时才创建有界图层）
+        return richTextRenderer->renderRichText(canvas, textElement, fontManager.get());
     }
 
     // 【原有逻辑】普通文本渲染
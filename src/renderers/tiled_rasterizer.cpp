@@ -0,0 +1,47 @@
+#include "renderers/tiled_rasterizer.h"
+#include "include/core/SkCanvas.h"
+#include "utils/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+
+namespace skia_renderer {
+
+bool TiledRasterizer::replay(const SkPicture* picture, const SkPixmap& target, int tileCount) {
+    if (!picture || !target.addr() || target.width() <= 0 || target.height() <= 0) {
+        return false;
+    }
+    
+    if (tileCount <= 0) {
+        tileCount = chooseTileCount(target.height());
+    }
+    tileCount = std::clamp(tileCount, 1, target.height());
+    
+    int tileHeight = (target.height() + tileCount - 1) / tileCount;
+    tileCount = (target.height() + tileHeight - 1) / tileHeight;
+    
+    std::atomic<bool> success(true);
+    ThreadPool::parallelFor(tileCount, [&](int index) {
+        int top = index * tileHeight;
+        int height = std::min(tileHeight, target.height() - top);
+        
+        std::unique_ptr<SkCanvas> canvas = SkCanvas::MakeRasterDirect(
+            target.info().makeWH(target.width(), height),
+            target.writable_addr(0, top),
+            target.rowBytes());
+        if (!canvas) {
+            success = false;
+            return;
+        }
+        
+        canvas->translate(0, -static_cast<float>(top));
+        canvas->drawPicture(picture);
+    });
+    return success;
+}
+
+int TiledRasterizer::chooseTileCount(int height) {
+    int maxTiles = std::max(1, height / kMinTileHeight);
+    return std::clamp(ThreadPool::threadCount(), 1, maxTiles);
+}
+
+} // namespace skia_renderer
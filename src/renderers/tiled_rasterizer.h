@@ -0,0 +1,24 @@
+#pragma once
+
+#include "include/core/SkPicture.h"
+#include "include/core/SkPixmap.h"
+
+namespace skia_renderer {
+
+// 分块并行光栅化 - 把录制好的SkPicture按水平条带并发回放到同一块像素上
+//
+// 每个条带用独立的SkCanvas直接包装目标像素的对应行，平移到条带原点后回放整个Picture，
+// 画布裁剪天然限制在条带内；Picture带R-tree时回放会跳过与条带不相交的绘制命令。
+// 条带只在垂直方向整数平移，抗锯齿、文字和渐变的计算与串行绘制一致，输出逐像素相同。
+class TiledRasterizer {
+public:
+    // 回放到目标像素，tileCount为0时按线程数和图像高度自动选择
+    static bool replay(const SkPicture* picture, const SkPixmap& target, int tileCount = 0);
+    
+    // 根据图像高度选择条带数：每个条带至少kMinTileHeight行，最多为线程数
+    static int chooseTileCount(int height);
+    
+    static constexpr int kMinTileHeight = 128;
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,394 @@
+#include "resources/asset_bundle.h"
+#include "resources/image_decoder.h"
+#include "include/core/SkStream.h"
+#include "utils/content_hash.h"
+#include "utils/temp_file.h"
+#include "src/core/SkChecksum.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace skia_renderer {
+
+namespace {
+
+const char kBundleMagic[8] = {'S', 'K', 'R', 'B', 'N', 'D', 'L', '1'};
+constexpr uint32_t kBundleVersion = 1;
+
+// 数据段中每个资源的起始位置对齐到16字节
+constexpr uint64_t kDataAlignment = 16;
+
+// 条目标志
+constexpr uint32_t kFlagOpaque = 1u << 0;
+
+// 文件头，所有偏移都相对文件开头
+struct BundleHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t slotCount;         // 2的幂，不小于条目数的2倍
+    uint32_t reserved;
+    uint64_t slotsOffset;
+    uint64_t entriesOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t dataOffset;
+    uint64_t fileSize;
+};
+static_assert(sizeof(BundleHeader) == 72, "资源包文件头布局不能改变");
+
+// 条目表中的一项
+struct BundleEntry {
+    uint64_t pathHash;
+    uint32_t pathOffset;        // 相对字符串段
+    uint32_t pathLength;
+    uint64_t dataOffset;        // 相对文件开头
+    uint64_t dataSize;
+    uint64_t contentHash[2];
+    int32_t width;
+    int32_t height;
+    uint32_t kind;
+    uint32_t flags;
+};
+static_assert(sizeof(BundleEntry) == 64, "资源包条目布局不能改变");
+
+uint64_t pathHash(const std::string& path) {
+    return SkChecksum::Hash64(path.data(), path.size(), 0);
+}
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+std::string lowerExtension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
+
+AssetBundle::Kind kindForExtension(const std::string& ext) {
+    if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".webp" || ext == ".gif") {
+        return AssetBundle::Kind::Image;
+    }
+    if (ext == ".ttf" || ext == ".otf" || ext == ".ttc") {
+        return AssetBundle::Kind::Font;
+    }
+    return AssetBundle::Kind::Other;
+}
+
+bool writePadding(SkWStream* stream, uint64_t bytes) {
+    static const char kZeros[kDataAlignment] = {};
+    while (bytes > 0) {
+        uint64_t chunk = std::min<uint64_t>(bytes, sizeof(kZeros));
+        if (!stream->write(kZeros, chunk)) {
+            return false;
+        }
+        bytes -= chunk;
+    }
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<AssetBundle> AssetBundle::open(const std::string& path, std::string* errorMessage) {
+    auto fail = [&](const std::string& message) {
+        if (errorMessage) {
+            *errorMessage = message + ": " + path;
+        }
+        return nullptr;
+    };
+
+    // MakeFromFileName使用mmap，资源数据按需由系统换入，不会整体读进内存
+    sk_sp<SkData> mapping = SkData::MakeFromFileName(path.c_str());
+    if (!mapping) {
+        return fail("无法打开资源包");
+    }
+
+    BundleHeader header;
+    if (mapping->size() < sizeof(header)) {
+        return fail("资源包文件过小");
+    }
+    std::memcpy(&header, mapping->data(), sizeof(header));
+    if (std::memcmp(header.magic, kBundleMagic, sizeof(kBundleMagic)) != 0) {
+        return fail("不是资源包文件");
+    }
+    if (header.version != kBundleVersion) {
+        return fail("不支持的资源包版本" + std::to_string(header.version));
+    }
+
+    // 各段必须完整落在文件内，之后的查找不再做越界检查
+    uint64_t size = mapping->size();
+    bool slotsValid = header.slotCount > 0 && (header.slotCount & (header.slotCount - 1)) == 0 &&
+                      header.slotCount >= header.entryCount &&
+                      header.slotsOffset + uint64_t(header.slotCount) * sizeof(uint32_t) <= size;
+    bool entriesValid = header.entriesOffset + uint64_t(header.entryCount) * sizeof(BundleEntry) <= size;
+    bool stringsValid = header.stringsOffset + header.stringsSize <= size;
+    if (header.fileSize != size || !slotsValid || !entriesValid || !stringsValid ||
+        header.slotsOffset % sizeof(uint32_t) != 0) {
+        return fail("资源包已损坏");
+    }
+
+    std::shared_ptr<AssetBundle> bundle(new AssetBundle());
+    bundle->path = path;
+    bundle->entryCount = header.entryCount;
+    bundle->slotCount = header.slotCount;
+    const uint8_t* base = mapping->bytes();
+    bundle->slots = reinterpret_cast<const uint32_t*>(base + header.slotsOffset);
+    bundle->entryTable = base + header.entriesOffset;
+    bundle->strings = reinterpret_cast<const char*>(base + header.stringsOffset);
+    bundle->stringsSize = header.stringsSize;
+
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        BundleEntry entry;
+        std::memcpy(&entry, bundle->entryTable + uint64_t(i) * sizeof(BundleEntry), sizeof(entry));
+        if (uint64_t(entry.pathOffset) + entry.pathLength > header.stringsSize ||
+            entry.dataOffset + entry.dataSize > size) {
+            return fail("资源包已损坏");
+        }
+    }
+    bundle->mapping = std::move(mapping);
+    return bundle;
+}
+
+std::string AssetBundle::normalizePath(const std::string& path) {
+    std::string normalized = fs::path(path).lexically_normal().generic_string();
+    while (normalized.compare(0, 2, "./") == 0) {
+        normalized.erase(0, 2);
+    }
+    return normalized;
+}
+
+int64_t AssetBundle::findIndex(const std::string& normalizedPath) const {
+    uint64_t hash = pathHash(normalizedPath);
+    uint32_t mask = slotCount - 1;
+    // 线性探测，槽数不小于条目数的2倍，遇到空槽即可结束
+    for (uint32_t probe = 0; probe < slotCount; ++probe) {
+        uint32_t slot = slots[(hash + probe) & mask];
+        if (slot == 0 || slot > entryCount) {
+            return -1;
+        }
+        BundleEntry entry;
+        std::memcpy(&entry, entryTable + uint64_t(slot - 1) * sizeof(BundleEntry), sizeof(entry));
+        if (entry.pathHash == hash && entry.pathLength == normalizedPath.size() &&
+            std::memcmp(strings + entry.pathOffset, normalizedPath.data(), entry.pathLength) == 0) {
+            return slot - 1;
+        }
+    }
+    return -1;
+}
+
+AssetBundle::Entry AssetBundle::readEntry(uint32_t index, uint64_t* dataOffset) const {
+    BundleEntry raw;
+    std::memcpy(&raw, entryTable + uint64_t(index) * sizeof(BundleEntry), sizeof(raw));
+
+    Entry entry;
+    entry.path.assign(strings + raw.pathOffset, raw.pathLength);
+    entry.kind = static_cast<Kind>(raw.kind);
+    entry.width = raw.width;
+    entry.height = raw.height;
+    entry.opaque = (raw.flags & kFlagOpaque) != 0;
+    entry.contentHash = ContentHash::toHex(raw.contentHash);
+    entry.size = raw.dataSize;
+    if (dataOffset) {
+        *dataOffset = raw.dataOffset;
+    }
+    return entry;
+}
+
+bool AssetBundle::find(const std::string& path, Entry* entry) const {
+    int64_t index = findIndex(normalizePath(path));
+    if (index < 0) {
+        return false;
+    }
+    if (entry) {
+        *entry = readEntry(static_cast<uint32_t>(index), nullptr);
+    }
+    return true;
+}
+
+sk_sp<SkData> AssetBundle::getData(const std::string& path) const {
+    int64_t index = findIndex(normalizePath(path));
+    if (index < 0) {
+        return nullptr;
+    }
+    uint64_t dataOffset = 0;
+    Entry entry = readEntry(static_cast<uint32_t>(index), &dataOffset);
+    // 子区间共享映射，不复制数据
+    return SkData::MakeSubset(mapping.get(), dataOffset, entry.size);
+}
+
+std::vector<AssetBundle::Entry> AssetBundle::entries() const {
+    std::vector<Entry> result;
+    result.reserve(entryCount);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        result.push_back(readEntry(i, nullptr));
+    }
+    return result;
+}
+
+bool AssetBundleWriter::addFile(const std::string& bundlePath, const std::string& filePath) {
+    PendingEntry entry;
+    entry.path = AssetBundle::normalizePath(bundlePath);
+    entry.data = SkData::MakeFromFileName(filePath.c_str());
+    if (!entry.data) {
+        errorMessage = "无法读取文件: " + filePath;
+        return false;
+    }
+    entry.kind = kindForExtension(lowerExtension(filePath));
+
+    // 图片预先计算尺寸和是否不透明，渲染时直接使用
+    if (entry.kind == AssetBundle::Kind::Image) {
+        SkISize dimensions;
+        if (!ImageDecoder::readDimensions(entry.data, &dimensions)) {
+            errorMessage = "无法解析图片: " + filePath;
+            return false;
+        }
+        entry.width = dimensions.width();
+        entry.height = dimensions.height();
+
+        SkIRect decodedRegion;
+        sk_sp<SkImage> image = ImageDecoder::decode(entry.data, SkIRect::MakeEmpty(), &decodedRegion);
+        entry.opaque = image && image->isOpaque();
+    }
+
+    // 同一路径重复添加时保留最后一次
+    auto it = std::find_if(pending.begin(), pending.end(),
+                           [&](const PendingEntry& existing) { return existing.path == entry.path; });
+    if (it != pending.end()) {
+        *it = std::move(entry);
+    } else {
+        pending.push_back(std::move(entry));
+    }
+    return true;
+}
+
+bool AssetBundleWriter::addDirectory(const std::string& directory) {
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        errorMessage = "目录不存在: " + directory;
+        return false;
+    }
+
+    std::vector<fs::path> files;
+    fs::recursive_directory_iterator it(directory, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_directory()) {
+            // 渲染输出和设计源文件不会被协议引用
+            std::string name = it->path().filename().string();
+            if (name == "output" || name == "original") {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+        if (it->is_regular_file() && kindForExtension(lowerExtension(it->path())) != AssetBundle::Kind::Other) {
+            files.push_back(it->path());
+        }
+    }
+    if (ec) {
+        errorMessage = "无法遍历目录: " + directory;
+        return false;
+    }
+
+    // 按路径排序，同样的输入得到字节相同的资源包
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        if (!addFile(file.generic_string(), file.string())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AssetBundleWriter::write(const std::string& outputPath) {
+    uint32_t entryCount = static_cast<uint32_t>(pending.size());
+    uint32_t slotCount = 1;
+    while (slotCount < entryCount * 2) {
+        slotCount <<= 1;
+    }
+
+    // 依次计算各段位置
+    BundleHeader header = {};
+    std::memcpy(header.magic, kBundleMagic, sizeof(kBundleMagic));
+    header.version = kBundleVersion;
+    header.entryCount = entryCount;
+    header.slotCount = slotCount;
+    header.slotsOffset = sizeof(BundleHeader);
+    header.entriesOffset = alignUp(header.slotsOffset + uint64_t(slotCount) * sizeof(uint32_t), 8);
+    header.stringsOffset = header.entriesOffset + uint64_t(entryCount) * sizeof(BundleEntry);
+
+    std::string strings;
+    std::vector<BundleEntry> entries(entryCount);
+    std::vector<uint32_t> slots(slotCount, 0);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        const PendingEntry& pendingEntry = pending[i];
+        BundleEntry& entry = entries[i];
+        entry.pathHash = pathHash(pendingEntry.path);
+        entry.pathOffset = static_cast<uint32_t>(strings.size());
+        entry.pathLength = static_cast<uint32_t>(pendingEntry.path.size());
+        entry.dataSize = pendingEntry.data->size();
+        // 与结果缓存的文件内容哈希一致，同一文件在资源包内外得到相同的哈希
+        ContentHash::compute(pendingEntry.data->data(), pendingEntry.data->size(), entry.contentHash);
+        entry.width = pendingEntry.width;
+        entry.height = pendingEntry.height;
+        entry.kind = static_cast<uint32_t>(pendingEntry.kind);
+        entry.flags = pendingEntry.opaque ? kFlagOpaque : 0;
+        strings += pendingEntry.path;
+
+        uint32_t mask = slotCount - 1;
+        uint64_t slot = entry.pathHash & mask;
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = i + 1;
+    }
+    header.stringsSize = strings.size();
+    header.dataOffset = alignUp(header.stringsOffset + header.stringsSize, kDataAlignment);
+
+    uint64_t offset = header.dataOffset;
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        entries[i].dataOffset = offset;
+        offset = alignUp(offset + entries[i].dataSize, kDataAlignment);
+    }
+    header.fileSize = offset;
+
+    // 先写临时文件再重命名，正在映射旧资源包的进程不受影响；临时文件名按进程和线程区分，并发打包互不覆盖
+    std::string tempPath = TempFile::pathFor(outputPath);
+    {
+        SkFILEWStream stream(tempPath.c_str());
+        if (!stream.isValid()) {
+            errorMessage = "无法写入资源包: " + outputPath;
+            return false;
+        }
+        bool ok = stream.write(&header, sizeof(header)) &&
+                  stream.write(slots.data(), slots.size() * sizeof(uint32_t)) &&
+                  writePadding(&stream, header.entriesOffset - header.slotsOffset - slots.size() * sizeof(uint32_t)) &&
+                  stream.write(entries.data(), entries.size() * sizeof(BundleEntry)) &&
+                  stream.write(strings.data(), strings.size()) &&
+                  writePadding(&stream, header.dataOffset - header.stringsOffset - header.stringsSize);
+        for (uint32_t i = 0; ok && i < entryCount; ++i) {
+            uint64_t end = i + 1 < entryCount ? entries[i + 1].dataOffset : header.fileSize;
+            ok = stream.write(pending[i].data->data(), pending[i].data->size()) &&
+                 writePadding(&stream, end - entries[i].dataOffset - entries[i].dataSize);
+        }
+        stream.flush();
+        if (!ok) {
+            errorMessage = "写入资源包失败: " + outputPath;
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, outputPath, ec);
+    if (ec) {
+        errorMessage = "无法写入资源包: " + outputPath;
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "include/core/SkData.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace skia_renderer {
+
+// 资源包 - 把一个项目的图片和字体打包成一个文件，以mmap方式整体映射
+//
+// 文件布局（小端）：
+//   Header   魔数、版本、条目数、哈希槽数及各段偏移
+//   Slots    开放寻址哈希表，每个槽存条目序号+1（0为空），按路径哈希线性探测
+//   Entries  每个条目64字节：路径哈希、路径位置、数据位置、128位内容哈希、宽高、类型、标志
+//   Strings  所有路径（协议中引用的相对路径，如projects/food/resources/food_bg_1.png）
+//   Data     各资源的原始编码数据，按16字节对齐
+//
+// 查找只访问映射内存，不涉及open/stat/read；取出的数据是映射的子区间（SkData::MakeSubset），零拷贝交给Skia。
+// 图片的尺寸和是否不透明在打包时预先计算，渲染时不必再读文件头。
+class AssetBundle {
+public:
+    enum class Kind : uint32_t {
+        Other = 0,
+        Image = 1,
+        Font = 2,
+    };
+
+    // 条目元数据
+    struct Entry {
+        std::string path;
+        Kind kind = Kind::Other;
+        int width = 0;              // 图片原图尺寸（已应用EXIF方向），非图片为0
+        int height = 0;
+        bool opaque = false;        // 图片像素是否全部不透明
+        std::string contentHash;    // 内容哈希的十六进制表示
+        uint64_t size = 0;          // 编码数据字节数
+    };
+
+    // 映射资源包文件，格式错误时返回nullptr并设置errorMessage
+    static std::shared_ptr<AssetBundle> open(const std::string& path, std::string* errorMessage);
+
+    // 按路径查找（路径会规范化，"./a/b.png"与"a/b.png"等价）
+    bool find(const std::string& path, Entry* entry = nullptr) const;
+
+    // 获取资源的编码数据，不存在时返回nullptr
+    sk_sp<SkData> getData(const std::string& path) const;
+
+    // 所有条目，按打包顺序
+    std::vector<Entry> entries() const;
+
+    // 资源包文件路径
+    const std::string& getPath() const { return path; }
+
+    // 规范化资源路径
+    static std::string normalizePath(const std::string& path);
+
+private:
+    std::string path;
+    sk_sp<SkData> mapping;
+    uint32_t entryCount = 0;
+    uint32_t slotCount = 0;
+    const uint32_t* slots = nullptr;
+    const uint8_t* entryTable = nullptr;
+    const char* strings = nullptr;
+    uint64_t stringsSize = 0;
+
+    AssetBundle() = default;
+
+    // 查找条目序号，不存在返回-1
+    int64_t findIndex(const std::string& normalizedPath) const;
+    Entry readEntry(uint32_t index, uint64_t* dataOffset) const;
+};
+
+// 资源包写入器 - 收集文件后一次性写出资源包
+class AssetBundleWriter {
+public:
+    // 添加单个文件，bundlePath为渲染时引用它的路径
+    bool addFile(const std::string& bundlePath, const std::string& filePath);
+
+    // 递归添加目录下的图片和字体（跳过output/和original/），路径为directory/相对路径
+    bool addDirectory(const std::string& directory);
+
+    // 写出资源包（先写临时文件再重命名）
+    bool write(const std::string& outputPath);
+
+    size_t getEntryCount() const { return pending.size(); }
+
+    // 获取错误信息
+    const std::string& getErrorMessage() const { return errorMessage; }
+
+private:
+    struct PendingEntry {
+        std::string path;
+        sk_sp<SkData> data;
+        AssetBundle::Kind kind = AssetBundle::Kind::Other;
+        int width = 0;
+        int height = 0;
+        bool opaque = false;
+    };
+
+    std::vector<PendingEntry> pending;
+    std::string errorMessage;
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,524 @@
+#include "resources/font_index.h"
+#include "utils/temp_file.h"
+#include "3rdparty/json/include/nlohmann/json.hpp"
+#include "include/core/SkData.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace skia_renderer {
+
+namespace {
+
+constexpr int kIndexVersion = 1;
+
+// name表中用到的名称ID
+constexpr uint16_t kFamilyNameId = 1;
+constexpr uint16_t kFullNameId = 4;
+constexpr uint16_t kPostScriptNameId = 6;
+constexpr uint16_t kTypographicFamilyNameId = 16;
+
+constexpr uint32_t makeTag(char a, char b, char c, char d) {
+    return (static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(b) << 16) |
+           (static_cast<uint32_t>(c) << 8) | static_cast<uint32_t>(d);
+}
+
+uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t readU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+struct Table {
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+};
+
+// 在fontOffset处的表目录中查找表，越界时视为不存在
+bool findTable(const uint8_t* data, size_t size, size_t fontOffset, uint32_t tag, Table* table) {
+    if (fontOffset > size || size - fontOffset < 12) {
+        return false;
+    }
+    size_t numTables = readU16(data + fontOffset + 4);
+    if ((size - fontOffset - 12) / 16 < numTables) {
+        return false;
+    }
+    for (size_t i = 0; i < numTables; ++i) {
+        const uint8_t* record = data + fontOffset + 12 + i * 16;
+        if (readU32(record) != tag) {
+            continue;
+        }
+        size_t offset = readU32(record + 8);
+        size_t length = readU32(record + 12);
+        if (offset > size || length > size - offset) {
+            return false;
+        }
+        table->data = data + offset;
+        table->length = length;
+        return true;
+    }
+    return false;
+}
+
+void appendUtf8(uint32_t codePoint, std::string* out) {
+    if (codePoint < 0x80) {
+        out->push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        out->push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out->push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        out->push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// Unicode和Windows平台的名称为UTF-16BE
+std::string decodeUtf16(const uint8_t* text, size_t length) {
+    std::string out;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        uint32_t unit = readU16(text + i);
+        if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < length) {
+            uint32_t low = readU16(text + i + 2);
+            if (low >= 0xDC00 && low < 0xE000) {
+                unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            }
+        }
+        appendUtf8(unit, &out);
+    }
+    return out;
+}
+
+struct NameRecord {
+    uint16_t nameId = 0;
+    bool english = false;
+    std::string value;
+};
+
+// 读取需要的名称记录；Mac平台只接受ASCII（其他Mac编码如GB2312无法可靠转换）
+std::vector<NameRecord> readNames(const Table& table) {
+    std::vector<NameRecord> names;
+    if (table.length < 6) {
+        return names;
+    }
+    size_t count = readU16(table.data + 2);
+    size_t stringOffset = readU16(table.data + 4);
+    if ((table.length - 6) / 12 < count) {
+        return names;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* record = table.data + 6 + i * 12;
+        uint16_t platform = readU16(record);
+        uint16_t encoding = readU16(record + 2);
+        uint16_t language = readU16(record + 4);
+        NameRecord name;
+        name.nameId = readU16(record + 6);
+        size_t length = readU16(record + 8);
+        size_t start = stringOffset + readU16(record + 10);
+        if (name.nameId != kFamilyNameId && name.nameId != kFullNameId && name.nameId != kPostScriptNameId &&
+            name.nameId != kTypographicFamilyNameId) {
+            continue;
+        }
+        if (start > table.length || length > table.length - start) {
+            continue;
+        }
+        const uint8_t* text = table.data + start;
+        if (platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10))) {
+            name.value = decodeUtf16(text, length);
+            name.english = platform == 0 || language == 0x0409;
+        } else if (platform == 1 && encoding == 0) {
+            if (std::any_of(text, text + length, [](uint8_t c) { return c >= 0x80; })) {
+                continue;
+            }
+            name.value.assign(reinterpret_cast<const char*>(text), length);
+            name.english = language == 0;
+        } else {
+            continue;
+        }
+        if (!name.value.empty()) {
+            names.push_back(std::move(name));
+        }
+    }
+    return names;
+}
+
+// 取某个名称ID的值，优先英文
+std::string pickName(const std::vector<NameRecord>& names, uint16_t nameId) {
+    std::string fallback;
+    for (const auto& name : names) {
+        if (name.nameId != nameId) {
+            continue;
+        }
+        if (name.english) {
+            return name.value;
+        }
+        if (fallback.empty()) {
+            fallback = name.value;
+        }
+    }
+    return fallback;
+}
+
+bool parseFace(const uint8_t* data, size_t size, size_t fontOffset, FontIndex::Face* face) {
+    Table nameTable;
+    if (!findTable(data, size, fontOffset, makeTag('n', 'a', 'm', 'e'), &nameTable)) {
+        return false;
+    }
+    std::vector<NameRecord> names = readNames(nameTable);
+    face->family = pickName(names, kTypographicFamilyNameId);
+    if (face->family.empty()) {
+        face->family = pickName(names, kFamilyNameId);
+    }
+    if (face->family.empty()) {
+        return false;
+    }
+    for (uint16_t nameId : {kTypographicFamilyNameId, kFamilyNameId}) {
+        for (const auto& name : names) {
+            if (name.nameId == nameId && std::find(face->familyNames.begin(), face->familyNames.end(),
+                                                   name.value) == face->familyNames.end()) {
+                face->familyNames.push_back(name.value);
+            }
+        }
+    }
+    face->postScriptName = pickName(names, kPostScriptNameId);
+    face->fullName = pickName(names, kFullNameId);
+
+    // 字重、宽度、斜体来自OS/2表，没有OS/2表时退回head表的macStyle
+    Table os2;
+    Table head;
+    if (findTable(data, size, fontOffset, makeTag('O', 'S', '/', '2'), &os2) && os2.length >= 64) {
+        face->weight = readU16(os2.data + 4);
+        face->width = readU16(os2.data + 6);
+        face->italic = (readU16(os2.data + 62) & 0x0201) != 0;  // ITALIC或OBLIQUE
+    } else if (findTable(data, size, fontOffset, makeTag('h', 'e', 'a', 'd'), &head) && head.length >= 46) {
+        uint16_t macStyle = readU16(head.data + 44);
+        face->weight = (macStyle & 1) ? SkFontStyle::kBold_Weight : SkFontStyle::kNormal_Weight;
+        face->italic = (macStyle & 2) != 0;
+    }
+    // 少数旧字体的usWeightClass写成1-9
+    if (face->weight > 0 && face->weight < 10) {
+        face->weight *= 100;
+    }
+    if (face->weight <= 0) {
+        face->weight = SkFontStyle::kNormal_Weight;
+    }
+    face->width = std::clamp(face->width, static_cast<int>(SkFontStyle::kUltraCondensed_Width),
+                             static_cast<int>(SkFontStyle::kUltraExpanded_Width));
+    return true;
+}
+
+std::string toLower(const std::string& text) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return c < 0x80 ? static_cast<char>(std::tolower(c)) : static_cast<char>(c);
+    });
+    return lower;
+}
+
+bool isFontExtension(const fs::path& path) {
+    std::string ext = toLower(path.extension().string());
+    return ext == ".ttf" || ext == ".otf" || ext == ".ttc" || ext == ".otc";
+}
+
+bool fileStamp(const std::string& path, long long* size, long long* modifiedTime) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    *size = static_cast<long long>(info.st_size);
+    *modifiedTime = static_cast<long long>(info.st_mtime);
+    return true;
+}
+
+// 斜体不匹配的代价最大，其次是宽度，最后是字重
+int styleDistance(const FontIndex::Face& face, const SkFontStyle& style) {
+    bool wantItalic = style.slant() != SkFontStyle::kUpright_Slant;
+    return (face.italic != wantItalic ? 100000 : 0) + std::abs(face.width - style.width()) * 1000 +
+           std::abs(face.weight - style.weight());
+}
+
+} // namespace
+
+SkFontStyle FontIndex::Face::style() const {
+    return SkFontStyle(weight, width, italic ? SkFontStyle::kItalic_Slant : SkFontStyle::kUpright_Slant);
+}
+
+FontIndex::FontIndex(const std::string& indexPath) :
+    indexPath(indexPath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    loadIndexLocked();
+}
+
+bool FontIndex::addDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        errorMessage = "字体目录不存在: " + directory;
+        return false;
+    }
+
+    std::string prefix = fs::path(directory).lexically_normal().generic_string();
+    if (!prefix.empty() && prefix.back() != '/') {
+        prefix += '/';
+    }
+    std::set<std::string> seen;
+    bool changed = false;
+    for (auto it = fs::recursive_directory_iterator(directory, fs::directory_options::skip_permission_denied, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file() || !isFontExtension(it->path())) {
+            continue;
+        }
+        std::string path = it->path().lexically_normal().generic_string();
+        FileRecord record;
+        if (!fileStamp(path, &record.size, &record.modifiedTime)) {
+            continue;
+        }
+        seen.insert(path);
+        activePaths.insert(path);
+
+        // 大小和修改时间都没变的文件沿用索引记录
+        auto existing = files.find(path);
+        if (existing != files.end() && existing->second.size == record.size &&
+            existing->second.modifiedTime == record.modifiedTime) {
+            continue;
+        }
+        // 不是有效字体的文件也记录下来（faces为空），下次不再解析
+        sk_sp<SkData> data = SkData::MakeFromFileName(path.c_str());
+        if (data) {
+            parseFaces(data->data(), data->size(), path, &record.faces);
+        }
+        files[path] = std::move(record);
+        ++parsedCount;
+        changed = true;
+    }
+
+    // 目录下已删除的文件
+    for (auto it = files.begin(); it != files.end();) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0 && seen.count(it->first) == 0) {
+            activePaths.erase(it->first);
+            it = files.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    rebuildLookupLocked();
+    if (changed && !indexPath.empty() && !saveIndexLocked()) {
+        // 索引写不进去只影响下次启动的速度
+        errorMessage = "无法写入字体索引: " + indexPath;
+    }
+    return true;
+}
+
+bool FontIndex::find(const std::string& name, const SkFontStyle& style, Face* face) const {
+    std::string key = toLower(name);
+    std::lock_guard<std::mutex> lock(mutex);
+    // 常规体的全名常与家族名相同，先按家族名匹配，才能按style选择字重
+    auto family = familyLookup.find(key);
+    if (family == familyLookup.end() || family->second.empty()) {
+        auto exact = exactNames.find(key);
+        if (exact == exactNames.end()) {
+            return false;
+        }
+        *face = *exact->second;
+        return true;
+    }
+    const Face* best = family->second.front();
+    for (const Face* candidate : family->second) {
+        if (styleDistance(*candidate, style) < styleDistance(*best, style)) {
+            best = candidate;
+        }
+    }
+    *face = *best;
+    return true;
+}
+
+std::vector<FontIndex::Face> FontIndex::getFaces() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Face> faces;
+    for (const auto& path : activePaths) {
+        auto it = files.find(path);
+        if (it != files.end()) {
+            faces.insert(faces.end(), it->second.faces.begin(), it->second.faces.end());
+        }
+    }
+    return faces;
+}
+
+size_t FontIndex::getParsedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return parsedCount;
+}
+
+std::string FontIndex::getErrorMessage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errorMessage;
+}
+
+bool FontIndex::parseFaces(const void* data, size_t size, const std::string& path, std::vector<Face>* faces) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (!bytes || size < 12) {
+        return false;
+    }
+
+    std::vector<size_t> offsets;
+    uint32_t tag = readU32(bytes);
+    if (tag == makeTag('t', 't', 'c', 'f')) {
+        size_t count = readU32(bytes + 8);
+        if ((size - 12) / 4 < count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            offsets.push_back(readU32(bytes + 12 + i * 4));
+        }
+    } else if (tag == 0x00010000 || tag == makeTag('O', 'T', 'T', 'O') || tag == makeTag('t', 'r', 'u', 'e')) {
+        offsets.push_back(0);
+    } else {
+        return false;
+    }
+
+    size_t before = faces->size();
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        Face face;
+        if (parseFace(bytes, size, offsets[i], &face)) {
+            face.path = path;
+            face.index = static_cast<int>(i);
+            faces->push_back(std::move(face));
+        }
+    }
+    return faces->size() > before;
+}
+
+void FontIndex::loadIndexLocked() {
+    if (indexPath.empty()) {
+        return;
+    }
+    std::ifstream file(indexPath);
+    if (!file.is_open()) {
+        return;
+    }
+    // 格式不对或版本不同时当作没有索引，扫描时重新解析并覆盖
+    json index = json::parse(file, nullptr, false);
+    if (index.is_discarded() || !index.is_object() || index.value("version", 0) != kIndexVersion ||
+        !index.contains("files") || !index["files"].is_array()) {
+        return;
+    }
+    for (const auto& item : index["files"]) {
+        std::string path = item.value("path", "");
+        if (path.empty() || !item.contains("faces") || !item["faces"].is_array()) {
+            continue;
+        }
+        FileRecord record;
+        record.size = item.value("size", -1LL);
+        record.modifiedTime = item.value("mtime", -1LL);
+        for (const auto& entry : item["faces"]) {
+            Face face;
+            face.path = path;
+            face.index = entry.value("index", 0);
+            face.family = entry.value("family", "");
+            face.familyNames = entry.value("families", std::vector<std::string>());
+            face.postScriptName = entry.value("postScript", "");
+            face.fullName = entry.value("fullName", "");
+            face.weight = entry.value("weight", static_cast<int>(SkFontStyle::kNormal_Weight));
+            face.width = entry.value("width", static_cast<int>(SkFontStyle::kNormal_Width));
+            face.italic = entry.value("italic", false);
+            record.faces.push_back(std::move(face));
+        }
+        files[path] = std::move(record);
+    }
+}
+
+bool FontIndex::saveIndexLocked() {
+    json fileList = json::array();
+    for (const auto& item : files) {
+        json faces = json::array();
+        for (const auto& face : item.second.faces) {
+            faces.push_back({
+                {"index", face.index},
+                {"family", face.family},
+                {"families", face.familyNames},
+                {"postScript", face.postScriptName},
+                {"fullName", face.fullName},
+                {"weight", face.weight},
+                {"width", face.width},
+                {"italic", face.italic},
+            });
+        }
+        fileList.push_back({
+            {"path", item.first},
+            {"size", item.second.size},
+            {"mtime", item.second.modifiedTime},
+            {"faces", faces},
+        });
+    }
+    json index = {
+        {"version", kIndexVersion},
+        {"files", fileList},
+    };
+
+    std::error_code ec;
+    fs::path parent = fs::path(indexPath).parent_path();
+    if (!parent.empty()) {
+        fs::create_directories(parent, ec);
+    }
+    // 先写临时文件再改名，其他进程不会读到写了一半的索引
+    std::string tempPath = TempFile::pathFor(indexPath);
+    {
+        std::ofstream file(tempPath);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << index.dump(2) << std::endl;
+        if (!file.good()) {
+            file.close();
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tempPath, indexPath, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+void FontIndex::rebuildLookupLocked() {
+    exactNames.clear();
+    familyLookup.clear();
+    for (const auto& path : activePaths) {
+        auto it = files.find(path);
+        if (it == files.end()) {
+            continue;
+        }
+        for (const auto& face : it->second.faces) {
+            // 同名时先扫描到（路径排序靠前）的优先
+            if (!face.postScriptName.empty()) {
+                exactNames.emplace(toLower(face.postScriptName), &face);
+            }
+            if (!face.fullName.empty()) {
+                exactNames.emplace(toLower(face.fullName), &face);
+            }
+            for (const auto& family : face.familyNames) {
+                familyLookup[toLower(family)].push_back(&face);
+            }
+        }
+    }
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "include/core/SkFontStyle.h"
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace skia_renderer {
+
+// 字体索引 - 扫描字体目录，按name表和OS/2表记录每个字体的家族名、PostScript名、字重、宽度和斜体
+//
+// 只解析sfnt表头、name表和OS/2表，不创建字体对象，与平台字体后端无关。扫描结果保存为JSON索引文件，
+// 每个字体文件记录大小和修改时间；再次扫描时只stat文件，大小和修改时间都未变的直接使用索引中的记录，
+// 进程启动不必重新解析所有字体文件。字体对象由FontManager在首次使用时创建。
+class FontIndex {
+public:
+    struct Face {
+        std::string path;
+        int index = 0;                          // 字体集合（.ttc/.otc）中的序号
+        std::string family;                     // 首选家族名（优先英文的typographic family）
+        std::vector<std::string> familyNames;   // 所有语言的家族名，都可以用来查找
+        std::string postScriptName;
+        std::string fullName;
+        int weight = SkFontStyle::kNormal_Weight;
+        int width = SkFontStyle::kNormal_Width;
+        bool italic = false;
+
+        SkFontStyle style() const;
+    };
+
+    // indexPath为空时不读写索引文件，每次都重新解析
+    explicit FontIndex(const std::string& indexPath = "");
+
+    // 递归扫描目录下的.ttf/.otf/.ttc/.otc，索引文件有变化时写回。目录不存在时返回false
+    bool addDirectory(const std::string& directory);
+
+    // 按名称查找（不区分大小写）：在家族名匹配的字体中取与style最接近的一个，
+    // 没有同名家族时按PostScript名或全名匹配
+    bool find(const std::string& name, const SkFontStyle& style, Face* face) const;
+
+    // 扫描过的目录中的所有字体
+    std::vector<Face> getFaces() const;
+
+    // 本实例实际解析的字体文件数（索引命中的不计）
+    size_t getParsedCount() const;
+
+    // 解析一个字体文件的数据，返回其中的所有字体；不是sfnt格式时返回false
+    static bool parseFaces(const void* data, size_t size, const std::string& path, std::vector<Face>* faces);
+
+    // 获取错误信息
+    std::string getErrorMessage() const;
+
+private:
+    struct FileRecord {
+        long long size = 0;
+        long long modifiedTime = 0;
+        std::vector<Face> faces;
+    };
+
+    std::string indexPath;
+    mutable std::mutex mutex;
+    std::map<std::string, FileRecord> files;                        // 索引文件中的全部记录
+    std::set<std::string> activePaths;                              // 本实例扫描过的目录中的文件
+    std::map<std::string, const Face*> exactNames;                  // 小写的PostScript名和全名
+    std::map<std::string, std::vector<const Face*>> familyLookup;   // 小写的家族名
+    size_t parsedCount = 0;
+    std::string errorMessage;
+
+    void loadIndexLocked();
+    bool saveIndexLocked();
+    void rebuildLookupLocked();
+};
+
+} // namespace skia_renderer
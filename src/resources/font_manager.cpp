@@ -1,29 +1,50 @@
 #include "resources/font_manager.h"
 #include <iostream>
 
+#ifdef __APPLE__
+#include "include/ports/SkFontMgr_mac_ct.h"
+#else
+#include "include/ports/SkFontMgr_directory.h"
+#endif
+
+// 非Apple平台的系统字体目录
+#ifndef SKR_SYSTEM_FONT_DIR
+#define SKR_SYSTEM_FONT_DIR "/usr/share/fonts/"
+#endif
+
 namespace skia_renderer {
 
-FontManager::FontManager() {
-    // 初始化字体管理器
-    fontMgr = SkFontMgr_New_CoreText(nullptr);
-    
-    // 注册常用字体文件
+FontManager::FontManager() :
+    FontManager({"res/Fonts"}, "cache/fonts/index.json") {
+    // 字体name表中没有的别名（该字体的中文家族名为"站酷快乐体2016修订版"）
     registerFontFile("站酷快乐体", "res/Fonts/站酷快乐体2016修订版.ttf");
-    
-    // 注册 Source Han Sans CN 字体家族的所有Weight变体
-    registerFontFile("SourceHanSansCN-ExtraLight", "res/Fonts/SourceHanSansCN-ExtraLight.otf");
-    registerFontFile("SourceHanSansCN-Light", "res/Fonts/SourceHanSansCN-Light.otf");
-    registerFontFile("SourceHanSansCN-Normal", "res/Fonts/SourceHanSansCN-Normal.otf");
-    registerFontFile("SourceHanSansCN-Regular", "res/Fonts/SourceHanSansCN-Regular.otf");
-    registerFontFile("SourceHanSansCN-Medium", "res/Fonts/SourceHanSansCN-Medium.otf");
-    registerFontFile("SourceHanSansCN-Bold", "res/Fonts/SourceHanSansCN-Bold.otf");
-    registerFontFile("SourceHanSansCN-Heavy", "res/Fonts/SourceHanSansCN-Heavy.otf");
+}
+
+FontManager::FontManager(const std::vector<std::string>& fontDirectories, const std::string& indexPath) :
+    fontMgr(platformFontMgr()),
+    fontIndex(indexPath) {
+    for (const auto& directory : fontDirectories) {
+        addFontDirectory(directory);
+    }
 }
 
 FontManager::~FontManager() {
 }
 
+sk_sp<SkFontMgr> FontManager::platformFontMgr() {
+#ifdef __APPLE__
+    static sk_sp<SkFontMgr>* fontMgr = new sk_sp<SkFontMgr>(SkFontMgr_New_CoreText(nullptr));
+#else
+    static sk_sp<SkFontMgr>* fontMgr = new sk_sp<SkFontMgr>(SkFontMgr_New_Custom_Directory(SKR_SYSTEM_FONT_DIR));
+#endif
+    return *fontMgr;
+}
+
 sk_sp<SkTypeface> FontManager::loadFont(const std::string& fontFamily) {
+    return loadFont(fontFamily, SkFontStyle::Normal());
+}
+
+sk_sp<SkTypeface> FontManager::loadFont(const std::string& fontFamily, const SkFontStyle& style) {
     // 首先检查是否有注册的字体文件
     auto it = fontFileMap.find(fontFamily);
     if (it != fontFileMap.end()) {
@@ -32,13 +53,22 @@ sk_sp<SkTypeface> FontManager::loadFont(const std::string& fontFamily) {
             return typeface;
         }
     }
-    
+
+    // 其次查找字体目录索引
+    FontIndex::Face face;
+    if (fontIndex.find(fontFamily, style, &face)) {
+        sk_sp<SkTypeface> typeface = loadFileFont(face.path, face.index);
+        if (typeface) {
+            return typeface;
+        }
+    }
+
     // 尝试加载系统字体
-    sk_sp<SkTypeface> typeface = loadSystemFont(fontFamily);
+    sk_sp<SkTypeface> typeface = loadSystemFont(fontFamily, style);
     if (typeface) {
         return typeface;
     }
-    
+
     // 回退到默认字体
     return getDefaultFont();
 }
@@ -48,8 +78,23 @@ bool FontManager::registerFontFile(const std::string& fontName, const std::strin
     return true;
 }
 
+bool FontManager::addFontDirectory(const std::string& directory) {
+    return fontIndex.addDirectory(directory);
+}
+
 sk_sp<SkTypeface> FontManager::getDefaultFont() {
-    return fontMgr->legacyMakeTypeface("Arial", SkFontStyle::Normal());
+    sk_sp<SkTypeface> typeface = fontMgr->legacyMakeTypeface("Arial", SkFontStyle::Normal());
+    if (!typeface) {
+        typeface = fontMgr->legacyMakeTypeface(nullptr, SkFontStyle::Normal());
+    }
+    // 精简的系统上可能一个系统字体都没有，退回字体目录中的第一个字体
+    if (!typeface) {
+        std::vector<FontIndex::Face> faces = fontIndex.getFaces();
+        if (!faces.empty()) {
+            typeface = loadFileFont(faces.front().path, faces.front().index);
+        }
+    }
+    return typeface;
 }
 
 bool FontManager::isFontAvailable(const std::string& fontFamily) {
@@ -57,12 +102,51 @@ bool FontManager::isFontAvailable(const std::string& fontFamily) {
     return typeface != nullptr;
 }
 
-sk_sp<SkTypeface> FontManager::loadSystemFont(const std::string& fontFamily) {
-    return fontMgr->legacyMakeTypeface(fontFamily.c_str(), SkFontStyle::Normal());
+std::string FontManager::getFontFilePath(const std::string& fontFamily) const {
+    auto it = fontFileMap.find(fontFamily);
+    if (it != fontFileMap.end()) {
+        return it->second;
+    }
+    FontIndex::Face face;
+    if (fontIndex.find(fontFamily, SkFontStyle::Normal(), &face)) {
+        return face.path;
+    }
+    return "";
+}
+
+sk_sp<SkTypeface> FontManager::loadSystemFont(const std::string& fontFamily, const SkFontStyle& style) {
+    return fontMgr->legacyMakeTypeface(fontFamily.c_str(), style);
 }
 
-sk_sp<SkTypeface> FontManager::loadFileFont(const std::string& filePath) {
-    return fontMgr->makeFromFile(filePath.c_str(), 0);
+void FontManager::setAssetBundle(std::shared_ptr<const AssetBundle> bundle) {
+    assetBundle = std::move(bundle);
+    std::lock_guard<std::mutex> lock(typefaceMutex);
+    typefaces.clear();
+}
+
+sk_sp<SkTypeface> FontManager::loadFileFont(const std::string& filePath, int index) {
+    std::string key = filePath + "#" + std::to_string(index);
+    {
+        std::lock_guard<std::mutex> lock(typefaceMutex);
+        auto it = typefaces.find(key);
+        if (it != typefaces.end()) {
+            return it->second;
+        }
+    }
+
+    sk_sp<SkTypeface> typeface;
+    sk_sp<SkData> data = assetBundle ? assetBundle->getData(filePath) : nullptr;
+    if (data) {
+        typeface = fontMgr->makeFromData(std::move(data), index);
+    } else {
+        typeface = fontMgr->makeFromFile(filePath.c_str(), index);
+    }
+    // 打开失败的不缓存，文件之后出现时仍能加载
+    if (typeface) {
+        std::lock_guard<std::mutex> lock(typefaceMutex);
+        typefaces[key] = typeface;
+    }
+    return typeface;
 }
 
-} // namespace skia_renderer 
+} // namespace skia_renderer
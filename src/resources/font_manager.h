@@ -2,37 +2,72 @@
 
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkTypeface.h"
-#include "include/ports/SkFontMgr_mac_ct.h"
+#include "resources/asset_bundle.h"
+#include "resources/font_index.h"
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace skia_renderer {
 
+// 字体管理 - 查找顺序：注册的字体文件 → 字体目录索引（按name表中的家族名/PostScript名/全名）→ 平台字体
+// 字体目录的扫描结果持久化在索引文件中（见FontIndex），字体对象在首次使用时才创建并缓存
 class FontManager {
 public:
+    // 扫描res/Fonts，索引保存在cache/fonts/index.json
     FontManager();
+
+    // 扫描给定的字体目录；indexPath为空时不保存索引，每次启动都重新解析
+    FontManager(const std::vector<std::string>& fontDirectories, const std::string& indexPath);
+
     ~FontManager();
-    
+
+    // 平台字体后端（进程共享）：macOS为CoreText，其他平台为扫描SKR_SYSTEM_FONT_DIR的FreeType后端
+    static sk_sp<SkFontMgr> platformFontMgr();
+
     // 加载字体
     sk_sp<SkTypeface> loadFont(const std::string& fontFamily);
-    
+
+    // 按字重/宽度/斜体加载：同一家族有多个字体文件时取最接近的
+    sk_sp<SkTypeface> loadFont(const std::string& fontFamily, const SkFontStyle& style);
+
     // 注册字体文件
     bool registerFontFile(const std::string& fontName, const std::string& filePath);
-    
+
+    // 扫描字体目录（递归）并加入索引，目录不存在时返回false
+    bool addFontDirectory(const std::string& directory);
+
+    // 字体目录索引
+    const FontIndex& getFontIndex() const { return fontIndex; }
+
     // 获取默认字体
     sk_sp<SkTypeface> getDefaultFont();
-    
+
     // 检查字体是否可用
     bool isFontAvailable(const std::string& fontFamily);
 
+    // 获取字体文件路径（注册的或字体目录中的），平台字体返回空字符串
+    std::string getFontFilePath(const std::string& fontFamily) const;
+
+    // 设置资源包：字体文件在包内时从映射的数据创建字体，不再打开文件
+    void setAssetBundle(std::shared_ptr<const AssetBundle> bundle);
+
+    // 当前使用的资源包
+    const AssetBundle* getAssetBundle() const { return assetBundle.get(); }
+
 private:
     sk_sp<SkFontMgr> fontMgr;
     std::map<std::string, std::string> fontFileMap;
-    
+    std::shared_ptr<const AssetBundle> assetBundle;
+    FontIndex fontIndex;
+    std::mutex typefaceMutex;
+    std::map<std::string, sk_sp<SkTypeface>> typefaces;  // "路径#序号" -> 已创建的字体
+
     // 辅助方法
-    sk_sp<SkTypeface> loadSystemFont(const std::string& fontFamily);
-    sk_sp<SkTypeface> loadFileFont(const std::string& filePath);
+    sk_sp<SkTypeface> loadSystemFont(const std::string& fontFamily, const SkFontStyle& style);
+    sk_sp<SkTypeface> loadFileFont(const std::string& filePath, int index = 0);
 };
 
-} // namespace skia_renderer 
\ No newline at end of file
+} // namespace skia_renderer
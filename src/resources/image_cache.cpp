@@ -0,0 +1,125 @@
+#include "resources/image_cache.h"
+
+namespace skia_renderer {
+
+namespace {
+
+// 默认最多缓存256MB解码后的像素
+constexpr size_t kDefaultMaxBytes = 256 * 1024 * 1024;
+
+// 尺寸记忆的条目上限，超出时整体清空（每条只有几十字节，清空后按需重新读文件头）
+constexpr size_t kMaxDimensionEntries = 16384;
+
+// 像素字节数，带mipmap时加上金字塔约1/3的额外内存
+size_t imageBytes(const SkImage* image) {
+    size_t bytes = image->imageInfo().computeMinByteSize();
+    if (image->hasMipmaps()) {
+        bytes += bytes / 3;
+    }
+    return bytes;
+}
+
+} // namespace
+
+ImageCache& ImageCache::shared() {
+    static ImageCache* cache = new ImageCache();
+    return *cache;
+}
+
+ImageCache::ImageCache() :
+    maxBytes(kDefaultMaxBytes) {
+}
+
+sk_sp<SkImage> ImageCache::find(const std::string& key, SkIRect* sourceRegion) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        ++stats.misses;
+        return nullptr;
+    }
+
+    ++stats.hits;
+    lru.splice(lru.begin(), lru, it->second.lruPosition);
+    if (sourceRegion) {
+        *sourceRegion = it->second.sourceRegion;
+    }
+    return it->second.image;
+}
+
+void ImageCache::insert(const std::string& key, sk_sp<SkImage> image, const SkIRect& sourceRegion) {
+    if (!image) {
+        return;
+    }
+
+    size_t bytes = imageBytes(image.get());
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bytes > maxBytes) {
+        return;
+    }
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        // 并发解码同一素材时后写入的覆盖先写入的，两者内容相同
+        stats.totalBytes -= it->second.bytes;
+        lru.erase(it->second.lruPosition);
+        entries.erase(it);
+    }
+
+    evictLocked(maxBytes - bytes);
+    lru.push_front(key);
+    Entry& entry = entries[key];
+    entry.image = std::move(image);
+    entry.sourceRegion = sourceRegion.isEmpty() ? SkIRect::MakeSize(entry.image->dimensions()) : sourceRegion;
+    entry.bytes = bytes;
+    entry.lruPosition = lru.begin();
+    stats.totalBytes += bytes;
+    stats.entryCount = entries.size();
+}
+
+bool ImageCache::findDimensions(const std::string& key, SkISize* size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = dimensions.find(key);
+    if (it == dimensions.end()) {
+        return false;
+    }
+    *size = it->second;
+    return true;
+}
+
+void ImageCache::insertDimensions(const std::string& key, SkISize size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (dimensions.size() >= kMaxDimensionEntries) {
+        dimensions.clear();
+    }
+    dimensions[key] = size;
+}
+
+void ImageCache::setMaxBytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxBytes = bytes;
+    evictLocked(maxBytes);
+}
+
+void ImageCache::purge() {
+    std::lock_guard<std::mutex> lock(mutex);
+    evictLocked(0);
+    dimensions.clear();
+}
+
+ImageCache::Stats ImageCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void ImageCache::evictLocked(size_t limit) {
+    while (stats.totalBytes > limit && !lru.empty()) {
+        auto it = entries.find(lru.back());
+        stats.totalBytes -= it->second.bytes;
+        entries.erase(it);
+        lru.pop_back();
+        ++stats.evictions;
+    }
+    stats.entryCount = entries.size();
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "include/core/SkImage.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkSize.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace skia_renderer {
+
+// 已解码图片缓存 - 进程内共享，按像素字节数做LRU淘汰
+//
+// 缓存的是光栅图像（像素已在内存中），同一素材在后续渲染中直接绘制，不再读文件和解码。
+// 区域解码或降采样解码的图像只对应原图的一部分或尺寸更小，sourceRegion记录它覆盖的原图区域；
+// 另外记住每个素材的原图尺寸，计算可见区域时不必再读文件头。
+// 键由调用方构造，需包含能区分内容的信息（如路径+文件大小+修改时间），缓存本身不检查文件变化。
+// 所有方法线程安全，可在解码线程中并发调用。
+class ImageCache {
+public:
+    // 进程内共享的图片缓存
+    static ImageCache& shared();
+
+    // 查找缓存，命中时移到LRU头部；sourceRegion返回图像覆盖的原图区域
+    sk_sp<SkImage> find(const std::string& key, SkIRect* sourceRegion = nullptr);
+
+    // 写入缓存，超出上限时淘汰最久未使用的图像；单张超过上限的图像不缓存
+    // sourceRegion为空时表示图像就是完整的原图
+    void insert(const std::string& key, sk_sp<SkImage> image, const SkIRect& sourceRegion = SkIRect::MakeEmpty());
+
+    // 原图尺寸的记忆
+    bool findDimensions(const std::string& key, SkISize* dimensions);
+    void insertDimensions(const std::string& key, SkISize dimensions);
+
+    // 像素内存上限，超出时立即淘汰
+    void setMaxBytes(size_t bytes);
+
+    // 清空缓存
+    void purge();
+
+    // 统计信息
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t totalBytes = 0;
+        size_t entryCount = 0;
+    };
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        sk_sp<SkImage> image;
+        SkIRect sourceRegion;
+        size_t bytes = 0;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    ImageCache();
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru;            // 头部为最近使用
+    std::unordered_map<std::string, SkISize> dimensions;
+    size_t maxBytes;
+    Stats stats;
+
+    // 淘汰直到满足上限，需持有mutex
+    void evictLocked(size_t limit);
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,195 @@
+#include "resources/image_decoder.h"
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
+#include "include/codec/SkEncodedOrigin.h"
+#include "include/core/SkBitmap.h"
+
+namespace skia_renderer {
+
+namespace {
+
+// 解码目标格式：N32，带透明度的图片转为预乘alpha
+SkImageInfo decodeInfo(const SkCodec& codec, int width, int height) {
+    SkImageInfo info = codec.getInfo().makeWH(width, height).makeColorType(kN32_SkColorType);
+    if (info.alphaType() == kUnpremul_SkAlphaType) {
+        info = info.makeAlphaType(kPremul_SkAlphaType);
+    }
+    return info;
+}
+
+// 编码格式带alpha通道但像素全部不透明（常见于导出为RGBA的PNG）时标记为不透明，
+// 绘制时可以走不透明快速路径；扫描只在解码时做一次，结果随图像缓存
+sk_sp<SkImage> finishBitmap(SkBitmap* bitmap) {
+    if (!bitmap->isOpaque() && bitmap->pixmap().computeIsOpaque()) {
+        bitmap->setAlphaType(kOpaque_SkAlphaType);
+    }
+    bitmap->setImmutable();
+    return bitmap->asImage();
+}
+
+// WebP：编解码器直接支持子区域
+sk_sp<SkImage> decodeWithSubset(SkCodec* codec, SkIRect* region) {
+    SkIRect subset = *region;
+    if (!codec->getValidSubset(&subset)) {
+        return nullptr;
+    }
+
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(decodeInfo(*codec, subset.width(), subset.height()))) {
+        return nullptr;
+    }
+    SkCodec::Options options;
+    options.fSubset = &subset;
+    if (codec->getPixels(bitmap.pixmap(), &options) != SkCodec::kSuccess) {
+        return nullptr;
+    }
+    *region = subset;
+    return finishBitmap(&bitmap);
+}
+
+// PNG/GIF：增量解码时只写出子区域
+sk_sp<SkImage> decodeIncremental(SkCodec* codec, const SkIRect& region) {
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(decodeInfo(*codec, region.width(), region.height()))) {
+        return nullptr;
+    }
+    SkCodec::Options options;
+    options.fSubset = &region;
+    if (codec->startIncrementalDecode(bitmap.info(), bitmap.getPixels(), bitmap.rowBytes(), &options) !=
+        SkCodec::kSuccess) {
+        return nullptr;
+    }
+    if (codec->incrementalDecode() != SkCodec::kSuccess) {
+        return nullptr;
+    }
+    return finishBitmap(&bitmap);
+}
+
+// JPEG：扫描线解码只支持按列裁剪，行方向靠跳行实现
+sk_sp<SkImage> decodeScanlines(SkCodec* codec, const SkIRect& region) {
+    SkISize dimensions = codec->getInfo().dimensions();
+    SkIRect columns = SkIRect::MakeLTRB(region.left(), 0, region.right(), dimensions.height());
+    SkCodec::Options options;
+    options.fSubset = &columns;
+
+    SkImageInfo scanlineInfo = decodeInfo(*codec, region.width(), dimensions.height());
+    if (codec->startScanlineDecode(scanlineInfo, &options) != SkCodec::kSuccess ||
+        codec->getScanlineOrder() != SkCodec::kTopDown_SkScanlineOrder) {
+        return nullptr;
+    }
+
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(scanlineInfo.makeWH(region.width(), region.height()))) {
+        return nullptr;
+    }
+    if (!codec->skipScanlines(region.top())) {
+        return nullptr;
+    }
+    if (codec->getScanlines(bitmap.getPixels(), region.height(), bitmap.rowBytes()) != region.height()) {
+        return nullptr;
+    }
+    return finishBitmap(&bitmap);
+}
+
+// 降采样解码整张图：SkAndroidCodec按sampleSize缩小，只分配缩小后的像素
+sk_sp<SkImage> decodeSampled(const sk_sp<SkData>& data, int sampleSize, SkIRect* decodedRegion) {
+    std::unique_ptr<SkAndroidCodec> codec = SkAndroidCodec::MakeFromData(data);
+    if (!codec || codec->codec()->getOrigin() != kTopLeft_SkEncodedOrigin) {
+        return nullptr;
+    }
+
+    SkISize size = codec->getSampledDimensions(sampleSize);
+    SkImageInfo info = codec->getInfo().makeDimensions(size).makeColorType(kN32_SkColorType);
+    if (info.alphaType() == kUnpremul_SkAlphaType) {
+        info = info.makeAlphaType(kPremul_SkAlphaType);
+    }
+    SkBitmap bitmap;
+    if (size.isEmpty() || !bitmap.tryAllocPixels(info)) {
+        return nullptr;
+    }
+
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = sampleSize;
+    if (codec->getAndroidPixels(bitmap.info(), bitmap.getPixels(), bitmap.rowBytes(), &options) !=
+        SkCodec::kSuccess) {
+        return nullptr;
+    }
+    *decodedRegion = SkIRect::MakeSize(codec->getInfo().dimensions());
+    return finishBitmap(&bitmap);
+}
+
+} // namespace
+
+bool ImageDecoder::readDimensions(const sk_sp<SkData>& data, SkISize* dimensions) {
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    if (!codec) {
+        return false;
+    }
+
+    SkISize size = codec->dimensions();
+    if (SkEncodedOriginSwapsWidthHeight(codec->getOrigin())) {
+        size = {size.height(), size.width()};
+    }
+    *dimensions = size;
+    return true;
+}
+
+SkISize ImageDecoder::sampledSize(const SkISize& size, int sampleSize) {
+    if (sampleSize <= 1) {
+        return size;
+    }
+    return SkISize::Make((size.width() + sampleSize - 1) / sampleSize,
+                         (size.height() + sampleSize - 1) / sampleSize);
+}
+
+sk_sp<SkImage> ImageDecoder::decode(const sk_sp<SkData>& data, const SkIRect& region, SkIRect* decodedRegion,
+                                    int sampleSize) {
+    if (!data) {
+        return nullptr;
+    }
+
+    // 降采样解码失败时不退化为全尺寸解码，调用方正是为了控制内存才要求降采样
+    if (sampleSize > 1) {
+        return decodeSampled(data, sampleSize, decodedRegion);
+    }
+
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    if (codec && !region.isEmpty() && codec->getOrigin() == kTopLeft_SkEncodedOrigin) {
+        SkIRect subset = region;
+        if (subset.intersect(SkIRect::MakeSize(codec->dimensions())) &&
+            subset != SkIRect::MakeSize(codec->dimensions())) {
+            // 三种方式依次尝试；编解码器状态在失败后由下一次start/getPixels负责回退
+            sk_sp<SkImage> image = decodeWithSubset(codec.get(), &subset);
+            if (!image) {
+                image = decodeIncremental(codec.get(), subset);
+            }
+            if (!image) {
+                image = decodeScanlines(codec.get(), subset);
+            }
+            if (image) {
+                *decodedRegion = subset;
+                return image;
+            }
+        }
+    }
+
+    // 整张解码：通过延迟图像解码，EXIF方向和各种格式都由Skia处理；
+    // 不允许Skia在资源缓存里再留一份解码结果，像素只由ImageCache持有
+    sk_sp<SkImage> lazyImage = SkImages::DeferredFromEncodedData(data);
+    if (!lazyImage) {
+        return nullptr;
+    }
+    SkImageInfo info = lazyImage->imageInfo().makeColorType(kN32_SkColorType);
+    if (info.alphaType() == kUnpremul_SkAlphaType) {
+        info = info.makeAlphaType(kPremul_SkAlphaType);
+    }
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(info) ||
+        !lazyImage->readPixels(nullptr, bitmap.pixmap(), 0, 0, SkImage::kDisallow_CachingHint)) {
+        return nullptr;
+    }
+    *decodedRegion = SkIRect::MakeSize(info.dimensions());
+    return finishBitmap(&bitmap);
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkSize.h"
+
+namespace skia_renderer {
+
+// 图片解码 - 把编码数据解码为光栅图像，支持只解码原图的一个矩形区域
+//
+// 区域解码按编解码器能力依次尝试：
+// - WebP：getPixels直接按子区域解码（左上角需为偶数，区域会向外对齐）
+// - PNG/GIF：增量解码只保留子区域的行和列
+// - JPEG：扫描线解码按列裁剪，跳过区域上方的行，读到区域底部即停止
+// 都不支持（或图片带EXIF旋转）时退化为整张解码。
+// sampleSize大于1时用SkAndroidCodec降采样解码整张图（每边缩小sampleSize倍），解码时就只分配缩小后的像素。
+// 像素全部不透明的图像（包括带alpha通道的PNG）返回kOpaque_SkAlphaType，供绘制时走不透明快速路径。
+class ImageDecoder {
+public:
+    // 只解析文件头获取原图尺寸（已应用EXIF方向），失败返回false
+    static bool readDimensions(const sk_sp<SkData>& data, SkISize* dimensions);
+
+    // 解码region区域（原图坐标），region为空时解码整张图
+    // 成功时返回图像，decodedRegion为图像在原图中的实际位置（可能比请求的区域大）；
+    // 降采样时忽略region，decodedRegion为整张原图，图像尺寸约为原图的1/sampleSize
+    static sk_sp<SkImage> decode(const sk_sp<SkData>& data, const SkIRect& region, SkIRect* decodedRegion,
+                                 int sampleSize = 1);
+
+    // 降采样解码后的尺寸上限（用于预算估计，实际尺寸不会超过它）
+    static SkISize sampledSize(const SkISize& size, int sampleSize);
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,276 @@
+#include "resources/image_source.h"
+#include "utils/base64.h"
+#include "utils/content_hash.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <strings.h>
+#include <sys/stat.h>
+
+namespace skia_renderer {
+
+namespace {
+
+const char kDataScheme[] = "data:";
+constexpr size_t kDataSchemeLength = sizeof(kDataScheme) - 1;
+const char kFileScheme[] = "file://";
+constexpr size_t kFileSchemeLength = sizeof(kFileScheme) - 1;
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// 非base64的data: URI按百分号编码解码
+sk_sp<SkData> decodePercent(const char* text, size_t length) {
+    sk_sp<SkData> buffer = SkData::MakeUninitialized(length);
+    uint8_t* out = static_cast<uint8_t*>(buffer->writable_data());
+    size_t written = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (text[i] != '%') {
+            out[written++] = static_cast<uint8_t>(text[i]);
+            continue;
+        }
+        int high = i + 2 < length ? hexValue(text[i + 1]) : -1;
+        int low = i + 2 < length ? hexValue(text[i + 2]) : -1;
+        if (high < 0 || low < 0) {
+            return nullptr;
+        }
+        out[written++] = static_cast<uint8_t>(high * 16 + low);
+        i += 2;
+    }
+    return SkData::MakeSubset(buffer.get(), 0, written);
+}
+
+} // namespace
+
+void ImageSource::registerData(const std::string& name, sk_sp<SkData> data) {
+    if (!data) {
+        unregisterData(name);
+        return;
+    }
+    MemoryEntry entry;
+    entry.hash = ContentHash::hex(data->data(), data->size());
+    entry.data = std::move(data);
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryData[name] = std::move(entry);
+}
+
+bool ImageSource::unregisterData(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryData.erase(name) > 0;
+}
+
+void ImageSource::clearData() {
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryData.clear();
+}
+
+bool ImageSource::hasData(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryData.count(name) > 0;
+}
+
+void ImageSource::setAssetBundle(std::shared_ptr<const AssetBundle> bundle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    assetBundle = std::move(bundle);
+}
+
+std::shared_ptr<const AssetBundle> ImageSource::getAssetBundle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return assetBundle;
+}
+
+void ImageSource::setUrlCache(std::shared_ptr<UrlCache> cache) {
+    std::lock_guard<std::mutex> lock(mutex);
+    urlCache = std::move(cache);
+}
+
+std::shared_ptr<UrlCache> ImageSource::getUrlCache() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return urlCache ? urlCache : UrlCache::shared();
+}
+
+size_t ImageSource::prefetchUrls(const std::vector<std::string>& paths) const {
+    std::vector<std::string> urls;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& path : paths) {
+            if (UrlCache::isUrl(path) && memoryData.count(path) == 0) {
+                urls.push_back(path);
+            }
+        }
+    }
+    return urls.empty() ? 0 : getUrlCache()->prefetch(urls);
+}
+
+sk_sp<SkData> ImageSource::load(const std::string& path) const {
+    std::shared_ptr<const AssetBundle> bundle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = memoryData.find(path);
+        if (it != memoryData.end()) {
+            return it->second.data;
+        }
+        bundle = assetBundle;
+    }
+
+    if (isDataUri(path)) {
+        return decodeDataUri(path);
+    }
+    if (UrlCache::isUrl(path)) {
+        std::string error;
+        sk_sp<SkData> data = getUrlCache()->load(path, &error);
+        if (!data) {
+            std::cerr << error << std::endl;
+        }
+        return data;
+    }
+    std::string localPath = filePath(path);
+    if (bundle) {
+        sk_sp<SkData> data = bundle->getData(localPath);
+        if (data) {
+            return data;
+        }
+    }
+    return SkData::MakeFromFileName(localPath.c_str());
+}
+
+std::string ImageSource::cacheKey(const std::string& path, SkISize* dimensions) const {
+    std::shared_ptr<const AssetBundle> bundle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = memoryData.find(path);
+        if (it != memoryData.end()) {
+            return "memory:" + it->second.hash;
+        }
+        bundle = assetBundle;
+    }
+
+    // URI本身决定了内容，不必先解码
+    if (isDataUri(path)) {
+        return "data:" + ContentHash::hex(path.data(), path.size());
+    }
+
+    // 缓存的内容以哈希命名，URL指向的内容变化后（重新验证时）键随之变化
+    if (UrlCache::isUrl(path)) {
+        UrlCache::Entry urlEntry;
+        std::string error;
+        if (!getUrlCache()->resolve(path, &urlEntry, &error)) {
+            std::cerr << error << std::endl;
+            return "";
+        }
+        return "url:" + urlEntry.contentHash;
+    }
+
+    // 资源包内容不可变，内容哈希即可区分；不同资源包中相同的素材共享解码结果
+    std::string localPath = filePath(path);
+    AssetBundle::Entry entry;
+    if (bundle && bundle->find(localPath, &entry)) {
+        if (dimensions && entry.width > 0 && entry.height > 0) {
+            *dimensions = SkISize::Make(entry.width, entry.height);
+        }
+        return "bundle:" + entry.contentHash;
+    }
+
+    struct stat info;
+    if (stat(localPath.c_str(), &info) != 0) {
+        return "";
+    }
+    return localPath + "|" + std::to_string(static_cast<long long>(info.st_size)) + "|" +
+           std::to_string(static_cast<long long>(info.st_mtime));
+}
+
+bool ImageSource::contentHash(const std::string& path, std::string* hash) const {
+    std::shared_ptr<const AssetBundle> bundle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = memoryData.find(path);
+        if (it != memoryData.end()) {
+            *hash = it->second.hash;
+            return true;
+        }
+        bundle = assetBundle;
+    }
+
+    if (isDataUri(path)) {
+        *hash = ContentHash::hex(path.data(), path.size());
+        return true;
+    }
+    if (UrlCache::isUrl(path)) {
+        UrlCache::Entry urlEntry;
+        if (!getUrlCache()->resolve(path, &urlEntry)) {
+            return false;
+        }
+        *hash = urlEntry.contentHash;
+        return true;
+    }
+    AssetBundle::Entry entry;
+    if (bundle && bundle->find(filePath(path), &entry)) {
+        *hash = entry.contentHash;
+        return true;
+    }
+    return false;
+}
+
+bool ImageSource::isDataUri(const std::string& path) {
+    return path.size() >= kDataSchemeLength && strncasecmp(path.c_str(), kDataScheme, kDataSchemeLength) == 0;
+}
+
+sk_sp<SkData> ImageSource::decodeDataUri(const std::string& uri) {
+    if (!isDataUri(uri)) {
+        return nullptr;
+    }
+    size_t comma = uri.find(',', kDataSchemeLength);
+    if (comma == std::string::npos) {
+        return nullptr;
+    }
+
+    // 媒体类型只用于说明，实际格式由编解码器按文件头识别
+    std::string metadata = uri.substr(kDataSchemeLength, comma - kDataSchemeLength);
+    const char* payload = uri.data() + comma + 1;
+    size_t payloadLength = uri.size() - comma - 1;
+    const char kBase64Suffix[] = ";base64";
+    size_t suffixLength = sizeof(kBase64Suffix) - 1;
+    bool base64 = metadata.size() >= suffixLength &&
+                  strcasecmp(metadata.c_str() + metadata.size() - suffixLength, kBase64Suffix) == 0;
+    return base64 ? Base64::decode(payload, payloadLength) : decodePercent(payload, payloadLength);
+}
+
+std::string ImageSource::filePath(const std::string& path) {
+    if (path.size() <= kFileSchemeLength || strncasecmp(path.c_str(), kFileScheme, kFileSchemeLength) != 0) {
+        return path;
+    }
+    // file:///绝对路径 或 file://localhost/绝对路径，其他主机名无法在本地访问，原样保留
+    std::string rest = path.substr(kFileSchemeLength);
+    if (strncasecmp(rest.c_str(), "localhost/", 10) == 0) {
+        rest = rest.substr(9);
+    }
+    if (rest.empty() || rest[0] != '/') {
+        return path;
+    }
+    sk_sp<SkData> decoded = decodePercent(rest.data(), rest.size());
+    if (!decoded) {
+        return path;
+    }
+    return std::string(static_cast<const char*>(decoded->data()), decoded->size());
+}
+
+std::string ImageSource::displayName(const std::string& path) {
+    if (!isDataUri(path)) {
+        return path;
+    }
+    size_t comma = path.find(',');
+    std::string metadata = path.substr(0, std::min(comma, static_cast<size_t>(64)));
+    return metadata + ",...(" + std::to_string(path.size()) + "字符)";
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "resources/asset_bundle.h"
+#include "resources/url_cache.h"
+#include "include/core/SkData.h"
+#include "include/core/SkSize.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace skia_renderer {
+
+// 图片来源 - 把ImageElement::path解析为编码数据，依次查找：
+// 1. 注册的内存数据：path与registerData的名称完全相同（可以用素材原路径注册来覆盖文件）
+// 2. data: URI：data:[<媒体类型>][;base64],<数据>，base64部分用SIMD解码，否则按百分号编码解码
+// 3. http(s) URL：经URL缓存下载一次后以内容寻址保存在磁盘上，之后直接映射缓存文件
+// 4. 资源包：包内存在该路径时使用映射的数据
+// 5. 文件系统：file:// URL按本地路径处理
+// 前三种都不经过素材的文件路径。可在渲染线程之外并发调用（预取在线程池上进行）。
+class ImageSource {
+public:
+    // 注册内存中的编码数据，同名时替换；注册时计算一次内容哈希，用作解码缓存和结果缓存的键
+    void registerData(const std::string& name, sk_sp<SkData> data);
+
+    // 移除注册的数据，不存在时返回false
+    bool unregisterData(const std::string& name);
+
+    // 移除所有注册的数据
+    void clearData();
+
+    // 是否注册了该名称的内存数据
+    bool hasData(const std::string& name) const;
+
+    // 设置资源包，nullptr表示不使用
+    void setAssetBundle(std::shared_ptr<const AssetBundle> bundle);
+    std::shared_ptr<const AssetBundle> getAssetBundle() const;
+
+    // 设置URL缓存，nullptr表示使用进程共享的UrlCache::shared()
+    void setUrlCache(std::shared_ptr<UrlCache> cache);
+    std::shared_ptr<UrlCache> getUrlCache() const;
+
+    // 并发下载paths中尚未缓存的http(s) URL（重复的只下载一次），返回失败的个数；
+    // 渲染前调用可以让下载互相重叠，不必等到逐个计算缓存键时才下载
+    size_t prefetchUrls(const std::vector<std::string>& paths) const;
+
+    // 读取编码数据，无法读取时返回nullptr
+    sk_sp<SkData> load(const std::string& path) const;
+
+    // 解码缓存的键：内存数据、URL和资源包按内容哈希，data: URI按URI本身的哈希，
+    // 文件按路径+大小+修改时间（文件被替换后不会命中旧的解码结果）；无法读取时返回空字符串。
+    // 资源包内的图片同时通过dimensions返回打包时记录的原图尺寸（否则不修改）
+    std::string cacheKey(const std::string& path, SkISize* dimensions = nullptr) const;
+
+    // 不经过文件系统的来源直接给出内容哈希（与结果缓存的文件哈希算法相同），URL在需要时先下载；
+    // 文件系统路径（包括file:// URL）返回false
+    bool contentHash(const std::string& path, std::string* hash) const;
+
+    // 是否为data: URI
+    static bool isDataUri(const std::string& path);
+
+    // 解析data: URI，格式错误时返回nullptr
+    static sk_sp<SkData> decodeDataUri(const std::string& uri);
+
+    // file:// URL对应的本地路径（百分号编码已解码），其他路径原样返回
+    static std::string filePath(const std::string& path);
+
+    // 用于日志和错误信息的名称，data: URI只保留媒体类型和长度
+    static std::string displayName(const std::string& path);
+
+private:
+    struct MemoryEntry {
+        sk_sp<SkData> data;
+        std::string hash;
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, MemoryEntry> memoryData;
+    std::shared_ptr<const AssetBundle> assetBundle;
+    std::shared_ptr<UrlCache> urlCache;
+};
+
+} // namespace skia_renderer
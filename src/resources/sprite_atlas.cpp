@@ -0,0 +1,360 @@
+#include "resources/sprite_atlas.h"
+#include "resources/image_decoder.h"
+#include "utils/content_hash.h"
+#include "utils/temp_file.h"
+#include "3rdparty/json/include/nlohmann/json.hpp"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkStream.h"
+#include "include/encode/SkPngEncoder.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace skia_renderer {
+
+namespace {
+
+constexpr int kIndexVersion = 1;
+
+// 图集宽度从该值起按2的幂尝试，取面积最小的排布
+constexpr int kMinAtlasWidth = 64;
+
+std::string normalizePath(const std::string& path) {
+    return fs::path(path).lexically_normal().generic_string();
+}
+
+bool fileStamp(const std::string& path, long long* size, long long* modifiedTime) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    *size = static_cast<long long>(info.st_size);
+    *modifiedTime = static_cast<long long>(info.st_mtime);
+    return true;
+}
+
+bool isAtlasImageExtension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".webp";
+}
+
+// 精灵边缘像素向外复制kPadding像素：先上下扩展行，再左右扩展列（角落随之填满）
+void extrudeEdges(SkPixmap* atlas, const SkIRect& rect) {
+    const int padding = SpriteAtlas::kPadding;
+    size_t rowBytes = static_cast<size_t>(rect.width()) * sizeof(uint32_t);
+    for (int i = 1; i <= padding; ++i) {
+        std::memcpy(atlas->writable_addr32(rect.left(), rect.top() - i),
+                    atlas->addr32(rect.left(), rect.top()), rowBytes);
+        std::memcpy(atlas->writable_addr32(rect.left(), rect.bottom() - 1 + i),
+                    atlas->addr32(rect.left(), rect.bottom() - 1), rowBytes);
+    }
+    for (int y = rect.top() - padding; y < rect.bottom() + padding; ++y) {
+        uint32_t left = *atlas->addr32(rect.left(), y);
+        uint32_t right = *atlas->addr32(rect.right() - 1, y);
+        for (int i = 1; i <= padding; ++i) {
+            *atlas->writable_addr32(rect.left() - i, y) = left;
+            *atlas->writable_addr32(rect.right() - 1 + i, y) = right;
+        }
+    }
+}
+
+// 先写临时文件再改名，加载中的进程不会读到写了一半的文件；失败时删除临时文件，原有文件保持不变
+bool commitFile(const std::string& path, const void* data, size_t size) {
+    std::string tempPath = TempFile::pathFor(path);
+    std::error_code ec;
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        file.close();
+        if (file.fail()) {
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<SpriteAtlas> SpriteAtlas::load(const std::string& indexPath, std::string* errorMessage) {
+    auto fail = [&](const std::string& message) {
+        if (errorMessage) {
+            *errorMessage = message + ": " + indexPath;
+        }
+        return nullptr;
+    };
+
+    sk_sp<SkData> indexData = SkData::MakeFromFileName(indexPath.c_str());
+    if (!indexData) {
+        return fail("无法打开图集索引");
+    }
+    const char* indexText = static_cast<const char*>(indexData->data());
+    json index = json::parse(indexText, indexText + indexData->size(), nullptr, false);
+    if (index.is_discarded() || !index.is_object() || index.value("version", 0) != kIndexVersion ||
+        !index.contains("sprites") || !index["sprites"].is_array()) {
+        return fail("图集索引格式错误");
+    }
+
+    // 图集图片与索引在同一目录
+    std::string imagePath = (fs::path(indexPath).parent_path() / index.value("image", "")).string();
+    sk_sp<SkData> data = SkData::MakeFromFileName(imagePath.c_str());
+    SkIRect decodedRegion;
+    sk_sp<SkImage> image = data ? ImageDecoder::decode(data, SkIRect::MakeEmpty(), &decodedRegion) : nullptr;
+    if (!image) {
+        return fail("无法解码图集图片 " + imagePath);
+    }
+    if (image->width() != index.value("width", 0) || image->height() != index.value("height", 0)) {
+        return fail("图集图片尺寸与索引不一致");
+    }
+
+    std::shared_ptr<SpriteAtlas> atlas = std::make_shared<SpriteAtlas>();
+    atlas->image = image;
+    SkIRect bounds = SkIRect::MakeSize(image->dimensions());
+    for (const auto& sprite : index["sprites"]) {
+        std::string path = sprite.value("path", "");
+        SkIRect rect = SkIRect::MakeXYWH(sprite.value("x", 0), sprite.value("y", 0),
+                                         sprite.value("width", 0), sprite.value("height", 0));
+        if (path.empty() || rect.isEmpty() || !bounds.contains(rect)) {
+            return fail("图集索引格式错误");
+        }
+
+        // 原文件被修改（或删除）后图集里的像素已过期
+        long long size = 0;
+        long long modifiedTime = 0;
+        if (!fileStamp(path, &size, &modifiedTime) || size != sprite.value("size", -1LL) ||
+            modifiedTime != sprite.value("mtime", -1LL)) {
+            ++atlas->staleCount;
+            continue;
+        }
+        atlas->sprites[normalizePath(path)] = rect;
+    }
+
+    // 过期的精灵回退到按文件绘制，可用精灵的集合也计入内容哈希
+    std::string content = ContentHash::hex(indexData->data(), indexData->size()) +
+                          ContentHash::hex(data->data(), data->size());
+    for (const auto& sprite : atlas->sprites) {
+        content += sprite.first + '\n';
+    }
+    atlas->indexPath = indexPath;
+    atlas->contentHash = ContentHash::hex(content.data(), content.size());
+    return atlas;
+}
+
+bool SpriteAtlas::find(const std::string& path, SkIRect* rect) const {
+    auto it = sprites.find(path);
+    if (it == sprites.end()) {
+        it = sprites.find(normalizePath(path));
+    }
+    if (it == sprites.end()) {
+        return false;
+    }
+    if (rect) {
+        *rect = it->second;
+    }
+    return true;
+}
+
+SpriteAtlasBuilder::SpriteAtlasBuilder(int maxSpriteSize, int maxAtlasSize) :
+    maxSpriteSize(maxSpriteSize),
+    maxAtlasSize(maxAtlasSize) {
+}
+
+bool SpriteAtlasBuilder::addFile(const std::string& path) {
+    PendingSprite sprite;
+    sprite.path = normalizePath(path);
+    if (!fileStamp(path, &sprite.fileSize, &sprite.modifiedTime)) {
+        errorMessage = "无法读取文件: " + path;
+        return false;
+    }
+
+    sk_sp<SkData> data = SkData::MakeFromFileName(path.c_str());
+    SkISize dimensions;
+    if (!data || !ImageDecoder::readDimensions(data, &dimensions)) {
+        errorMessage = "无法解析图片: " + path;
+        return false;
+    }
+    if (dimensions.width() > maxSpriteSize || dimensions.height() > maxSpriteSize) {
+        ++skippedCount;
+        return true;
+    }
+
+    SkIRect decodedRegion;
+    sprite.image = ImageDecoder::decode(data, SkIRect::MakeEmpty(), &decodedRegion);
+    if (!sprite.image) {
+        errorMessage = "无法解码图片: " + path;
+        return false;
+    }
+    pending.push_back(std::move(sprite));
+    return true;
+}
+
+bool SpriteAtlasBuilder::addDirectory(const std::string& directory) {
+    std::error_code ec;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        const fs::path& path = entry.path();
+        std::string name = path.filename().string();
+        bool isAtlas = name.size() > 10 && name.compare(name.size() - 10, 10, ".atlas.png") == 0;
+        if (entry.is_regular_file() && isAtlasImageExtension(path) && !isAtlas) {
+            files.push_back(path);
+        }
+    }
+    if (ec) {
+        errorMessage = "无法遍历目录: " + directory;
+        return false;
+    }
+
+    // 按路径排序，同样的输入得到相同的图集
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        if (!addFile(file.generic_string())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int SpriteAtlasBuilder::pack(int width) {
+    const int padding = SpriteAtlas::kPadding;
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+    for (auto& sprite : pending) {
+        int cellWidth = sprite.image->width() + padding * 2;
+        int cellHeight = sprite.image->height() + padding * 2;
+        if (cellWidth > width) {
+            sprite.position = SkIPoint::Make(-1, -1);
+            continue;
+        }
+        if (x + cellWidth > width) {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        sprite.position = SkIPoint::Make(x + padding, y + padding);
+        x += cellWidth;
+        shelfHeight = std::max(shelfHeight, cellHeight);
+    }
+    return y + shelfHeight;
+}
+
+bool SpriteAtlasBuilder::write(const std::string& basePath) {
+    if (pending.empty()) {
+        errorMessage = "没有可打包的图片";
+        return false;
+    }
+
+    // 逐行排布：先按高度再按宽度降序，每行高度由第一个精灵决定，浪费最少
+    std::stable_sort(pending.begin(), pending.end(), [](const PendingSprite& a, const PendingSprite& b) {
+        if (a.image->height() != b.image->height()) {
+            return a.image->height() > b.image->height();
+        }
+        return a.image->width() > b.image->width();
+    });
+
+    // 尝试各个2的幂宽度，取能全部放下且面积最小的；都放不下时用最大宽度，超出高度上限的留在图集外
+    int bestWidth = maxAtlasSize;
+    long long bestArea = -1;
+    for (int width = kMinAtlasWidth; width <= maxAtlasSize; width *= 2) {
+        int height = pack(width);
+        bool allPlaced = std::all_of(pending.begin(), pending.end(),
+                                     [](const PendingSprite& sprite) { return sprite.position.x() >= 0; });
+        long long area = static_cast<long long>(width) * height;
+        if (allPlaced && height <= maxAtlasSize && (bestArea < 0 || area < bestArea)) {
+            bestWidth = width;
+            bestArea = area;
+        }
+    }
+    int height = std::min(pack(bestWidth), maxAtlasSize);
+    packedCount = 0;
+    for (auto& sprite : pending) {
+        if (sprite.position.x() >= 0 &&
+            sprite.position.y() + sprite.image->height() + SpriteAtlas::kPadding > maxAtlasSize) {
+            sprite.position = SkIPoint::Make(-1, -1);
+        }
+        if (sprite.position.x() >= 0) {
+            ++packedCount;
+        } else {
+            ++skippedCount;
+        }
+    }
+    atlasSize = SkISize::Make(bestWidth, height);
+
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocN32Pixels(bestWidth, height)) {
+        errorMessage = "无法分配图集像素";
+        return false;
+    }
+    bitmap.eraseColor(SK_ColorTRANSPARENT);
+    SkPixmap atlasPixels = bitmap.pixmap();
+
+    json sprites = json::array();
+    for (const auto& sprite : pending) {
+        if (sprite.position.x() < 0) {
+            continue;
+        }
+        SkIRect rect = SkIRect::MakeXYWH(sprite.position.x(), sprite.position.y(),
+                                         sprite.image->width(), sprite.image->height());
+        SkPixmap cell;
+        if (!atlasPixels.extractSubset(&cell, rect) || !sprite.image->readPixels(cell, 0, 0)) {
+            errorMessage = "无法写入精灵: " + sprite.path;
+            return false;
+        }
+        extrudeEdges(&atlasPixels, rect);
+        sprites.push_back({
+            {"path", sprite.path},
+            {"x", rect.x()},
+            {"y", rect.y()},
+            {"width", rect.width()},
+            {"height", rect.height()},
+            {"size", sprite.fileSize},
+            {"mtime", sprite.modifiedTime},
+        });
+    }
+
+    // 先写图集图片，最后写索引：索引引用的图片总是完整的
+    std::string imagePath = basePath + ".atlas.png";
+    SkDynamicMemoryWStream png;
+    if (!SkPngEncoder::Encode(&png, atlasPixels, SkPngEncoder::Options())) {
+        errorMessage = "无法编码图集图片: " + imagePath;
+        return false;
+    }
+    sk_sp<SkData> encoded = png.detachAsData();
+    if (!commitFile(imagePath, encoded->data(), encoded->size())) {
+        errorMessage = "无法写入图集图片: " + imagePath;
+        return false;
+    }
+
+    json index = {
+        {"version", kIndexVersion},
+        {"image", fs::path(imagePath).filename().string()},
+        {"width", bestWidth},
+        {"height", height},
+        {"padding", SpriteAtlas::kPadding},
+        {"sprites", sprites},
+    };
+    std::string indexPath = basePath + ".atlas.json";
+    std::string text = index.dump(2) + "\n";
+    if (!commitFile(indexPath, text.data(), text.size())) {
+        errorMessage = "无法写入图集索引: " + indexPath;
+        return false;
+    }
+    return true;
+}
+
+} // namespace skia_renderer
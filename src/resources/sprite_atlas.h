@@ -0,0 +1,91 @@
+#pragma once
+
+#include "include/core/SkImage.h"
+#include "include/core/SkRect.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace skia_renderer {
+
+// 精灵图集 - 把一个项目里的小装饰图合成一张大图，旁边配一个JSON索引
+//
+// 索引（<name>.atlas.json）记录图集图片文件名、尺寸，以及每个精灵的原素材路径、在图集中的位置、
+// 原文件大小和修改时间。加载时整张图集只解码一次；原文件大小或修改时间变了的精灵视为过期，
+// 不再使用（该素材回退到按文件解码），其余精灵直接从图集取像素，不再逐个读文件和解码。
+// 每个精灵四周留kPadding像素，用边缘像素向外填充，线性/三次插值采样时不会混入相邻精灵。
+class SpriteAtlas {
+public:
+    // 精灵四周的填充像素数
+    static constexpr int kPadding = 2;
+
+    // 加载索引和图集图片，失败返回nullptr并设置errorMessage
+    static std::shared_ptr<SpriteAtlas> load(const std::string& indexPath, std::string* errorMessage);
+
+    // 查找素材在图集中的位置（不含填充）
+    bool find(const std::string& path, SkIRect* rect) const;
+
+    // 解码后的图集图片
+    const sk_sp<SkImage>& getImage() const { return image; }
+
+    // 可用的精灵数和因原文件变化而跳过的精灵数
+    size_t getSpriteCount() const { return sprites.size(); }
+    size_t getStaleCount() const { return staleCount; }
+
+    // 索引文件路径，以及索引、图集图片和可用精灵集合的内容哈希（图集内容变化时随之变化）
+    const std::string& getIndexPath() const { return indexPath; }
+    const std::string& getContentHash() const { return contentHash; }
+
+private:
+    sk_sp<SkImage> image;
+    std::map<std::string, SkIRect> sprites;
+    size_t staleCount = 0;
+    std::string indexPath;
+    std::string contentHash;
+};
+
+// 图集打包器 - 收集小图片，按高度排序后逐行（shelf）排布，写出图集PNG和索引
+class SpriteAtlasBuilder {
+public:
+    // maxSpriteSize：宽高都不超过它的图片才进入图集；maxAtlasSize：图集边长上限
+    explicit SpriteAtlasBuilder(int maxSpriteSize = 256, int maxAtlasSize = 2048);
+
+    // 添加图片，超过maxSpriteSize的跳过（返回true，计入跳过数），无法读取或解码时返回false
+    bool addFile(const std::string& path);
+
+    // 添加目录下的PNG/JPEG/WebP（不递归，跳过已有的*.atlas.png）
+    bool addDirectory(const std::string& directory);
+
+    // 打包并写出<basePath>.atlas.png和<basePath>.atlas.json；放不下的图片留在图集外，计入跳过数
+    bool write(const std::string& basePath);
+
+    size_t getPackedCount() const { return packedCount; }
+    size_t getSkippedCount() const { return skippedCount; }
+    SkISize getAtlasSize() const { return atlasSize; }
+
+    // 获取错误信息
+    const std::string& getErrorMessage() const { return errorMessage; }
+
+private:
+    struct PendingSprite {
+        std::string path;
+        sk_sp<SkImage> image;
+        long long fileSize = 0;
+        long long modifiedTime = 0;
+        SkIPoint position = SkIPoint::Make(-1, -1);
+    };
+
+    int maxSpriteSize;
+    int maxAtlasSize;
+    std::vector<PendingSprite> pending;
+    size_t packedCount = 0;
+    size_t skippedCount = 0;
+    SkISize atlasSize = SkISize::MakeEmpty();
+    std::string errorMessage;
+
+    // 以给定宽度逐行排布，返回所需高度；放不下的精灵位置为(-1,-1)
+    int pack(int width);
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,187 @@
+#include "resources/surface_pool.h"
+#include "include/core/SkPixmap.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace skia_renderer {
+
+namespace {
+
+// 默认最多保留256MB空闲像素内存
+constexpr size_t kDefaultMaxIdleBytes = 256 * 1024 * 1024;
+
+// 大页大小，缓冲区按此对齐以便内核使用透明大页
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+} // namespace
+
+SurfacePool& SurfacePool::shared() {
+    // 故意不析构：图像的释放回调可能在静态对象析构之后才执行
+    static SurfacePool* pool = new SurfacePool();
+    return *pool;
+}
+
+SurfacePool::SurfacePool() :
+    maxIdleBytes(kDefaultMaxIdleBytes) {
+}
+
+SurfacePool::~SurfacePool() {
+    trim();
+}
+
+sk_sp<SkSurface> SurfacePool::acquire(const SkImageInfo& info) {
+    if (info.isEmpty() || info.colorType() == kUnknown_SkColorType) {
+        return nullptr;
+    }
+    
+    Key key(info.width(), info.height(), info.colorType());
+    Buffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = idle.begin(); it != idle.end(); ++it) {
+            if ((*it)->key == key) {
+                buffer = *it;
+                idle.erase(it);
+                stats.idleBytes -= buffer->size;
+                ++stats.reused;
+                break;
+            }
+        }
+    }
+    
+    if (!buffer) {
+        buffer = allocateBuffer(key, info.minRowBytes());
+        if (!buffer) {
+            return nullptr;
+        }
+        buffer->pool = this;
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.allocated;
+    }
+    
+    buffer->refCount.store(1);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inUse[buffer->pixels] = buffer;
+        stats.inUseBytes += buffer->size;
+    }
+    
+    sk_sp<SkSurface> surface = SkSurfaces::WrapPixels(info, buffer->pixels, buffer->rowBytes,
+                                                      releaseSurfacePixels, buffer);
+    if (!surface) {
+        // 参数无效时Skia不会调用释放回调
+        unref(buffer);
+    }
+    return surface;
+}
+
+sk_sp<SkImage> SurfacePool::detachImage(const sk_sp<SkSurface>& surface) {
+    if (!surface) {
+        return nullptr;
+    }
+    
+    SkPixmap pixmap;
+    if (!surface->peekPixels(&pixmap)) {
+        return surface->makeImageSnapshot();
+    }
+    
+    Buffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = inUse.find(pixmap.addr());
+        if (it != inUse.end()) {
+            buffer = it->second;
+        }
+    }
+    if (!buffer) {
+        return surface->makeImageSnapshot();
+    }
+    
+    buffer->refCount.fetch_add(1);
+    sk_sp<SkImage> image = SkImages::RasterFromPixmap(pixmap, releaseImagePixels, buffer);
+    if (!image) {
+        unref(buffer);
+    }
+    return image;
+}
+
+void SurfacePool::setMaxIdleBytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxIdleBytes = bytes;
+    trimLocked(maxIdleBytes);
+}
+
+void SurfacePool::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    trimLocked(0);
+}
+
+SurfacePool::Stats SurfacePool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+SurfacePool::Buffer* SurfacePool::allocateBuffer(const Key& key, size_t rowBytes) {
+    size_t size = rowBytes * static_cast<size_t>(std::get<1>(key));
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignment = size >= kHugePageSize ? kHugePageSize : pageSize;
+    size = (size + alignment - 1) / alignment * alignment;
+    
+    void* pixels = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pixels == MAP_FAILED) {
+        return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    // 透明大页：一次缺页映射2MB，大幅减少长图的缺页次数和TLB压力
+    if (size >= kHugePageSize) {
+        madvise(pixels, size, MADV_HUGEPAGE);
+    }
+#endif
+    
+    Buffer* buffer = new Buffer();
+    buffer->key = key;
+    buffer->pixels = pixels;
+    buffer->rowBytes = rowBytes;
+    buffer->size = size;
+    return buffer;
+}
+
+void SurfacePool::freeBuffer(Buffer* buffer) {
+    munmap(buffer->pixels, buffer->size);
+    delete buffer;
+}
+
+void SurfacePool::unref(Buffer* buffer) {
+    if (buffer->refCount.fetch_sub(1) == 1) {
+        buffer->pool->recycle(buffer);
+    }
+}
+
+void SurfacePool::recycle(Buffer* buffer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    inUse.erase(buffer->pixels);
+    stats.inUseBytes -= buffer->size;
+    
+    idle.push_front(buffer);
+    stats.idleBytes += buffer->size;
+    trimLocked(maxIdleBytes);
+}
+
+void SurfacePool::trimLocked(size_t limit) {
+    while (!idle.empty() && stats.idleBytes > limit) {
+        Buffer* buffer = idle.back();
+        idle.pop_back();
+        stats.idleBytes -= buffer->size;
+        freeBuffer(buffer);
+    }
+}
+
+void SurfacePool::releaseSurfacePixels(void* /*pixels*/, void* context) {
+    unref(static_cast<Buffer*>(context));
+}
+
+void SurfacePool::releaseImagePixels(const void* /*pixels*/, void* context) {
+    unref(static_cast<Buffer*>(context));
+}
+
+} // namespace skia_renderer
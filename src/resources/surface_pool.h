@@ -0,0 +1,89 @@
+#pragma once
+
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkSurface.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace skia_renderer {
+
+// 光栅Surface池 - 按(宽, 高, 颜色类型)复用预先分配好的像素内存
+//
+// SkSurfaces::Raster每次都会分配、清零并在结束时释放整块像素内存（长图可达数十MB），
+// 大量缺页和清零开销出现在每一张海报上。池中的像素缓冲区用mmap分配（Linux上申请透明大页），
+// 归还后保留在空闲列表中供下一次同尺寸渲染直接使用。
+//
+// 注意：
+// - 复用的缓冲区内容未定义，调用方需要在绘制前清空画布（CanvasRenderer总会先绘制背景）
+// - 池中Surface的makeImageSnapshot会拷贝像素（Skia对外部像素的Surface总是拷贝），
+//   渲染结束时应使用detachImage零拷贝地取走像素，之后不能再向该Surface绘制
+// - 缓冲区同时被Surface和取走的图像引用，两者都释放后才回到池中
+class SurfacePool {
+public:
+    // 进程内共享的Surface池
+    static SurfacePool& shared();
+    
+    // 获取一个Surface，失败返回nullptr
+    sk_sp<SkSurface> acquire(const SkImageInfo& info);
+    
+    // 把池中Surface的像素直接包装为图像，不拷贝；不是池中的Surface时退化为makeImageSnapshot
+    sk_sp<SkImage> detachImage(const sk_sp<SkSurface>& surface);
+    
+    // 空闲缓冲区的内存上限，超出时释放最久未使用的缓冲区
+    void setMaxIdleBytes(size_t bytes);
+    
+    // 释放所有空闲缓冲区
+    void trim();
+    
+    // 统计信息
+    struct Stats {
+        uint64_t reused = 0;        // 命中空闲缓冲区的次数
+        uint64_t allocated = 0;     // 新分配缓冲区的次数
+        size_t idleBytes = 0;       // 空闲缓冲区占用的内存
+        size_t inUseBytes = 0;      // 正在使用的缓冲区占用的内存
+    };
+    Stats getStats() const;
+
+private:
+    using Key = std::tuple<int, int, SkColorType>;
+    
+    // 像素缓冲区，refCount为引用它的Surface和图像数量
+    struct Buffer {
+        SurfacePool* pool = nullptr;
+        Key key;
+        void* pixels = nullptr;
+        size_t rowBytes = 0;
+        size_t size = 0;
+        std::atomic<int> refCount{0};
+    };
+    
+    SurfacePool();
+    ~SurfacePool();
+    SurfacePool(const SurfacePool&) = delete;
+    SurfacePool& operator=(const SurfacePool&) = delete;
+    
+    mutable std::mutex mutex;
+    std::list<Buffer*> idle;                // 头部为最近归还
+    std::map<const void*, Buffer*> inUse;   // 按像素地址查找
+    size_t maxIdleBytes;
+    Stats stats;
+    
+    static Buffer* allocateBuffer(const Key& key, size_t rowBytes);
+    static void freeBuffer(Buffer* buffer);
+    
+    static void unref(Buffer* buffer);
+    void recycle(Buffer* buffer);
+    void trimLocked(size_t limit);
+    
+    // Skia释放回调
+    static void releaseSurfacePixels(void* pixels, void* context);
+    static void releaseImagePixels(const void* pixels, void* context);
+};
+
+} // namespace skia_renderer
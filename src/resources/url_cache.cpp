@@ -0,0 +1,369 @@
+#include "resources/url_cache.h"
+#include "utils/content_hash.h"
+#include "utils/temp_file.h"
+#include "utils/thread_pool.h"
+#include "3rdparty/json/include/nlohmann/json.hpp"
+#include "include/core/SkStream.h"
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <strings.h>
+
+#ifdef SKR_HAVE_CURL
+#include <curl/curl.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace skia_renderer {
+
+namespace {
+
+#ifdef SKR_HAVE_CURL
+size_t writeBody(char* data, size_t size, size_t count, void* userData) {
+    static_cast<SkDynamicMemoryWStream*>(userData)->write(data, size * count);
+    return size * count;
+}
+
+// 只取ETag头，重定向时以最后一个响应为准
+size_t readHeader(char* data, size_t size, size_t count, void* userData) {
+    size_t length = size * count;
+    const char kName[] = "etag:";
+    size_t nameLength = sizeof(kName) - 1;
+    if (length > nameLength && strncasecmp(data, kName, nameLength) == 0) {
+        std::string value(data + nameLength, length - nameLength);
+        size_t begin = value.find_first_not_of(" \t");
+        size_t end = value.find_last_not_of(" \t\r\n");
+        *static_cast<std::string*>(userData) = begin == std::string::npos ? "" : value.substr(begin, end - begin + 1);
+    }
+    return length;
+}
+#endif
+
+} // namespace
+
+bool DefaultUrlFetcher::fetch(const std::string& url, const std::string& etag, Response* response,
+                              std::string* errorMessage) {
+#ifdef SKR_HAVE_CURL
+    static const bool initialized = curl_global_init(CURL_GLOBAL_DEFAULT) == CURLE_OK;
+    CURL* curl = initialized ? curl_easy_init() : nullptr;
+    if (!curl) {
+        *errorMessage = "无法初始化libcurl";
+        return false;
+    }
+
+    SkDynamicMemoryWStream body;
+    std::string responseEtag;
+    struct curl_slist* headers = nullptr;
+    if (!etag.empty()) {
+        headers = curl_slist_append(headers, ("If-None-Match: " + etag).c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 120L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, readHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &responseEtag);
+
+    CURLcode code = curl_easy_perform(curl);
+    long status = 0;
+    curl_off_t contentLength = -1;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+
+    if (code != CURLE_OK) {
+        *errorMessage = curl_easy_strerror(code);
+        return false;
+    }
+    if (status == 304) {
+        response->notModified = true;
+        response->etag = responseEtag.empty() ? etag : responseEtag;
+        return true;
+    }
+    if (status != 200) {
+        *errorMessage = "HTTP " + std::to_string(status);
+        return false;
+    }
+    // 连接中断时libcurl不一定报错，按Content-Length校验是否完整
+    if (contentLength >= 0 && static_cast<size_t>(contentLength) != body.bytesWritten()) {
+        *errorMessage = "下载不完整: " + std::to_string(body.bytesWritten()) + "/" + std::to_string(contentLength) +
+                        "字节";
+        return false;
+    }
+    response->body = body.detachAsData();
+    response->etag = responseEtag;
+    return true;
+#else
+    (void)url;
+    (void)etag;
+    (void)response;
+    *errorMessage = "未编译libcurl支持，需要通过setUrlFetcher提供下载器";
+    return false;
+#endif
+}
+
+UrlCache::UrlCache(const std::string& directory, std::shared_ptr<UrlFetcher> fetcher) :
+    directory(directory),
+    fetcher(fetcher ? std::move(fetcher) : std::make_shared<DefaultUrlFetcher>()) {
+}
+
+std::shared_ptr<UrlCache> UrlCache::shared() {
+    static std::shared_ptr<UrlCache>* cache =
+        new std::shared_ptr<UrlCache>(std::make_shared<UrlCache>("cache/urls"));
+    return *cache;
+}
+
+void UrlCache::setFetcher(std::shared_ptr<UrlFetcher> urlFetcher) {
+    std::lock_guard<std::mutex> lock(mutex);
+    fetcher = urlFetcher ? std::move(urlFetcher) : std::make_shared<DefaultUrlFetcher>();
+}
+
+void UrlCache::setRevalidate(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    revalidate = enabled;
+}
+
+bool UrlCache::isUrl(const std::string& path) {
+    return strncasecmp(path.c_str(), "http://", 7) == 0 || strncasecmp(path.c_str(), "https://", 8) == 0;
+}
+
+bool UrlCache::resolve(const std::string& url, Entry* entry, std::string* errorMessage) {
+    std::shared_future<Result> pending;
+    std::promise<Result> promise;
+    std::shared_ptr<UrlFetcher> urlFetcher;
+    bool shouldRevalidate = false;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(url);
+        if (it != entries.end()) {
+            *entry = it->second;
+            return true;
+        }
+        auto running = inflight.find(url);
+        if (running != inflight.end()) {
+            pending = running->second;
+        } else {
+            pending = promise.get_future().share();
+            inflight[url] = pending;
+            urlFetcher = fetcher;
+            shouldRevalidate = revalidate;
+            leader = true;
+        }
+    }
+
+    // 第一个请求者负责获取，其他线程等待同一个结果
+    if (leader) {
+        Result result = fetchEntry(url, urlFetcher.get(), shouldRevalidate);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (result.ok) {
+                entries[url] = result.entry;
+            }
+            inflight.erase(url);
+        }
+        promise.set_value(result);
+    }
+
+    const Result& result = pending.get();
+    if (!result.ok) {
+        if (errorMessage) {
+            *errorMessage = result.errorMessage;
+        }
+        return false;
+    }
+    *entry = result.entry;
+    return true;
+}
+
+sk_sp<SkData> UrlCache::load(const std::string& url, std::string* errorMessage) {
+    Entry entry;
+    if (!resolve(url, &entry, errorMessage)) {
+        return nullptr;
+    }
+    sk_sp<SkData> data = SkData::MakeFromFileName(objectPath(entry.contentHash).c_str());
+    if (!data || static_cast<long long>(data->size()) != entry.size) {
+        // 内容文件在本进程使用期间被删除或修改，下次重新获取
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.erase(url);
+        if (errorMessage) {
+            *errorMessage = "缓存文件已失效: " + url;
+        }
+        return nullptr;
+    }
+    return data;
+}
+
+size_t UrlCache::prefetch(const std::vector<std::string>& urls) {
+    std::set<std::string> unique(urls.begin(), urls.end());
+    std::vector<std::string> pending(unique.begin(), unique.end());
+    std::vector<char> failed(pending.size(), 0);
+    ThreadPool::parallelFor(static_cast<int>(pending.size()), [&](int i) {
+        Entry entry;
+        failed[i] = !resolve(pending[i], &entry);
+    });
+
+    size_t failures = 0;
+    for (char value : failed) {
+        failures += value ? 1 : 0;
+    }
+    return failures;
+}
+
+UrlCache::Stats UrlCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+UrlCache::Result UrlCache::fetchEntry(const std::string& url, UrlFetcher* urlFetcher, bool shouldRevalidate) {
+    Result result;
+    Entry stored;
+    bool cached = readEntry(url, &stored);
+    if (cached) {
+        std::error_code ec;
+        uintmax_t size = fs::file_size(objectPath(stored.contentHash), ec);
+        cached = !ec && static_cast<long long>(size) == stored.size;
+    }
+    if (cached && !shouldRevalidate) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.diskHits;
+        result.ok = true;
+        result.entry = stored;
+        return result;
+    }
+
+    UrlFetcher::Response response;
+    std::string fetchError;
+    if (!urlFetcher->fetch(url, cached ? stored.etag : "", &response, &fetchError)) {
+        // 重新验证失败（例如离线）时沿用缓存
+        if (cached) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.diskHits;
+            result.ok = true;
+            result.entry = stored;
+            return result;
+        }
+        result.errorMessage = "无法下载 " + url + ": " + fetchError;
+        return result;
+    }
+    if (response.notModified && cached) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.revalidated;
+        result.ok = true;
+        result.entry = stored;
+        return result;
+    }
+    if (!response.body) {
+        result.errorMessage = "下载内容为空: " + url;
+        return result;
+    }
+
+    Entry entry;
+    entry.url = url;
+    entry.contentHash = ContentHash::hex(response.body->data(), response.body->size());
+    entry.etag = response.etag;
+    entry.size = static_cast<long long>(response.body->size());
+    if (!writeObject(entry.contentHash, response.body) || !writeEntry(entry)) {
+        result.errorMessage = "无法写入URL缓存: " + directory;
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++stats.downloads;
+    result.ok = true;
+    result.entry = entry;
+    return result;
+}
+
+bool UrlCache::readEntry(const std::string& url, Entry* entry) const {
+    std::ifstream file(entryPath(url));
+    if (!file.is_open()) {
+        return false;
+    }
+    json index = json::parse(file, nullptr, false);
+    // URL哈希冲突时按未缓存处理
+    if (index.is_discarded() || !index.is_object() || index.value("url", "") != url) {
+        return false;
+    }
+    entry->url = url;
+    entry->contentHash = index.value("hash", "");
+    entry->etag = index.value("etag", "");
+    entry->size = index.value("size", -1LL);
+    return !entry->contentHash.empty() && entry->size >= 0;
+}
+
+bool UrlCache::writeEntry(const Entry& entry) {
+    json index = {
+        {"url", entry.url},
+        {"hash", entry.contentHash},
+        {"etag", entry.etag},
+        {"size", entry.size},
+    };
+    std::string path = entryPath(entry.url);
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    std::string tempPath = TempFile::pathFor(path);
+    {
+        std::ofstream file(tempPath);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << index.dump() << std::endl;
+        if (!file.good()) {
+            file.close();
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    // 先写临时文件再改名，其他进程不会读到写了一半的索引
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool UrlCache::writeObject(const std::string& hash, const sk_sp<SkData>& data) {
+    std::string path = objectPath(hash);
+    std::error_code ec;
+    // 以内容命名，已存在且大小一致说明是同样的内容（可能来自另一个URL），不必再写
+    uintmax_t existingSize = fs::file_size(path, ec);
+    if (!ec && existingSize == data->size()) {
+        return true;
+    }
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    std::string tempPath = TempFile::pathFor(path);
+    {
+        SkFILEWStream stream(tempPath.c_str());
+        if (!stream.isValid() || !stream.write(data->data(), data->size())) {
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+std::string UrlCache::objectPath(const std::string& hash) const {
+    return (fs::path(directory) / "objects" / hash).string();
+}
+
+std::string UrlCache::entryPath(const std::string& url) const {
+    return (fs::path(directory) / "urls" / (ContentHash::hex(url.data(), url.size()) + ".json")).string();
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "include/core/SkData.h"
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace skia_renderer {
+
+// URL下载器 - 可替换：测试用本地替身，服务端可以接入自己的HTTP客户端。实现必须可以并发调用
+class UrlFetcher {
+public:
+    struct Response {
+        sk_sp<SkData> body;        // 下载到的内容
+        std::string etag;          // 服务器返回的ETag，没有时为空
+        bool notModified = false;  // 条件请求命中（304），此时body为空
+    };
+
+    virtual ~UrlFetcher() = default;
+
+    // 下载url；etag非空时作为If-None-Match发送。失败返回false并设置errorMessage
+    virtual bool fetch(const std::string& url, const std::string& etag, Response* response,
+                       std::string* errorMessage) = 0;
+};
+
+// 默认下载器：编译时找到libcurl（SKR_HAVE_CURL）时用libcurl下载http(s)，
+// 并校验Content-Length；否则所有请求都失败，需要通过setFetcher接入其他实现
+class DefaultUrlFetcher : public UrlFetcher {
+public:
+    bool fetch(const std::string& url, const std::string& etag, Response* response,
+               std::string* errorMessage) override;
+};
+
+// URL缓存 - 以内容寻址的磁盘缓存，http(s)图片下载一次后在进程间复用
+//
+// 目录结构：objects/<内容哈希> 存放内容（相同内容的不同URL只存一份），
+// urls/<URL哈希>.json 记录URL对应的内容哈希、大小和ETag。使用缓存前校验内容文件的大小，
+// 不一致（被截断或删除）时重新下载。默认已缓存的URL不再访问网络；开启重新验证后，
+// 每个URL在本进程首次使用时发送一次条件请求，304时沿用缓存，下载失败时也沿用缓存。
+// 同一URL的并发请求合并为一次下载，其余调用等待其结果。
+class UrlCache {
+public:
+    struct Entry {
+        std::string url;
+        std::string contentHash;  // 与结果缓存的文件哈希算法相同
+        std::string etag;
+        long long size = 0;
+    };
+
+    struct Stats {
+        size_t downloads = 0;     // 实际下载（含条件请求返回新内容）
+        size_t revalidated = 0;   // 条件请求返回304
+        size_t diskHits = 0;      // 直接使用磁盘缓存
+    };
+
+    // fetcher为nullptr时使用DefaultUrlFetcher；目录在首次写入时创建
+    explicit UrlCache(const std::string& directory, std::shared_ptr<UrlFetcher> fetcher = nullptr);
+
+    // 进程共享的缓存，目录为cache/urls（相对于工作目录）
+    static std::shared_ptr<UrlCache> shared();
+
+    // 替换下载器，nullptr恢复默认
+    void setFetcher(std::shared_ptr<UrlFetcher> fetcher);
+
+    // 复用磁盘缓存前是否先发送条件请求
+    void setRevalidate(bool enabled);
+
+    // 是否为http://或https:// URL
+    static bool isUrl(const std::string& path);
+
+    // 确保URL已在缓存中并返回其条目，失败时返回false并设置errorMessage
+    bool resolve(const std::string& url, Entry* entry, std::string* errorMessage = nullptr);
+
+    // 读取URL内容（映射缓存文件），失败时返回nullptr
+    sk_sp<SkData> load(const std::string& url, std::string* errorMessage = nullptr);
+
+    // 在线程池上并发获取多个URL（重复的只获取一次），返回失败的个数
+    size_t prefetch(const std::vector<std::string>& urls);
+
+    const std::string& getDirectory() const { return directory; }
+    Stats getStats() const;
+
+private:
+    struct Result {
+        bool ok = false;
+        Entry entry;
+        std::string errorMessage;
+    };
+
+    std::string directory;
+    bool revalidate = false;
+    std::shared_ptr<UrlFetcher> fetcher;
+
+    mutable std::mutex mutex;
+    std::map<std::string, Entry> entries;                          // 本进程已确认可用的URL
+    std::map<std::string, std::shared_future<Result>> inflight;    // 正在获取的URL
+    Stats stats;
+
+    // 实际的获取流程：读索引、校验、（条件）下载、写入内容和索引
+    Result fetchEntry(const std::string& url, UrlFetcher* urlFetcher, bool shouldRevalidate);
+
+    bool readEntry(const std::string& url, Entry* entry) const;
+    bool writeEntry(const Entry& entry);
+    bool writeObject(const std::string& hash, const sk_sp<SkData>& data);
+    std::string objectPath(const std::string& hash) const;
+    std::string entryPath(const std::string& url) const;
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,129 @@
+#include "utils/base64.h"
+#include "src/base/SkVx.h"
+#include <cstring>
+
+namespace skia_renderer {
+
+namespace {
+
+using U8x16 = skvx::Vec<16, uint8_t>;
+using U32x4 = skvx::Vec<4, uint32_t>;
+
+constexpr size_t kCharsPerBlock = 16;
+constexpr size_t kBytesPerBlock = 12;
+
+// 单个字符的6位值，空白返回-2，其他非法字符返回-1
+int sextet(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '+' || c == '-') {
+        return 62;
+    }
+    if (c == '/' || c == '_') {
+        return 63;
+    }
+    if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+        return -2;
+    }
+    return -1;
+}
+
+// 解码16个字符，块内全部是字母表字符时写出12字节并返回true
+bool decodeBlock(const char* in, uint8_t* out) {
+    U8x16 c = U8x16::Load(in);
+    auto upper = (c >= 'A') & (c <= 'Z');
+    auto lower = (c >= 'a') & (c <= 'z');
+    auto digit = (c >= '0') & (c <= '9');
+    auto plus = (c == '+') | (c == '-');
+    auto slash = (c == '/') | (c == '_');
+    if (!skvx::all(upper | lower | digit | plus | slash)) {
+        return false;
+    }
+
+    // 按字符类别加上各自的偏移，uint8按模256回绕
+    U8x16 offset = skvx::if_then_else(upper, U8x16(uint8_t(-'A')),
+                   skvx::if_then_else(lower, U8x16(uint8_t(26 - 'a')),
+                   skvx::if_then_else(digit, U8x16(uint8_t(52 - '0')), U8x16(0))));
+    U8x16 values = skvx::if_then_else(plus, U8x16(62),
+                   skvx::if_then_else(slash, U8x16(63), c + offset));
+
+    // 每4个6位值拼成24位：小端下第一个字符在最低字节
+    U32x4 words = sk_bit_cast<U32x4>(values);
+    U32x4 packed = ((words & 0x3Fu) << 18) | (((words >> 8) & 0x3Fu) << 12) |
+                   (((words >> 16) & 0x3Fu) << 6) | (words >> 24);
+    // 24位大端顺序输出，换成小端字节序后每个字的低3字节即为结果
+    U32x4 swapped = ((packed >> 16) & 0xFFu) | (packed & 0xFF00u) | ((packed & 0xFFu) << 16);
+    uint32_t lanes[4];
+    swapped.store(lanes);
+    for (int i = 0; i < 4; ++i) {
+        std::memcpy(out + i * 3, &lanes[i], 3);
+    }
+    return true;
+}
+
+} // namespace
+
+sk_sp<SkData> Base64::decode(const char* text, size_t length) {
+    if (!text) {
+        return nullptr;
+    }
+
+    // 按不含空白和填充的最大长度分配，多出的几个字节由返回的子区间截掉
+    sk_sp<SkData> buffer = SkData::MakeUninitialized(length / 4 * 3 + 3);
+    uint8_t* out = static_cast<uint8_t*>(buffer->writable_data());
+    size_t written = 0;
+    uint32_t accumulator = 0;
+    int pending = 0;
+    bool padding = false;
+
+    size_t i = 0;
+    while (i < length) {
+        // 没有未凑满4个的字符时才能按块解码
+        if (pending == 0 && !padding && i + kCharsPerBlock <= length && decodeBlock(text + i, out + written)) {
+            i += kCharsPerBlock;
+            written += kBytesPerBlock;
+            continue;
+        }
+
+        char c = text[i++];
+        int value = sextet(c);
+        if (value >= 0) {
+            if (padding) {
+                return nullptr;
+            }
+            accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+            if (++pending == 4) {
+                out[written++] = static_cast<uint8_t>(accumulator >> 16);
+                out[written++] = static_cast<uint8_t>(accumulator >> 8);
+                out[written++] = static_cast<uint8_t>(accumulator);
+                accumulator = 0;
+                pending = 0;
+            }
+        } else if (c == '=') {
+            padding = true;
+        } else if (value == -1) {
+            return nullptr;
+        }
+    }
+
+    // 末尾不足4个字符：2个字符得1字节，3个字符得2字节，1个字符不完整
+    if (pending == 1) {
+        return nullptr;
+    }
+    if (pending == 2) {
+        out[written++] = static_cast<uint8_t>(accumulator >> 4);
+    } else if (pending == 3) {
+        out[written++] = static_cast<uint8_t>(accumulator >> 10);
+        out[written++] = static_cast<uint8_t>(accumulator >> 2);
+    }
+    return SkData::MakeSubset(buffer.get(), 0, written);
+}
+
+} // namespace skia_renderer
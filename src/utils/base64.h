@@ -0,0 +1,17 @@
+#pragma once
+
+#include "include/core/SkData.h"
+#include <cstddef>
+
+namespace skia_renderer {
+
+// Base64解码 - 每次处理16个字符（输出12字节）：字符分类和6位值换算用SIMD完成，
+// 块内出现空白、填充或非法字符时该块退回逐字符解码。同时接受标准字母表（+/）和URL安全字母表（-_），
+// 忽略空白，末尾的=可有可无
+class Base64 {
+public:
+    // 解码失败（非法字符、长度不完整、填充后仍有数据）时返回nullptr
+    static sk_sp<SkData> decode(const char* text, size_t length);
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,26 @@
+#include "utils/content_hash.h"
+#include "src/core/SkChecksum.h"
+#include <cstdio>
+
+namespace skia_renderer {
+
+void ContentHash::compute(const void* data, size_t size, uint64_t hash[2]) {
+    hash[0] = SkChecksum::Hash64(data, size, 0x5eed0001u);
+    hash[1] = SkChecksum::Hash64(data, size, 0x5eed0002u);
+}
+
+std::string ContentHash::toHex(const uint64_t hash[2]) {
+    char hex[33];
+    std::snprintf(hex, sizeof(hex), "%016llx%016llx",
+                  static_cast<unsigned long long>(hash[0]),
+                  static_cast<unsigned long long>(hash[1]));
+    return hex;
+}
+
+std::string ContentHash::hex(const void* data, size_t size) {
+    uint64_t hash[2];
+    compute(data, size, hash);
+    return toHex(hash);
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace skia_renderer {
+
+// 内容哈希 - 两个不同种子的SkChecksum::Hash64组成128位哈希，十六进制表示为32个字符。
+// 结果缓存、资源包、内存图片和URL缓存都用它标识文件内容，同一份数据在各处得到相同的哈希
+class ContentHash {
+public:
+    // 计算128位哈希
+    static void compute(const void* data, size_t size, uint64_t hash[2]);
+
+    // 128位哈希的十六进制表示
+    static std::string toHex(const uint64_t hash[2]);
+
+    // 计算并返回十六进制表示
+    static std::string hex(const void* data, size_t size);
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,176 @@
+#include "utils/image_diff.h"
+#include "src/base/SkVx.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace skia_renderer {
+
+namespace {
+
+// 每次处理4个像素（16个通道）
+constexpr int kPixelsPerVector = 4;
+
+using U8x16 = skvx::Vec<16, uint8_t>;
+using U16x16 = skvx::Vec<16, uint16_t>;
+using U32x16 = skvx::Vec<16, uint32_t>;
+using U32x4 = skvx::Vec<4, uint32_t>;
+
+// 每累加这么多次255^2就把U32累加器转存到64位，避免大图单行溢出
+constexpr int kFlushInterval = 1 << 16;
+
+// 差异像素标红：按小端字节序拼出RGBA/BGRA中不透明的红色
+uint32_t diffMarkerColor(SkColorType colorType) {
+    return colorType == kBGRA_8888_SkColorType ? 0xFFFF0000u : 0xFF0000FFu;
+}
+
+// 相同像素淡化为原色的1/4叠加浅灰，突出差异区域
+uint32_t fadePixel(uint32_t pixel) {
+    return (((pixel >> 2) & 0x3F3F3F3Fu) + 0xC0C0C0C0u) | 0xFF000000u;
+}
+
+uint64_t sumLanes(const U32x16& v) {
+    uint64_t total = 0;
+    for (int i = 0; i < 16; ++i) {
+        total += v[i];
+    }
+    return total;
+}
+
+struct RowStats {
+    int64_t differentPixels = 0;
+    uint64_t squaredError = 0;
+    int maxChannelDelta = 0;
+};
+
+// 比较一行像素，diffRow非空时写出差异图的对应行
+RowStats compareRow(const uint32_t* rowA, const uint32_t* rowB, uint32_t* diffRow, int width,
+                    uint32_t marker) {
+    RowStats stats;
+    U8x16 maxDelta(0);
+    U32x16 squared(0);
+    U32x4 differentCount(0);
+    
+    int x = 0;
+    int accumulated = 0;
+    for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+        U8x16 a = U8x16::Load(rowA + x);
+        U8x16 b = U8x16::Load(rowB + x);
+        U8x16 delta = skvx::max(a, b) - skvx::min(a, b);
+        maxDelta = skvx::max(maxDelta, delta);
+        
+        U16x16 wide = skvx::cast<uint16_t>(delta);
+        squared += skvx::cast<uint32_t>(wide * wide);
+        if (++accumulated == kFlushInterval) {
+            stats.squaredError += sumLanes(squared);
+            squared = U32x16(0);
+            accumulated = 0;
+        }
+        
+        // 4个通道任一不为0即为差异像素，掩码全1相当于-1
+        auto different = sk_bit_cast<U32x4>(delta) != U32x4(0);
+        differentCount -= sk_bit_cast<U32x4>(different);
+        
+        if (diffRow) {
+            U32x4 pixelsA = U32x4::Load(rowA + x);
+            U32x4 faded = (((pixelsA >> 2) & 0x3F3F3F3Fu) + 0xC0C0C0C0u) | 0xFF000000u;
+            skvx::if_then_else(different, U32x4(marker), faded).store(diffRow + x);
+        }
+    }
+    
+    stats.maxChannelDelta = skvx::max(maxDelta);
+    stats.differentPixels = differentCount[0] + differentCount[1] + differentCount[2] + differentCount[3];
+    stats.squaredError += sumLanes(squared);
+    
+    // 行尾不足4个像素的部分
+    for (; x < width; ++x) {
+        const uint8_t* a = reinterpret_cast<const uint8_t*>(rowA + x);
+        const uint8_t* b = reinterpret_cast<const uint8_t*>(rowB + x);
+        bool different = false;
+        for (int c = 0; c < 4; ++c) {
+            int delta = std::abs(a[c] - b[c]);
+            stats.maxChannelDelta = std::max(stats.maxChannelDelta, delta);
+            stats.squaredError += static_cast<uint64_t>(delta * delta);
+            different |= delta != 0;
+        }
+        if (different) {
+            ++stats.differentPixels;
+        }
+        if (diffRow) {
+            diffRow[x] = different ? marker : fadePixel(rowA[x]);
+        }
+    }
+    return stats;
+}
+
+} // namespace
+
+bool ImageDiff::compare(const SkPixmap& a, const SkPixmap& b, ImageDiffResult* result,
+                        const SkPixmap* diff) {
+    if (!result || a.width() != b.width() || a.height() != b.height() ||
+        a.colorType() != b.colorType() || a.info().bytesPerPixel() != 4 ||
+        !a.addr() || !b.addr()) {
+        return false;
+    }
+    if (diff && (diff->width() != a.width() || diff->height() != a.height() ||
+                 diff->colorType() != a.colorType() || !diff->writable_addr())) {
+        return false;
+    }
+    
+    uint32_t marker = diffMarkerColor(a.colorType());
+    *result = ImageDiffResult();
+    result->totalPixels = static_cast<int64_t>(a.width()) * a.height();
+    
+    uint64_t squaredError = 0;
+    int top = -1;
+    int bottom = -1;
+    int left = a.width();
+    int right = -1;
+    
+    for (int y = 0; y < a.height(); ++y) {
+        const uint32_t* rowA = a.addr32(0, y);
+        const uint32_t* rowB = b.addr32(0, y);
+        uint32_t* diffRow = diff ? diff->writable_addr32(0, y) : nullptr;
+        
+        // 完全相同的行直接跳过统计
+        if (!diffRow && std::memcmp(rowA, rowB, a.width() * sizeof(uint32_t)) == 0) {
+            continue;
+        }
+        
+        RowStats stats = compareRow(rowA, rowB, diffRow, a.width(), marker);
+        if (stats.differentPixels == 0) {
+            continue;
+        }
+        
+        result->differentPixels += stats.differentPixels;
+        result->maxChannelDelta = std::max(result->maxChannelDelta, stats.maxChannelDelta);
+        squaredError += stats.squaredError;
+        
+        // 差异行的左右边界只需从两端各扫描到第一个差异像素
+        int first = 0;
+        while (rowA[first] == rowB[first]) {
+            ++first;
+        }
+        int last = a.width() - 1;
+        while (rowA[last] == rowB[last]) {
+            --last;
+        }
+        left = std::min(left, first);
+        right = std::max(right, last);
+        if (top < 0) {
+            top = y;
+        }
+        bottom = y;
+    }
+    
+    if (result->differentPixels > 0) {
+        result->diffBounds = SkIRect::MakeLTRB(left, top, right + 1, bottom + 1);
+        double mse = static_cast<double>(squaredError) / (result->totalPixels * 4);
+        result->psnr = 10.0 * std::log10(255.0 * 255.0 / mse);
+    } else {
+        result->psnr = std::numeric_limits<double>::infinity();
+    }
+    return true;
+}
+
+} // namespace skia_renderer
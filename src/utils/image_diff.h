@@ -0,0 +1,32 @@
+#pragma once
+
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
+#include <cstdint>
+
+namespace skia_renderer {
+
+// 图像差异统计
+struct ImageDiffResult {
+    int64_t totalPixels = 0;                        // 像素总数
+    int64_t differentPixels = 0;                    // 任一通道不同的像素数
+    int maxChannelDelta = 0;                        // 最大单通道差值 (0-255)
+    double psnr = 0.0;                              // 峰值信噪比(dB)，完全一致时为无穷大
+    SkIRect diffBounds = SkIRect::MakeEmpty();      // 所有差异像素的包围盒
+    
+    // 差异像素占比
+    double differentRatio() const {
+        return totalPixels > 0 ? static_cast<double>(differentPixels) / totalPixels : 0.0;
+    }
+};
+
+// 图像对比 - 直接在原始像素上按SIMD向量逐行比较，不经过逐像素的getColor
+class ImageDiff {
+public:
+    // 比较两张尺寸相同、颜色类型相同的4字节像素图（RGBA/BGRA）
+    // diff非空时同时生成差异图：差异像素为红色，相同像素淡化显示，diff须与输入同尺寸同类型
+    static bool compare(const SkPixmap& a, const SkPixmap& b, ImageDiffResult* result,
+                        const SkPixmap* diff = nullptr);
+};
+
+} // namespace skia_renderer
@@ -0,0 +1,89 @@
+#include "utils/picture_capture.h"
+#include "resources/font_manager.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkTypeface.h"
+#include "include/encode/SkPngEncoder.h"
+
+namespace skia_renderer {
+
+namespace {
+
+// 优先嵌入图片的原始编码数据，没有时（如光栅图像）编码为PNG
+sk_sp<SkData> serializeImage(SkImage* image, void*) {
+    if (sk_sp<SkData> encoded = image->refEncodedData()) {
+        return encoded;
+    }
+    return SkPngEncoder::Encode(nullptr, image, {});
+}
+
+// 字体总是连同字体文件数据一起嵌入
+sk_sp<SkData> serializeTypeface(SkTypeface* typeface, void*) {
+    return typeface->serialize(SkTypeface::SerializeBehavior::kDoIncludeData);
+}
+
+sk_sp<SkImage> deserializeImage(const void* data, size_t length, void*) {
+    return SkImages::DeferredFromEncodedData(SkData::MakeWithCopy(data, length));
+}
+
+sk_sp<SkTypeface> deserializeTypeface(const void* data, size_t length, void* context) {
+    SkMemoryStream stream(data, length, false);
+    return SkTypeface::MakeDeserialize(&stream, sk_ref_sp(static_cast<SkFontMgr*>(context)));
+}
+
+SkSerialProcs makeSerialProcs() {
+    SkSerialProcs procs;
+    procs.fImageProc = serializeImage;
+    procs.fTypefaceProc = serializeTypeface;
+    return procs;
+}
+
+} // namespace
+
+bool PictureCapture::serialize(const SkPicture* picture, SkWStream* stream) {
+    if (!stream) {
+        return false;
+    }
+    // SkPicture::serialize(SkWStream*)不报告写入失败，先序列化到内存再写，结果以写入是否成功为准
+    sk_sp<SkData> data = serialize(picture);
+    return data && stream->write(data->data(), data->size());
+}
+
+sk_sp<SkData> PictureCapture::serialize(const SkPicture* picture) {
+    if (!picture) {
+        return nullptr;
+    }
+    SkSerialProcs procs = makeSerialProcs();
+    return picture->serialize(&procs);
+}
+
+sk_sp<SkPicture> PictureCapture::deserialize(const sk_sp<SkData>& data) {
+    if (!data) {
+        return nullptr;
+    }
+    
+    // 嵌入的字体数据需要能从内存创建字体的字体管理器
+    sk_sp<SkFontMgr> fontMgr = FontManager::platformFontMgr();
+    
+    SkDeserialProcs procs;
+    procs.fImageProc = deserializeImage;
+    procs.fTypefaceProc = deserializeTypeface;
+    procs.fTypefaceCtx = fontMgr.get();
+    return SkPicture::MakeFromData(data.get(), &procs);
+}
+
+sk_sp<SkPicture> PictureCapture::loadFromFile(const std::string& path) {
+    return deserialize(SkData::MakeFromFileName(path.c_str()));
+}
+
+std::string PictureCapture::captureName(const std::string& outputFilename) {
+    size_t slash = outputFilename.find_last_of('/');
+    size_t dot = outputFilename.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return outputFilename + ".skp";
+    }
+    return outputFilename.substr(0, dot) + ".skp";
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "include/core/SkData.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkStream.h"
+#include <string>
+
+namespace skia_renderer {
+
+// SkPicture捕获 - 把完整的绘制命令流序列化为自包含的.skp
+// 图片以编码数据（原始编码或PNG）嵌入，字体连同字体文件数据一起嵌入，
+// 离线回放不需要原始素材和字体，可以在本地精确复现线上的绘制负载
+class PictureCapture {
+public:
+    // 序列化到流
+    static bool serialize(const SkPicture* picture, SkWStream* stream);
+    
+    // 序列化为内存数据，失败返回nullptr
+    static sk_sp<SkData> serialize(const SkPicture* picture);
+    
+    // 从.skp数据恢复，失败返回nullptr
+    static sk_sp<SkPicture> deserialize(const sk_sp<SkData>& data);
+    
+    // 从.skp文件恢复，失败返回nullptr
+    static sk_sp<SkPicture> loadFromFile(const std::string& path);
+    
+    // 由输出文件名得到捕获文件名，如 poster.png -> poster.skp
+    static std::string captureName(const std::string& outputFilename);
+};
+
+} // namespace skia_renderer
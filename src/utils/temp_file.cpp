@@ -0,0 +1,42 @@
+#include "utils/temp_file.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace skia_renderer {
+
+std::string TempFile::pathFor(const std::string& path) {
+    static std::atomic<unsigned> counter{0};
+    return path + ".tmp" + std::to_string(static_cast<long long>(getpid())) + "-" +
+           std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "-" +
+           std::to_string(counter++);
+}
+
+size_t TempFile::removeStale(const std::string& directory, long long maxAgeSeconds) {
+    size_t removed = 0;
+    std::error_code ec;
+    auto now = fs::file_time_type::clock::now();
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (name.find(".tmp") == std::string::npos || !it->is_regular_file(ec)) {
+            continue;
+        }
+        std::error_code timeError;
+        auto modified = fs::last_write_time(it->path(), timeError);
+        if (timeError || now - modified < std::chrono::seconds(maxAgeSeconds)) {
+            continue;
+        }
+        std::error_code removeError;
+        if (fs::remove(it->path(), removeError)) {
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+} // namespace skia_renderer
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+namespace skia_renderer {
+
+// 临时文件 - 缓存和索引文件都先写到临时文件再改名，读者不会看到写了一半的文件。
+// 同一进程的多个线程、多个实例以及多个进程可能同时写同一个文件，临时文件名由进程号、线程和计数器区分
+class TempFile {
+public:
+    // 目标文件旁的临时文件名：<path>.tmp<进程号>-<线程>-<序号>
+    static std::string pathFor(const std::string& path);
+
+    // 删除目录（不递归）中修改时间早于maxAgeSeconds的临时文件，返回删除的个数。
+    // 写入进程崩溃时临时文件会留下，只删旧的以免删掉其他进程正在写的文件
+    static size_t removeStale(const std::string& directory, long long maxAgeSeconds = 3600);
+};
+
+} // namespace skia_renderer
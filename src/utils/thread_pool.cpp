@@ -0,0 +1,34 @@
+#include "utils/thread_pool.h"
+#include "src/core/SkTaskGroup.h"
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+namespace skia_renderer {
+
+SkExecutor& ThreadPool::shared() {
+    // 函数内静态变量，C++11起初始化是线程安全的
+    static std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(threadCount());
+    return *executor;
+}
+
+int ThreadPool::threadCount() {
+    static const int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    return count;
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& task) {
+    if (count <= 0) {
+        return;
+    }
+    if (count == 1) {
+        task(0);
+        return;
+    }
+    
+    SkTaskGroup group(shared());
+    group.batch(count, task);
+    group.wait();
+}
+
+} // namespace skia_renderer
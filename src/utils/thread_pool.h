@@ -0,0 +1,23 @@
+#pragma once
+
+#include "include/core/SkExecutor.h"
+#include <functional>
+
+namespace skia_renderer {
+
+// 进程内共享的线程池 - 基于SkExecutor，首次使用时按CPU核数创建
+// 编码、解码、分块光栅化等并行任务都提交到这里，避免各模块各自创建线程
+class ThreadPool {
+public:
+    // 获取共享线程池
+    static SkExecutor& shared();
+    
+    // 线程池的线程数
+    static int threadCount();
+    
+    // 并行执行count个任务（参数为0..count-1），阻塞直到全部完成
+    // 等待期间调用线程也会参与执行，因此可以在池内线程中嵌套调用
+    static void parallelFor(int count, const std::function<void(int)>& task);
+};
+
+} // namespace skia_renderer
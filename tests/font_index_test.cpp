@@ -0,0 +1,142 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "resources/font_index.h"
+#include "resources/font_manager.h"
+
+using namespace skia_renderer;
+
+namespace fs = std::filesystem;
+
+// 字体索引测试：res/Fonts复制到临时目录后扫描，检查name表/OS/2表解析结果；
+// 第二次扫描全部来自索引文件，修改时间变化的文件重新解析，删除的文件从索引中移除；
+// 按中英文家族名（不区分大小写）查找，FontManager首次使用时才创建字体并缓存
+class FontIndexTest {
+private:
+    int passed = 0;
+    int failed = 0;
+
+    void check(bool ok, const std::string& message) {
+        if (ok) {
+            ++passed;
+            std::cout << "✅ " << message << std::endl;
+        } else {
+            ++failed;
+            std::cout << "❌ " << message << std::endl;
+        }
+    }
+
+    static size_t copyFonts(const std::string& from, const fs::path& to) {
+        size_t count = 0;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(from, ec)) {
+            if (entry.is_regular_file() && fs::copy_file(entry.path(), to / entry.path().filename(), ec)) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+public:
+    int run() {
+        fs::path root = fs::temp_directory_path() / "font_index_test";
+        fs::path fontDirectory = root / "fonts";
+        std::string indexPath = (root / "index.json").string();
+        std::error_code ec;
+        fs::remove_all(root, ec);
+        fs::create_directories(fontDirectory, ec);
+        size_t fontCount = copyFonts("res/Fonts", fontDirectory);
+        if (fontCount == 0) {
+            std::cout << "⚠️  跳过字体索引测试: res/Fonts下没有字体" << std::endl;
+            return 0;
+        }
+        // 扩展名是字体但内容不是，记录为空，之后不再解析
+        std::ofstream(fontDirectory / "broken.ttf") << "not a font";
+
+        std::cout << "🧪 字体索引测试" << std::endl;
+        {
+            FontIndex index(indexPath);
+            check(index.addDirectory(fontDirectory.string()) && index.getParsedCount() == fontCount + 1,
+                  "首次扫描解析了全部" + std::to_string(fontCount + 1) + "个文件");
+            FontIndex::Face face;
+            bool found = index.find("站酷快乐体2016修订版", SkFontStyle::Normal(), &face);
+            check(found && face.family == "HappyZcool-2016" && face.weight == SkFontStyle::kNormal_Weight &&
+                  !face.italic, "按中文家族名找到字体，首选家族名为英文，字重400");
+            check(index.find("happyzcool-2016", SkFontStyle::Bold(), &face), "家族名查找不区分大小写");
+            check(!index.find("不存在的字体", SkFontStyle::Normal(), &face), "不存在的字体查找失败");
+        }
+
+        std::vector<FontIndex::Face> faces;
+        {
+            FontIndex index(indexPath);
+            index.addDirectory(fontDirectory.string());
+            faces = index.getFaces();
+            check(index.getParsedCount() == 0 && faces.size() >= fontCount,
+                  "再次扫描全部来自索引文件，没有解析字体");
+        }
+
+        {
+            fs::path touched = faces.front().path;
+            fs::last_write_time(touched, fs::last_write_time(touched) + std::chrono::hours(1), ec);
+            fs::remove(fontDirectory / "broken.ttf", ec);
+            FontIndex index(indexPath);
+            index.addDirectory(fontDirectory.string());
+            check(index.getParsedCount() == 1, "修改时间变化的文件重新解析，其余沿用索引");
+        }
+
+        {
+            FontIndex index(indexPath);
+            index.addDirectory(fontDirectory.string());
+            std::ifstream file(indexPath);
+            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            check(index.getParsedCount() == 0 && content.find("broken.ttf") == std::string::npos,
+                  "已删除的文件从索引中移除");
+        }
+
+        {
+            // 同一进程内的多个实例同时写同一个索引文件，临时文件互不覆盖，留下的索引完整可用
+            fs::remove(indexPath, ec);
+            std::vector<std::thread> threads;
+            for (int i = 0; i < 4; ++i) {
+                threads.emplace_back([&]() {
+                    FontIndex index(indexPath);
+                    index.addDirectory(fontDirectory.string());
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            FontIndex index(indexPath);
+            index.addDirectory(fontDirectory.string());
+            size_t leftovers = 0;
+            for (const auto& entry : fs::directory_iterator(root, ec)) {
+                leftovers += entry.path().filename().string().find(".tmp") != std::string::npos;
+            }
+            check(index.getParsedCount() == 0 && leftovers == 0, "多个实例并发保存索引，没有残留的临时文件");
+        }
+
+        std::cout << "\n🧪 字体延迟加载测试" << std::endl;
+        {
+            FontManager fontManager({fontDirectory.string()}, indexPath);
+            const FontIndex::Face& face = faces.front();
+            sk_sp<SkTypeface> first = fontManager.loadFont(face.family);
+            sk_sp<SkTypeface> second = fontManager.loadFont(face.family);
+            check(first && first == second, "首次使用时创建字体，之后复用同一个对象");
+            check(fontManager.getFontFilePath(face.family) == face.path, "字体文件路径来自索引");
+        }
+
+        fs::remove_all(root, ec);
+        std::cout << "\n📊 通过: " << passed << "  失败: " << failed << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+};
+
+int main() {
+    FontIndexTest test;
+    return test.run();
+}
@@ -0,0 +1,629 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkSurface.h"
+#include "include/encode/SkJpegEncoder.h"
+#include "include/encode/SkPngEncoder.h"
+
+#include "engine/render_engine.h"
+#include "parsers/protocol_parser.h"
+#include "renderers/image_renderer.h"
+#include "resources/asset_bundle.h"
+#include "resources/image_cache.h"
+#include "resources/image_decoder.h"
+#include "resources/image_source.h"
+#include "resources/sprite_atlas.h"
+#include "resources/url_cache.h"
+#include "utils/image_diff.h"
+#include "utils/thread_pool.h"
+
+using namespace skia_renderer;
+
+// 本地HTTP替身：http://assets.test/<路径> 返回本地文件，ETag固定；
+// 每次请求稍作停顿，让并发请求有机会重叠，以检查同一URL只下载一次
+class LocalFetcher : public UrlFetcher {
+public:
+    static constexpr const char* kPrefix = "http://assets.test/";
+
+    std::atomic<int> requests{0};
+
+    bool fetch(const std::string& url, const std::string& etag, Response* response,
+               std::string* errorMessage) override {
+        ++requests;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        if (etag == kEtag) {
+            response->notModified = true;
+            response->etag = etag;
+            return true;
+        }
+        std::string path = url.substr(std::string(kPrefix).size());
+        response->body = SkData::MakeFromFileName(path.c_str());
+        if (!response->body) {
+            *errorMessage = "404";
+            return false;
+        }
+        response->etag = kEtag;
+        return true;
+    }
+
+private:
+    static constexpr const char* kEtag = "\"v1\"";
+};
+
+// 区域解码一致性测试：projects/*/resources下的每个素材分别整张解码和按区域解码，
+// 区域结果必须与整图中对应位置的像素逐字节一致；另外检查解码预算的降采样与拒绝，
+// 素材打包成资源包后数据和元数据与原文件一致，data: URI、注册的内存数据、http(s)和file:// URL
+// 与文件渲染结果一致，URL缓存合并并发下载且跨实例不重复下载，
+// 以及装饰图打成精灵图集后用drawAtlas合批绘制的结果与逐个绘制一致；
+// 采样策略的协议字段、auto的选择和mipmap金字塔的缓存；不透明图像走kSrc绘制的结果与src-over一致
+class ImageDecodeTest {
+private:
+    int passed = 0;
+    int failed = 0;
+
+    void check(bool ok, const std::string& message) {
+        if (ok) {
+            ++passed;
+            std::cout << "✅ " << message << std::endl;
+        } else {
+            ++failed;
+            std::cout << "❌ " << message << std::endl;
+        }
+    }
+
+    static std::vector<std::string> findAssets() {
+        std::vector<std::string> files;
+        std::error_code ec;
+        for (const auto& project : std::filesystem::directory_iterator("projects", ec)) {
+            std::filesystem::path resources = project.path() / "resources";
+            if (!std::filesystem::is_directory(resources, ec)) {
+                continue;
+            }
+            for (const auto& entry : std::filesystem::directory_iterator(resources, ec)) {
+                if (entry.is_regular_file()) {
+                    files.push_back(entry.path().string());
+                }
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    // 只有一张图片、按原尺寸铺满画布的协议，path可以是文件、data: URI、注册名或URL
+    static sk_sp<SkImage> renderImage(RenderEngine& engine, const std::string& path, const SkISize& size) {
+        RenderProtocol protocol;
+        protocol.canvas.width = size.width();
+        protocol.canvas.height = size.height();
+        ImageElement image;
+        image.path = path;
+        image.width = size.width();
+        image.height = size.height();
+        protocol.images = {image};
+        return engine.renderToImage(protocol);
+    }
+
+    // 覆盖不对齐的左上角、贴边区域和单行区域
+    static std::vector<SkIRect> testRegions(const SkISize& size) {
+        int w = size.width();
+        int h = size.height();
+        return {
+            SkIRect::MakeLTRB(w / 4 + 1, h / 4 + 1, w * 3 / 4, h * 3 / 4),
+            SkIRect::MakeLTRB(0, h / 2, w, h),
+            SkIRect::MakeLTRB(w / 3, 0, w, h / 5 + 1),
+            SkIRect::MakeXYWH(w / 2, h / 2, std::max(1, w / 7), 1),
+        };
+    }
+
+    void testAsset(const std::string& file) {
+        sk_sp<SkData> data = SkData::MakeFromFileName(file.c_str());
+        SkISize dimensions;
+        if (!data || !ImageDecoder::readDimensions(data, &dimensions)) {
+            std::cout << "⚠️  跳过 " << file << ": 不是可解码的图片" << std::endl;
+            return;
+        }
+
+        SkIRect fullRegion;
+        sk_sp<SkImage> full = ImageDecoder::decode(data, SkIRect::MakeEmpty(), &fullRegion);
+        SkPixmap fullPixels;
+        if (!full || !full->peekPixels(&fullPixels) || full->dimensions() != dimensions) {
+            check(false, file + " 整张解码失败");
+            return;
+        }
+
+        for (const SkIRect& region : testRegions(dimensions)) {
+            if (region.isEmpty()) {
+                continue;
+            }
+            SkIRect decodedRegion;
+            sk_sp<SkImage> partial = ImageDecoder::decode(data, region, &decodedRegion);
+            SkPixmap partialPixels;
+            SkPixmap expected;
+            ImageDiffResult result;
+            bool ok = partial && partial->peekPixels(&partialPixels) &&
+                      decodedRegion.contains(region) &&
+                      partial->dimensions() == decodedRegion.size() &&
+                      fullPixels.extractSubset(&expected, decodedRegion) &&
+                      ImageDiff::compare(expected, partialPixels, &result) &&
+                      result.differentPixels == 0;
+            check(ok, file + " 区域(" + std::to_string(region.left()) + "," + std::to_string(region.top()) + "," +
+                      std::to_string(region.width()) + "x" + std::to_string(region.height()) + ") 与整张解码一致");
+        }
+    }
+
+    // 单张预算只够缩小显示的素材：原尺寸显示必须拒绝，缩小到1/8显示必须降采样成功；总量超出单次预算必须拒绝
+    void testBudget(const std::string& file) {
+        const size_t kMegabyte = 1024 * 1024;
+        sk_sp<SkData> data = SkData::MakeFromFileName(file.c_str());
+        SkISize dimensions;
+        if (!data || !ImageDecoder::readDimensions(data, &dimensions)) {
+            std::cout << "⚠️  跳过解码预算测试: 无法读取 " << file << std::endl;
+            return;
+        }
+        size_t fullBytes = static_cast<size_t>(dimensions.width()) * dimensions.height() * 4;
+
+        struct BudgetCase {
+            const char* name;
+            int divisor;            // 显示尺寸 = 原图尺寸 / divisor
+            size_t maxImageBytes;
+            size_t maxRenderBytes;
+            bool expectSuccess;
+        };
+        const BudgetCase cases[] = {
+            {"原尺寸显示超出单张预算", 1, fullBytes / 4, 1024 * kMegabyte, false},
+            {"1/8显示降采样到预算内", 8, fullBytes / 4, 1024 * kMegabyte, true},
+            {"超出单次渲染预算", 1, 1024 * kMegabyte, fullBytes / 2, false},
+        };
+
+        for (const auto& budgetCase : cases) {
+            RenderProtocol protocol;
+            protocol.canvas.width = std::max(1, dimensions.width() / budgetCase.divisor);
+            protocol.canvas.height = std::max(1, dimensions.height() / budgetCase.divisor);
+            ImageElement image;
+            image.path = file;
+            image.width = protocol.canvas.width;
+            image.height = protocol.canvas.height;
+            protocol.images = {image};
+
+            // 已缓存的解码结果不计入预算，每个用例从空缓存开始
+            ImageCache::shared().purge();
+            RenderEngine engine;
+            engine.setDecodeBudget(budgetCase.maxImageBytes, budgetCase.maxRenderBytes);
+            bool success = engine.renderToImage(protocol) != nullptr;
+            std::string detail = success == budgetCase.expectSuccess
+                                     ? (success ? "" : " (" + engine.getErrorMessage() + ")")
+                                     : (success ? " 应当失败" : " 应当成功");
+            check(success == budgetCase.expectSuccess && (success || !engine.getErrorMessage().empty()),
+                  budgetCase.name + detail);
+        }
+        ImageCache::shared().purge();
+    }
+
+    // 打包所有素材后重新映射：每个素材的数据与原文件逐字节相同，预先计算的尺寸与文件头一致
+    void testBundle(const std::vector<std::string>& files) {
+        std::string bundlePath = (std::filesystem::temp_directory_path() / "image_decode_test.bundle").string();
+        AssetBundleWriter writer;
+        for (const auto& file : files) {
+            if (!writer.addFile("./" + file, file)) {
+                std::cout << "⚠️  跳过 " << file << ": " << writer.getErrorMessage() << std::endl;
+            }
+        }
+        std::string error;
+        std::shared_ptr<AssetBundle> bundle;
+        if (!writer.write(bundlePath) || !(bundle = AssetBundle::open(bundlePath, &error))) {
+            check(false, "资源包写入或打开失败: " + writer.getErrorMessage() + error);
+            return;
+        }
+        
+        for (const auto& file : files) {
+            AssetBundle::Entry entry;
+            if (!bundle->find(file, &entry)) {
+                continue;
+            }
+            sk_sp<SkData> original = SkData::MakeFromFileName(file.c_str());
+            sk_sp<SkData> packed = bundle->getData(file);
+            SkISize dimensions;
+            bool ok = original && packed && original->equals(packed.get()) &&
+                      (entry.kind != AssetBundle::Kind::Image ||
+                       (ImageDecoder::readDimensions(original, &dimensions) &&
+                        dimensions == SkISize::Make(entry.width, entry.height)));
+            check(ok, file + " 资源包中的数据和尺寸与原文件一致");
+        }
+        check(!bundle->find("projects/__missing__.png"), "资源包找不到不存在的路径");
+        std::error_code ec;
+        std::filesystem::remove(bundlePath, ec);
+    }
+
+    // 测试用的base64编码，每76个字符换行（检验解码时跳过空白）
+    static std::string encodeBase64(const SkData& data) {
+        static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        const uint8_t* bytes = data.bytes();
+        std::string text;
+        for (size_t i = 0; i < data.size(); i += 3) {
+            uint32_t group = bytes[i] << 16;
+            group |= i + 1 < data.size() ? bytes[i + 1] << 8 : 0;
+            group |= i + 2 < data.size() ? bytes[i + 2] : 0;
+            text += kAlphabet[(group >> 18) & 0x3F];
+            text += kAlphabet[(group >> 12) & 0x3F];
+            text += i + 1 < data.size() ? kAlphabet[(group >> 6) & 0x3F] : '=';
+            text += i + 2 < data.size() ? kAlphabet[group & 0x3F] : '=';
+            if (text.size() % 77 == 76) {
+                text += '\n';
+            }
+        }
+        return text;
+    }
+    
+    // 同一素材分别以文件路径、data: URI和注册的内存数据引用，渲染结果必须逐像素相同
+    void testInlineSources(const std::string& file) {
+        sk_sp<SkData> data = SkData::MakeFromFileName(file.c_str());
+        SkISize dimensions;
+        if (!data || !ImageDecoder::readDimensions(data, &dimensions)) {
+            std::cout << "⚠️  跳过内存图片测试: 无法读取 " << file << std::endl;
+            return;
+        }
+        
+        std::string uri = "data:image/png;base64," + encodeBase64(*data);
+        sk_sp<SkData> decoded = ImageSource::decodeDataUri(uri);
+        check(decoded && decoded->equals(data.get()), "data: URI解码与原文件一致");
+        
+        RenderEngine engine;
+        engine.registerImageData("memory/poster.png", data);
+        sk_sp<SkImage> expected = renderImage(engine, file, dimensions);
+        SkPixmap expectedPixels;
+        if (!expected || !expected->peekPixels(&expectedPixels)) {
+            check(false, file + " 渲染失败");
+            return;
+        }
+        const std::pair<const char*, std::string> sources[] = {
+            {"data: URI", uri},
+            {"注册的内存数据", "memory/poster.png"},
+        };
+        for (const auto& source : sources) {
+            sk_sp<SkImage> actual = renderImage(engine, source.second, dimensions);
+            SkPixmap actualPixels;
+            ImageDiffResult result;
+            check(actual && actual->peekPixels(&actualPixels) &&
+                  ImageDiff::compare(expectedPixels, actualPixels, &result) && result.differentPixels == 0,
+                  std::string(source.first) + " 渲染结果与文件一致");
+        }
+    }
+
+    // 用本地HTTP替身检查URL缓存：并发的同一URL只下载一次，新实例复用磁盘缓存不再请求，
+    // 重新验证时304沿用缓存，内容文件被截断后重新下载；http和file:// URL的渲染结果与文件一致
+    void testUrlSources(const std::string& file) {
+        namespace fs = std::filesystem;
+        sk_sp<SkData> data = SkData::MakeFromFileName(file.c_str());
+        SkISize dimensions;
+        if (!data || !ImageDecoder::readDimensions(data, &dimensions)) {
+            std::cout << "⚠️  跳过URL测试: 无法读取 " << file << std::endl;
+            return;
+        }
+        
+        std::string directory = (fs::temp_directory_path() / "image_decode_test_urls").string();
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+        std::string url = std::string(LocalFetcher::kPrefix) + file;
+        auto fetcher = std::make_shared<LocalFetcher>();
+        
+        auto cache = std::make_shared<UrlCache>(directory, fetcher);
+        ThreadPool::parallelFor(8, [&](int) {
+            UrlCache::Entry entry;
+            cache->resolve(url, &entry);
+        });
+        check(fetcher->requests == 1 && cache->getStats().downloads == 1, "8个并发请求合并为1次下载 (实际" +
+              std::to_string(fetcher->requests.load()) + "次)");
+        sk_sp<SkData> cached = cache->load(url);
+        check(cached && cached->equals(data.get()), "缓存内容与原文件一致");
+        
+        auto reopened = std::make_shared<UrlCache>(directory, fetcher);
+        UrlCache::Entry entry;
+        check(reopened->resolve(url, &entry) && fetcher->requests == 1 && reopened->getStats().diskHits == 1,
+              "新的缓存实例直接使用磁盘缓存，不再下载");
+        
+        UrlCache revalidating(directory, fetcher);
+        revalidating.setRevalidate(true);
+        check(revalidating.resolve(url, &entry) && fetcher->requests == 2 &&
+              revalidating.getStats().revalidated == 1 && revalidating.getStats().downloads == 0,
+              "重新验证返回304时沿用缓存");
+        
+        fs::resize_file(fs::path(directory) / "objects" / entry.contentHash, data->size() / 2, ec);
+        UrlCache truncated(directory, fetcher);
+        sk_sp<SkData> refetched = truncated.load(url);
+        check(refetched && refetched->equals(data.get()) && truncated.getStats().downloads == 1,
+              "内容文件大小不一致时重新下载");
+        
+        RenderEngine engine;
+        engine.setUrlCache(reopened);
+        sk_sp<SkImage> expected = renderImage(engine, file, dimensions);
+        SkPixmap expectedPixels;
+        if (!expected || !expected->peekPixels(&expectedPixels)) {
+            check(false, file + " 渲染失败");
+            fs::remove_all(directory, ec);
+            return;
+        }
+        const std::pair<const char*, std::string> sources[] = {
+            {"http URL", url},
+            {"file:// URL", "file://" + fs::absolute(file).generic_string()},
+        };
+        for (const auto& source : sources) {
+            sk_sp<SkImage> actual = renderImage(engine, source.second, dimensions);
+            SkPixmap actualPixels;
+            ImageDiffResult result;
+            check(actual && actual->peekPixels(&actualPixels) &&
+                  ImageDiff::compare(expectedPixels, actualPixels, &result) && result.differentPixels == 0,
+                  std::string(source.first) + " 渲染结果与文件一致");
+        }
+        
+        fs::remove_all(directory, ec);
+    }
+
+    // 把项目的小装饰图打成图集，分别用图集和原文件渲染同一协议；
+    // drawAtlas的透明度经kModulate相乘，与paint alpha允许1级舍入差
+    void testSpriteAtlas(const std::string& resources, const std::string& protocolFile) {
+        std::string basePath = (std::filesystem::temp_directory_path() / "image_decode_test").string();
+        SpriteAtlasBuilder builder;
+        if (!builder.addDirectory(resources) || !builder.write(basePath) || builder.getPackedCount() == 0) {
+            check(false, "图集打包失败: " + builder.getErrorMessage());
+            return;
+        }
+        
+        ProtocolParser parser;
+        if (!parser.loadFromFile(protocolFile)) {
+            std::cout << "⚠️  跳过图集测试: " << parser.getErrorMessage() << std::endl;
+            return;
+        }
+        RenderEngine plainEngine;
+        RenderEngine atlasEngine;
+        if (!atlasEngine.loadSpriteAtlas(basePath + ".atlas.json")) {
+            check(false, "图集加载失败: " + atlasEngine.getErrorMessage());
+            return;
+        }
+        
+        sk_sp<SkImage> expected = plainEngine.renderToImage(parser.getProtocol());
+        sk_sp<SkImage> actual = atlasEngine.renderToImage(parser.getProtocol());
+        SkPixmap expectedPixels;
+        SkPixmap actualPixels;
+        ImageDiffResult result;
+        bool ok = expected && actual && expected->peekPixels(&expectedPixels) && actual->peekPixels(&actualPixels) &&
+                  ImageDiff::compare(expectedPixels, actualPixels, &result) && result.maxChannelDelta <= 1;
+        check(ok, "图集(" + std::to_string(builder.getPackedCount()) + "个精灵, " +
+                      std::to_string(builder.getAtlasSize().width()) + "x" +
+                      std::to_string(builder.getAtlasSize().height()) + ") 渲染结果与逐个绘制一致 (最大通道差" +
+                      std::to_string(result.maxChannelDelta) + ")");
+        
+        std::error_code ec;
+        std::filesystem::remove(basePath + ".atlas.png", ec);
+        std::filesystem::remove(basePath + ".atlas.json", ec);
+    }
+
+    // 协议字段解析；auto按实际缩放比例选择采样方式；mipmap元素的金字塔随整图缓存，
+    // 同一素材部分移出画布（可见区域不是整图）时，画布内的像素与可见整图时完全相同
+    void testSampling(const std::string& file) {
+        sk_sp<SkData> data = SkData::MakeFromFileName(file.c_str());
+        SkISize size;
+        if (!data || !ImageDecoder::readDimensions(data, &size) || size.width() < 64 || size.height() < 64) {
+            std::cout << "⚠️  跳过采样测试: 无法读取 " << file << std::endl;
+            return;
+        }
+        
+        ProtocolParser parser;
+        bool parsed = parser.loadFromString(R"({
+            "canvas": {"width": 100, "height": 100, "imageSampling": "auto"},
+            "images": [
+                {"path": "a.png", "width": 10, "height": 10, "sampling": "mipmap"},
+                {"path": "b.png", "width": 10, "height": 10, "sampling": "cubic"},
+                {"path": "c.png", "width": 10, "height": 10}
+            ]
+        })");
+        const RenderProtocol& parsedProtocol = parser.getProtocol();
+        check(parsed && parsedProtocol.canvas.imageSampling == ImageSampling::Auto &&
+              parsedProtocol.images.size() == 3 && parsedProtocol.images[0].sampling == ImageSampling::Mipmap &&
+              parsedProtocol.images[1].sampling == ImageSampling::Cubic &&
+              parsedProtocol.images[2].sampling == ImageSampling::Inherit,
+              "协议中的imageSampling和元素sampling解析正确，未指定时跟随画布");
+        
+        auto resolve = [&](float x, int width, int height, ImageSampling sampling) {
+            ImageElement element;
+            element.transform.x = x;
+            element.transform.y = 20.0f;
+            element.width = width;
+            element.height = height;
+            element.sampling = sampling;
+            return ImageRenderer::resolveSampling(element, ImageSampling::Auto, size);
+        };
+        int w = size.width();
+        int h = size.height();
+        check(resolve(10.0f, w, h, ImageSampling::Inherit) == ImageSampling::Nearest &&
+              resolve(10.5f, w, h, ImageSampling::Inherit) == ImageSampling::Linear &&
+              resolve(10.0f, w / 4, h / 4, ImageSampling::Inherit) == ImageSampling::Mipmap &&
+              resolve(10.0f, w * 2, h * 2, ImageSampling::Inherit) == ImageSampling::Cubic &&
+              resolve(10.0f, w / 4, h / 4, ImageSampling::Linear) == ImageSampling::Linear,
+              "auto: 1:1对齐用最近邻，非整数偏移用双线性，缩小到1/4用mipmap，放大用三次插值，元素设置优先");
+        
+        // 缩小到1/4绘制，元素左上部分在画布外；对照组在右下角再画一个很小的同一素材，可见区域是整图
+        int elementWidth = w / 4;
+        int elementHeight = h / 4;
+        RenderProtocol protocol;
+        protocol.canvas.width = elementWidth / 2;
+        protocol.canvas.height = elementHeight / 2;
+        protocol.canvas.imageSampling = ImageSampling::Mipmap;
+        ImageElement element;
+        element.path = file;
+        element.width = elementWidth;
+        element.height = elementHeight;
+        element.transform.x = -static_cast<float>(elementWidth / 2 - 3);
+        element.transform.y = -static_cast<float>(elementHeight / 2 - 5);
+        protocol.images = {element};
+        RenderProtocol fullProtocol = protocol;
+        ImageElement thumbnail = element;
+        thumbnail.width = 8;
+        thumbnail.height = 8;
+        thumbnail.transform.x = static_cast<float>(protocol.canvas.width - 8);
+        thumbnail.transform.y = static_cast<float>(protocol.canvas.height - 8);
+        fullProtocol.images.push_back(thumbnail);
+        
+        ImageCache::shared().purge();
+        RenderEngine engine;
+        sk_sp<SkImage> cropped = engine.renderToImage(protocol);
+        sk_sp<SkImage> cached = ImageCache::shared().find(ImageSource().cacheKey(file));
+        check(cached && cached->hasMipmaps() && cached->dimensions() == size,
+              "部分可见的mipmap元素解码整张图，金字塔随解码结果进入缓存");
+        
+        ImageCache::Stats before = ImageCache::shared().getStats();
+        sk_sp<SkImage> full = engine.renderToImage(fullProtocol);
+        ImageCache::Stats after = ImageCache::shared().getStats();
+        check(after.misses == before.misses && after.hits > before.hits, "再次渲染同一素材复用缓存的金字塔");
+        
+        SkPixmap croppedPixels;
+        SkPixmap fullPixels;
+        ImageDiffResult result;
+        SkIRect compared = SkIRect::MakeWH(protocol.canvas.width, protocol.canvas.height - 8);
+        bool same = cropped && full && cropped->peekPixels(&croppedPixels) && full->peekPixels(&fullPixels) &&
+                    croppedPixels.extractSubset(&croppedPixels, compared) &&
+                    fullPixels.extractSubset(&fullPixels, compared) &&
+                    ImageDiff::compare(croppedPixels, fullPixels, &result) && result.differentPixels == 0;
+        check(same, "部分移出画布的mipmap元素与可见区域为整图时的像素一致");
+    }
+
+    // 不透明图像（JPEG，以及alpha全为0xFF的RGBA PNG）在轴对齐绘制时改用kSrc，
+    // 对1:1对齐、缩放、非整数偏移的放置和双线性/三次插值，渲染结果都必须与直接用src-over绘制的逐像素一致
+    void testOpaqueBlit(const std::string& file) {
+        SkBitmap source;
+        sk_sp<SkData> data = SkData::MakeFromFileName(file.c_str());
+        SkIRect decodedRegion;
+        sk_sp<SkImage> decoded = data ? ImageDecoder::decode(data, SkIRect::MakeEmpty(), &decodedRegion) : nullptr;
+        if (!decoded || !source.tryAllocPixels(SkImageInfo::Make(decoded->dimensions(), kRGBA_8888_SkColorType,
+                                                                 kUnpremul_SkAlphaType)) ||
+            !decoded->readPixels(source.pixmap(), 0, 0)) {
+            std::cout << "⚠️  跳过不透明绘制测试: 无法解码 " << file << std::endl;
+            return;
+        }
+        // alpha全部置为0xFF，但仍按RGBA（带alpha通道）编码
+        for (int y = 0; y < source.height(); ++y) {
+            uint8_t* row = static_cast<uint8_t*>(source.getAddr(0, y));
+            for (int x = 0; x < source.width(); ++x) {
+                row[x * 4 + 3] = 0xFF;
+            }
+        }
+        SkDynamicMemoryWStream png;
+        SkDynamicMemoryWStream jpeg;
+        if (!SkPngEncoder::Encode(&png, source.pixmap(), {}) || !SkJpegEncoder::Encode(&jpeg, source.pixmap(), {})) {
+            check(false, "不透明测试图编码失败");
+            return;
+        }
+        const std::pair<std::string, sk_sp<SkData>> assets[] = {
+            {"memory/opaque.png", png.detachAsData()},
+            {"memory/opaque.jpg", jpeg.detachAsData()},
+        };
+        
+        RenderEngine engine;
+        SkISize size = source.dimensions();
+        for (const auto& asset : assets) {
+            engine.registerImageData(asset.first, asset.second);
+            sk_sp<SkImage> image = ImageDecoder::decode(asset.second, SkIRect::MakeEmpty(), &decodedRegion);
+            check(image && image->isOpaque(), asset.first + " 解码结果标记为不透明");
+            if (!image) {
+                continue;
+            }
+            
+            struct Placement {
+                const char* name;
+                float x, y;
+                int width, height;
+            };
+            const Placement placements[] = {
+                {"1:1对齐", 7.0f, 9.0f, size.width(), size.height()},
+                {"缩放", 7.0f, 9.0f, size.width() * 3 / 5, size.height() * 3 / 5},
+                {"非整数偏移", 7.5f, 9.25f, size.width(), size.height()},
+            };
+            const std::pair<const char*, ImageSampling> samplings[] = {
+                {"双线性", ImageSampling::Linear},
+                {"三次插值", ImageSampling::Cubic},
+            };
+            for (const auto& placement : placements) {
+                for (const auto& sampling : samplings) {
+                    RenderProtocol protocol;
+                    protocol.canvas.width = size.width() + 20;
+                    protocol.canvas.height = size.height() + 20;
+                    protocol.canvas.background = "#336699";
+                    ImageElement element;
+                    element.path = asset.first;
+                    element.transform.x = placement.x;
+                    element.transform.y = placement.y;
+                    element.width = placement.width;
+                    element.height = placement.height;
+                    element.sampling = sampling.second;
+                    protocol.images = {element};
+                    sk_sp<SkImage> actual = engine.renderToImage(protocol);
+                    
+                    // 对照：同样的变换和采样，用默认的src-over绘制
+                    sk_sp<SkSurface> surface = actual ? SkSurfaces::Raster(actual->imageInfo()) : nullptr;
+                    SkPixmap actualPixels;
+                    SkPixmap expectedPixels;
+                    ImageDiffResult result;
+                    bool same = false;
+                    if (surface) {
+                        SkCanvas* canvas = surface->getCanvas();
+                        canvas->clear(SkColorSetRGB(0x33, 0x66, 0x99));
+                        canvas->translate(placement.x, placement.y);
+                        canvas->drawImageRect(image, SkRect::MakeWH(placement.width, placement.height),
+                                              ImageRenderer::samplingOptions(sampling.second), nullptr);
+                        same = actual->peekPixels(&actualPixels) && surface->peekPixels(&expectedPixels) &&
+                               ImageDiff::compare(expectedPixels, actualPixels, &result) &&
+                               result.differentPixels == 0;
+                    }
+                    check(same, asset.first + " " + placement.name + " " + sampling.first + " 与src-over结果一致");
+                }
+            }
+        }
+    }
+
+public:
+    int run() {
+        std::cout << "🧪 区域解码一致性测试" << std::endl;
+        std::vector<std::string> files = findAssets();
+        for (const auto& file : files) {
+            testAsset(file);
+        }
+        
+        std::cout << "\n🧪 资源包测试" << std::endl;
+        testBundle(files);
+
+        std::cout << "\n🧪 解码预算测试" << std::endl;
+        testBudget("projects/food/resources/food_bg_1.png");
+        
+        std::cout << "\n🧪 内存图片测试" << std::endl;
+        testInlineSources("projects/tshirt/resources/1750068131805_d01a88a738.png");
+        
+        std::cout << "\n🧪 URL图片测试" << std::endl;
+        testUrlSources("projects/tshirt/resources/1750068131805_d01a88a738.png");
+        
+        std::cout << "\n🧪 精灵图集测试" << std::endl;
+        testSpriteAtlas("projects/long/resources", "projects/long/long_protocol.json");
+        
+        std::cout << "\n🧪 采样策略测试" << std::endl;
+        testSampling("projects/tshirt/resources/1750068131805_d01a88a738.png");
+        
+        std::cout << "\n🧪 不透明绘制测试" << std::endl;
+        testOpaqueBlit("projects/tshirt/resources/1750068131805_d01a88a738.png");
+        std::cout << "\n📊 通过: " << passed << "  失败: " << failed << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+};
+
+int main() {
+    ImageDecodeTest test;
+    return test.run();
+}
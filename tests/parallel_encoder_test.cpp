@@ -0,0 +1,208 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <cstring>
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkStream.h"
+#include "include/codec/SkCodec.h"
+#include "include/encode/SkJpegEncoder.h"
+#include "include/encode/SkPngEncoder.h"
+
+#include "output/parallel_encoder.h"
+
+namespace fs = std::filesystem;
+using skia_renderer::ParallelEncoder;
+
+// 并行编码一致性测试：
+// - PNG：Skia串行编码与并行编码解码后的像素必须逐字节一致
+// - JPEG：相同质量和色度采样下，Skia串行编码与并行编码（1个和多个条带）解码后的像素必须逐字节一致
+// - 像素带色彩空间时，并行编码写入的色彩信息解码后与Skia编码器的一致
+class ParallelEncoderTest {
+private:
+    std::string baselineDir = "tests/baseline/";
+    int passed = 0;
+    int failed = 0;
+
+    // 把编码数据解码为RGBA非预乘像素
+    static bool decodeToRgba(sk_sp<SkData> data, SkBitmap* bitmap) {
+        // 只比较像素，忽略编码数据中的色彩空间
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(std::move(data));
+        if (!codec) {
+            return false;
+        }
+        SkImageInfo info = codec->getInfo().makeColorType(kRGBA_8888_SkColorType)
+                                           .makeAlphaType(kUnpremul_SkAlphaType)
+                                           .makeColorSpace(nullptr);
+        if (!bitmap->tryAllocPixels(info)) {
+            return false;
+        }
+        return codec->getPixels(info, bitmap->getPixels(), bitmap->rowBytes()) == SkCodec::kSuccess;
+    }
+
+    static bool samePixels(const SkBitmap& a, const SkBitmap& b) {
+        if (a.width() != b.width() || a.height() != b.height()) {
+            return false;
+        }
+        size_t rowBytes = a.width() * 4;
+        for (int y = 0; y < a.height(); ++y) {
+            if (std::memcmp(a.getAddr32(0, y), b.getAddr32(0, y), rowBytes) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void report(const std::string& name, bool ok) {
+        if (ok) {
+            ++passed;
+            std::cout << "✅ " << name << std::endl;
+        } else {
+            ++failed;
+            std::cout << "❌ " << name << std::endl;
+        }
+    }
+
+    void testPng(const std::string& name, const SkPixmap& pixmap) {
+        SkDynamicMemoryWStream serial;
+        SkDynamicMemoryWStream parallel;
+        bool ok = SkPngEncoder::Encode(&serial, pixmap, {}) &&
+                  ParallelEncoder::encodePng(&parallel, pixmap, 6, SkPngEncoder::FilterFlag::kAll, 4);
+
+        SkBitmap expected, actual;
+        ok = ok && decodeToRgba(serial.detachAsData(), &expected)
+                && decodeToRgba(parallel.detachAsData(), &actual)
+                && samePixels(expected, actual);
+        report("PNG " + name, ok);
+    }
+
+    void testJpeg(const std::string& name, const SkPixmap& pixmap) {
+        const SkJpegEncoder::Downsample modes[] = {
+            SkJpegEncoder::Downsample::k420,
+            SkJpegEncoder::Downsample::k422,
+            SkJpegEncoder::Downsample::k444,
+        };
+        const char* modeNames[] = {"420", "422", "444"};
+
+        for (int i = 0; i < 3; ++i) {
+            SkJpegEncoder::Options options;
+            options.fQuality = 90;
+            options.fDownsample = modes[i];
+            SkDynamicMemoryWStream serial;
+            SkBitmap expected;
+            bool ok = SkJpegEncoder::Encode(&serial, pixmap, options) &&
+                      decodeToRgba(serial.detachAsData(), &expected);
+
+            for (int stripCount : {1, 5}) {
+                SkDynamicMemoryWStream parallel;
+                SkBitmap actual;
+                ok = ok && ParallelEncoder::encodeJpeg(&parallel, pixmap, 90, modes[i], stripCount)
+                        && decodeToRgba(parallel.detachAsData(), &actual)
+                        && samePixels(expected, actual);
+            }
+            report(std::string("JPEG ") + modeNames[i] + " " + name, ok);
+        }
+    }
+
+    static sk_sp<SkColorSpace> decodedColorSpace(sk_sp<SkData> data) {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(std::move(data));
+        return codec ? codec->getInfo().refColorSpace() : nullptr;
+    }
+
+    // sRGB和非sRGB色彩空间：并行编码的PNG/JPEG解码出的色彩空间与Skia编码器的相同
+    void testColorSpace(const SkBitmap& bitmap) {
+        struct Case {
+            const char* name;
+            sk_sp<SkColorSpace> colorSpace;
+        };
+        const Case cases[] = {
+            {"sRGB", SkColorSpace::MakeSRGB()},
+            {"Display P3", SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB, SkNamedGamut::kDisplayP3)},
+        };
+        for (const auto& item : cases) {
+            SkPixmap pixmap;
+            if (!bitmap.peekPixels(&pixmap)) {
+                report(std::string("色彩空间 ") + item.name, false);
+                continue;
+            }
+            pixmap.setColorSpace(item.colorSpace);
+
+            SkDynamicMemoryWStream serialPng, parallelPng, serialJpeg, parallelJpeg;
+            bool ok = SkPngEncoder::Encode(&serialPng, pixmap, {}) &&
+                      ParallelEncoder::encodePng(&parallelPng, pixmap, 6, SkPngEncoder::FilterFlag::kAll, 4) &&
+                      SkJpegEncoder::Encode(&serialJpeg, pixmap, {}) &&
+                      ParallelEncoder::encodeJpeg(&parallelJpeg, pixmap, 100, SkJpegEncoder::Downsample::k420, 5);
+            sk_sp<SkColorSpace> expectedPng = decodedColorSpace(serialPng.detachAsData());
+            sk_sp<SkColorSpace> actualPng = decodedColorSpace(parallelPng.detachAsData());
+            sk_sp<SkColorSpace> expectedJpeg = decodedColorSpace(serialJpeg.detachAsData());
+            sk_sp<SkColorSpace> actualJpeg = decodedColorSpace(parallelJpeg.detachAsData());
+            ok = ok && actualPng && actualJpeg
+                    && SkColorSpace::Equals(expectedPng.get(), actualPng.get())
+                    && SkColorSpace::Equals(expectedJpeg.get(), actualJpeg.get())
+                    && SkColorSpace::Equals(item.colorSpace.get(), actualPng.get());
+            report(std::string("色彩空间 ") + item.name, ok);
+        }
+    }
+
+    void testBitmap(const std::string& name, const SkBitmap& bitmap) {
+        SkPixmap pixmap;
+        if (!bitmap.peekPixels(&pixmap) || !ParallelEncoder::supportsPixmap(pixmap)) {
+            report("像素格式 " + name, false);
+            return;
+        }
+        testPng(name, pixmap);
+        testJpeg(name, pixmap);
+    }
+
+    // 生成带半透明渐变的测试图，覆盖alpha通道和非MCU对齐的尺寸
+    static SkBitmap makeSyntheticImage() {
+        SkBitmap bitmap;
+        bitmap.allocPixels(SkImageInfo::Make(333, 517, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType));
+        for (int y = 0; y < bitmap.height(); ++y) {
+            uint8_t* row = static_cast<uint8_t*>(bitmap.getAddr(0, y));
+            for (int x = 0; x < bitmap.width(); ++x) {
+                row[x * 4 + 0] = static_cast<uint8_t>(x * 255 / bitmap.width());
+                row[x * 4 + 1] = static_cast<uint8_t>(y * 255 / bitmap.height());
+                row[x * 4 + 2] = static_cast<uint8_t>((x ^ y) & 0xFF);
+                row[x * 4 + 3] = static_cast<uint8_t>(((x + y) % 64) * 4);
+            }
+        }
+        return bitmap;
+    }
+
+public:
+    int run() {
+        std::cout << "🧪 并行编码一致性测试" << std::endl;
+
+        SkBitmap synthetic = makeSyntheticImage();
+        testBitmap("synthetic", synthetic);
+        testColorSpace(synthetic);
+
+        if (fs::exists(baselineDir)) {
+            for (const auto& entry : fs::directory_iterator(baselineDir)) {
+                if (entry.path().extension() != ".png") {
+                    continue;
+                }
+                SkBitmap bitmap;
+                if (!decodeToRgba(SkData::MakeFromFileName(entry.path().c_str()), &bitmap)) {
+                    report("解码 " + entry.path().filename().string(), false);
+                    continue;
+                }
+                testBitmap(entry.path().filename().string(), bitmap);
+            }
+        }
+
+        std::cout << "\n📊 通过: " << passed << "  失败: " << failed << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+};
+
+int main() {
+    ParallelEncoderTest test;
+    return test.run();
+}
@@ -0,0 +1,219 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/core/SkData.h"
+
+#include "engine/result_cache.h"
+#include "utils/temp_file.h"
+
+using namespace skia_renderer;
+
+namespace fs = std::filesystem;
+
+// 结果缓存测试：写入后查找返回相同的字节；素材文件只改修改时间时键不变，内容变化或引擎设置变化时键改变；
+// 按总字节数和条目数淘汰最久未使用的条目；截断的条目被拒绝并删除；重建索引时清理过期的临时文件
+class ResultCacheTest {
+private:
+    int passed = 0;
+    int failed = 0;
+
+    void check(bool ok, const std::string& message) {
+        if (ok) {
+            ++passed;
+            std::cout << "✅ " << message << std::endl;
+        } else {
+            ++failed;
+            std::cout << "❌ " << message << std::endl;
+        }
+    }
+
+    // 指定大小、按字节填充的输出数据
+    static sk_sp<SkData> makeOutput(size_t size, uint8_t seed) {
+        sk_sp<SkData> data = SkData::MakeUninitialized(size);
+        uint8_t* bytes = static_cast<uint8_t*>(data->writable_data());
+        for (size_t i = 0; i < size; ++i) {
+            bytes[i] = static_cast<uint8_t>(seed + i * 31);
+        }
+        return data;
+    }
+
+    static void writeFile(const fs::path& path, const std::string& content) {
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    // 只有一张图片的协议，缓存键取决于该文件的内容
+    static RenderProtocol imageProtocol(const std::string& path) {
+        RenderProtocol protocol;
+        protocol.canvas.width = 64;
+        protocol.canvas.height = 64;
+        ImageElement image;
+        image.path = path;
+        image.width = 64;
+        image.height = 64;
+        protocol.images = {image};
+        OutputConfig output;
+        output.filename = "output/result_cache_test.png";
+        protocol.outputs = {output};
+        return protocol;
+    }
+
+    void testStoreLookup(const fs::path& directory) {
+        ResultCache cache(directory.string());
+        std::vector<sk_sp<SkData>> outputs = {makeOutput(1000, 1), makeOutput(37, 2), makeOutput(0, 3)};
+        check(cache.store("roundtrip", outputs), "写入包含3个输出（含空输出）的条目");
+
+        std::vector<sk_sp<SkData>> cached;
+        bool found = cache.lookup("roundtrip", outputs.size(), &cached);
+        bool same = found && cached.size() == outputs.size();
+        for (size_t i = 0; same && i < outputs.size(); ++i) {
+            same = cached[i] && cached[i]->equals(outputs[i].get());
+        }
+        check(same, "查找返回的每个输出与写入的字节完全相同");
+        check(!cache.lookup("missing", 1, &cached), "不存在的键不命中");
+
+        ResultCache reopened(directory.string());
+        check(reopened.getStats().entryCount == 1 && reopened.lookup("roundtrip", outputs.size(), &cached),
+              "新实例从目录重建索引后仍能命中");
+
+        // 输出个数已计入缓存键，个数不一致只能是条目损坏
+        check(!reopened.lookup("roundtrip", outputs.size() + 1, &cached) && reopened.getStats().entryCount == 0,
+              "输出个数与协议不一致时不命中并删除条目");
+    }
+
+    void testKey(const fs::path& directory) {
+        ResultCache cache(directory.string());
+        fs::path asset = directory / "asset.png";
+        writeFile(asset, "first version of the asset");
+        RenderProtocol protocol = imageProtocol(asset.string());
+
+        std::string original;
+        std::string key;
+        check(cache.computeKey(protocol, nullptr, &original) && !original.empty(), "计算缓存键");
+        check(cache.computeKey(protocol, nullptr, &key) && key == original, "同一协议两次计算的键相同");
+
+        std::error_code ec;
+        fs::last_write_time(asset, fs::last_write_time(asset) + std::chrono::hours(1), ec);
+        check(cache.computeKey(protocol, nullptr, &key) && key == original,
+              "素材只改修改时间（内容不变）时重新哈希，键不变");
+
+        // 大小相同、内容不同，再改一次修改时间，排除文件系统时间精度的影响
+        writeFile(asset, "other version of the asset");
+        fs::last_write_time(asset, fs::last_write_time(asset) + std::chrono::hours(2), ec);
+        std::string edited;
+        check(cache.computeKey(protocol, nullptr, &edited) && edited != original, "素材内容变化后键改变");
+
+        ResultCacheEngineState budget;
+        budget.maxImageDecodeBytes = 1024;
+        budget.maxRenderDecodeBytes = 4096;
+        check(cache.computeKey(protocol, nullptr, &key, nullptr, budget) && key != edited, "解码预算变化后键改变");
+
+        ResultCacheEngineState atlas;
+        atlas.spriteAtlases = {{"projects/long/long.atlas.json", "0123456789abcdef"}};
+        std::string withAtlas;
+        check(cache.computeKey(protocol, nullptr, &withAtlas, nullptr, atlas) && withAtlas != edited,
+              "加载精灵图集后键改变");
+        atlas.spriteAtlases[0].second = "fedcba9876543210";
+        check(cache.computeKey(protocol, nullptr, &key, nullptr, atlas) && key != withAtlas,
+              "图集内容哈希变化后键改变");
+
+        fs::remove(asset, ec);
+        check(!cache.computeKey(protocol, nullptr, &key), "素材无法读取时不计算键");
+    }
+
+    void testEviction(const fs::path& directory) {
+        std::vector<sk_sp<SkData>> cached;
+        {
+            // 每个条目1000字节数据加16字节头，上限只够放两个
+            ResultCache cache(directory.string(), 2500);
+            cache.store("a", {makeOutput(1000, 1)});
+            cache.store("b", {makeOutput(1000, 2)});
+            cache.lookup("a", 1, &cached);
+            cache.store("c", {makeOutput(1000, 3)});
+            ResultCache::Stats stats = cache.getStats();
+            check(stats.entryCount == 2 && stats.evictions == 1 && stats.totalBytes <= 2500 &&
+                  !cache.lookup("b", 1, &cached) && cache.lookup("a", 1, &cached) && cache.lookup("c", 1, &cached),
+                  "超出总字节上限时淘汰最久未使用的条目");
+            check(!cache.store("huge", {makeOutput(4000, 4)}) && !cache.lookup("huge", 1, &cached),
+                  "单个条目超过上限时不缓存");
+            check(!fs::exists(directory / "b.bin"), "被淘汰条目的文件已删除");
+            cache.clear();
+        }
+        {
+            ResultCache cache(directory.string(), 1ull << 30, 2);
+            cache.store("a", {makeOutput(10, 1)});
+            cache.store("b", {makeOutput(10, 2)});
+            cache.lookup("a", 1, &cached);
+            cache.store("c", {makeOutput(10, 3)});
+            check(cache.getStats().entryCount == 2 && !cache.lookup("b", 1, &cached) &&
+                  cache.lookup("a", 1, &cached) && cache.lookup("c", 1, &cached),
+                  "超出条目数上限时淘汰最久未使用的条目");
+            cache.setLimits(1ull << 30, 1);
+            check(cache.getStats().entryCount == 1 && cache.lookup("c", 1, &cached), "调小上限后立即淘汰");
+            cache.clear();
+            check(cache.getStats().entryCount == 0 && cache.getStats().totalBytes == 0, "清空后没有条目");
+        }
+    }
+
+    void testTruncated(const fs::path& directory) {
+        ResultCache cache(directory.string());
+        std::vector<sk_sp<SkData>> outputs = {makeOutput(1000, 5)};
+        cache.store("truncated", outputs);
+        fs::path entry = directory / "truncated.bin";
+        std::error_code ec;
+        fs::resize_file(entry, fs::file_size(entry, ec) / 2, ec);
+
+        std::vector<sk_sp<SkData>> cached;
+        check(!ec && !cache.lookup("truncated", outputs.size(), &cached), "截断的条目不命中");
+        check(!fs::exists(entry) && cache.getStats().entryCount == 0 && cache.getStats().totalBytes == 0,
+              "截断的条目文件被删除并移出索引");
+    }
+
+    void testStaleTempFiles(const fs::path& directory) {
+        // 崩溃的进程留下的临时文件（超过1小时），以及可能仍在写入的新临时文件
+        std::string stale = TempFile::pathFor((directory / "stale.bin").string());
+        std::string fresh = TempFile::pathFor((directory / "fresh.bin").string());
+        writeFile(stale, "partial entry");
+        writeFile(fresh, "partial entry");
+        std::error_code ec;
+        fs::last_write_time(stale, fs::file_time_type::clock::now() - std::chrono::hours(2), ec);
+
+        ResultCache cache(directory.string());
+        check(!fs::exists(stale) && fs::exists(fresh), "重建索引时删除过期的临时文件，保留新的临时文件");
+        check(cache.getStats().entryCount == 0 && cache.getStats().totalBytes == 0, "临时文件不计入缓存");
+    }
+
+public:
+    int run() {
+        fs::path root = fs::temp_directory_path() / "result_cache_test";
+        std::error_code ec;
+        fs::remove_all(root, ec);
+
+        const std::pair<const char*, void (ResultCacheTest::*)(const fs::path&)> cases[] = {
+            {"写入与查找", &ResultCacheTest::testStoreLookup},
+            {"缓存键", &ResultCacheTest::testKey},
+            {"LRU淘汰", &ResultCacheTest::testEviction},
+            {"损坏条目", &ResultCacheTest::testTruncated},
+            {"临时文件清理", &ResultCacheTest::testStaleTempFiles},
+        };
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+            // 每组用例使用独立的空目录
+            fs::path directory = root / std::to_string(i);
+            fs::create_directories(directory, ec);
+            std::cout << (i == 0 ? "" : "\n") << "🧪 " << cases[i].first << "测试" << std::endl;
+            (this->*cases[i].second)(directory);
+        }
+
+        fs::remove_all(root, ec);
+        std::cout << "\n📊 通过: " << passed << "  失败: " << failed << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+};
+
+int main() {
+    ResultCacheTest test;
+    return test.run();
+}
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -7,298 +6,373 @@
 #include <iomanip>
 #include <sstream>
 #include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <functional>
 
 // Skia headers for image comparison
 #include "include/core/SkBitmap.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkData.h"
-#include "include/core/SkCanvas.h"
-#include "include/core/SkSurface.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkImageInfo.h"
+#include "include/codec/SkCodec.h"
 #include "include/encode/SkPngEncoder.h"
 
+#include "engine/render_engine.h"
+#include "parsers/protocol_parser.h"
+#include "utils/image_diff.h"
+#include "utils/thread_pool.h"
+
 namespace fs = std::filesystem;
+using namespace skia_renderer;
 
+// 图片回归测试：进程内通过RenderEngine渲染，测试用例在共享线程池上并行执行，
+// 渲染结果直接以像素与基线对比，不再启动外部渲染程序、不经过output/目录
 class SimpleImageTest {
 private:
     std::string baselineDir = "tests/baseline/";
-    std::string outputDir = "output/";
     std::string diffDir = "tests/diff/";
     double tolerance = 0.01; // 1% 容差
+    int jobs = 0;            // 并行用例数，0表示使用线程池全部线程
+
+    struct TestCase {
+        std::string name;
+        std::string protocolFile;
+        bool checkOpacity = false;  // 另外与"不透明渲染后整体按透明度合成"的结果对比，不依赖基线
+    };
+
+    // 单个用例的结果，日志先缓存，全部完成后按用例顺序输出，避免并行输出交错
+    struct TestResult {
+        bool passed = false;
+        std::ostringstream log;
+    };
+
+    std::vector<TestCase> tests = {
+        {"trip", "projects/trip/trip_protocol.json"},
+        {"sunscreen", "projects/sunscreen/sunscreen_protocol.json"},
+        {"food", "projects/food/food_protocol.json"},
+        {"spring", "projects/spring/spring_protocol.json"},
+        {"dessert", "projects/dessert/dessert_protocol.json"},
+        {"cup", "projects/cup/cup_protocol.json"},
+        {"horizontal", "projects/horizontal/horizontal_protocol.json"},
+        {"long", "projects/long/long_protocol.json"},
+        {"clothes", "projects/clothes/clothes_protocol.json"},
+        {"tshirt", "projects/tshirt/tshirt_protocol.json"},
+        {"single_line", "projects/text_wrap_test/single_line_protocol.json"},
+        {"multi_line", "projects/text_wrap_test/multi_line_protocol.json"},
+        {"word_wrap", "projects/text_wrap_test/word_wrap_protocol.json"},
+        {"auto_fit", "projects/text_wrap_test/auto_fit_protocol.json"},
+        {"rich_text_opacity", "projects/text_styles_protocols/rich_text_opacity.json", true}
+    };
+
+    // 统一的对比格式：非预乘RGBA，与PNG解码结果一致
+    static SkImageInfo comparisonInfo(int width, int height) {
+        return SkImageInfo::Make(width, height, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+    }
 
-public:
-    SimpleImageTest() {
-        // 创建必要的目录
-        fs::create_directories(baselineDir);
-        fs::create_directories(diffDir);
+    // 在进程内渲染协议，结果读回为RGBA像素
+    static bool renderProtocol(const std::string& protocolFile, SkBitmap* bitmap, std::string* error) {
+        ProtocolParser parser;
+        if (!parser.loadFromFile(protocolFile)) {
+            *error = "协议加载失败: " + parser.getErrorMessage();
+            return false;
+        }
+        return renderProtocol(parser.getProtocol(), bitmap, error);
     }
 
-    // 计算图片的哈希值（用于快速比较）
-    std::string calculateImageHash(const std::string& imagePath) {
-        auto data = SkData::MakeFromFileName(imagePath.c_str());
-        if (!data) {
-            std::cerr << "无法读取图片: " << imagePath << std::endl;
-            return "";
+    static bool renderProtocol(const RenderProtocol& protocol, SkBitmap* bitmap, std::string* error) {
+        // 每个用例使用独立的引擎，引擎内部的画布和渲染器不跨线程共享
+        RenderEngine engine;
+        sk_sp<SkImage> image = engine.renderToImage(protocol);
+        if (!image) {
+            *error = "渲染失败: " + engine.getErrorMessage();
+            return false;
         }
 
-        // 简单的哈希计算
-        size_t hash = 0;
-        const uint8_t* bytes = static_cast<const uint8_t*>(data->data());
-        size_t size = data->size();
-        
-        for (size_t i = 0; i < size; ++i) {
-            hash = hash * 31 + bytes[i];
+        if (!bitmap->tryAllocPixels(comparisonInfo(image->width(), image->height())) ||
+            !image->readPixels(nullptr, bitmap->pixmap(), 0, 0)) {
+            *error = "无法读取渲染结果像素";
+            return false;
         }
-        
-        std::stringstream ss;
-        ss << std::hex << hash;
-        return ss.str();
+        return true;
     }
 
-    // 比较两个图片的像素差异
-    double compareImages(const std::string& image1Path, const std::string& image2Path) {
-        auto image1 = SkImages::DeferredFromEncodedData(SkData::MakeFromFileName(image1Path.c_str()));
-        auto image2 = SkImages::DeferredFromEncodedData(SkData::MakeFromFileName(image2Path.c_str()));
-        
-        if (!image1 || !image2) {
-            std::cerr << "无法加载图片进行比较" << std::endl;
-            return 1.0; // 返回最大差异
+    // 解码基线PNG为RGBA像素
+    static bool loadBaseline(const std::string& path, SkBitmap* bitmap) {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(SkData::MakeFromFileName(path.c_str()));
+        if (!codec) {
+            return false;
         }
+        SkImageInfo info = comparisonInfo(codec->getInfo().width(), codec->getInfo().height());
+        if (!bitmap->tryAllocPixels(info)) {
+            return false;
+        }
+        return codec->getPixels(info, bitmap->getPixels(), bitmap->rowBytes()) == SkCodec::kSuccess;
+    }
 
-        SkBitmap bitmap1, bitmap2;
-        if (!image1->asLegacyBitmap(&bitmap1) || !image2->asLegacyBitmap(&bitmap2)) {
-            std::cerr << "无法转换为位图" << std::endl;
-            return 1.0;
+    static bool savePng(const SkPixmap& pixmap, const std::string& path) {
+        SkFILEWStream stream(path.c_str());
+        return stream.isValid() && SkPngEncoder::Encode(&stream, pixmap, {});
+    }
+
+    static std::string formatPsnr(double psnr) {
+        if (std::isinf(psnr)) {
+            return "inf";
         }
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(2) << psnr << "dB";
+        return ss.str();
+    }
 
-        // 检查尺寸是否相同
-        if (bitmap1.width() != bitmap2.width() || bitmap1.height() != bitmap2.height()) {
-            std::cerr << "图片尺寸不同: " << bitmap1.width() << "x" << bitmap1.height() 
-                      << " vs " << bitmap2.width() << "x" << bitmap2.height() << std::endl;
-            return 1.0;
+    // 半透明文本的语义是"先不透明地画到透明图层，再整体按透明度合成"：
+    // 结果 = 背景 + 透明度 × (不透明渲染 - 背景)。协议中所有文本须使用同一透明度，且互不重叠。
+    // 允许舍入误差（每通道2级）和极少量字形重叠处的差异
+    static bool checkOpacity(const std::string& protocolFile, const SkBitmap& current, std::ostream& log) {
+        ProtocolParser parser;
+        if (!parser.loadFromFile(protocolFile) || parser.getProtocol().texts.empty()) {
+            log << "  ❌ 透明度检查: 协议加载失败" << std::endl;
+            return false;
+        }
+        RenderProtocol opaque = parser.getProtocol();
+        float opacity = opaque.texts.front().transform.opacity;
+        for (auto& text : opaque.texts) {
+            if (text.transform.opacity != opacity) {
+                log << "  ❌ 透明度检查: 所有文本须使用同一透明度" << std::endl;
+                return false;
+            }
+            text.transform.opacity = 1.0f;
+        }
+        RenderProtocol background = opaque;
+        background.texts.clear();
+
+        SkBitmap opaqueBitmap;
+        SkBitmap backgroundBitmap;
+        std::string error;
+        if (!renderProtocol(opaque, &opaqueBitmap, &error) || !renderProtocol(background, &backgroundBitmap, &error)) {
+            log << "  ❌ 透明度检查: " << error << std::endl;
+            return false;
         }
 
-        int width = bitmap1.width();
-        int height = bitmap1.height();
-        int totalPixels = width * height;
-        int differentPixels = 0;
-
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                SkColor color1 = bitmap1.getColor(x, y);
-                SkColor color2 = bitmap2.getColor(x, y);
-                
-                if (color1 != color2) {
-                    differentPixels++;
+        int64_t mismatched = 0;
+        int64_t changed = 0;
+        for (int y = 0; y < current.height(); ++y) {
+            const uint8_t* actual = static_cast<const uint8_t*>(current.getAddr(0, y));
+            const uint8_t* text = static_cast<const uint8_t*>(opaqueBitmap.getAddr(0, y));
+            const uint8_t* base = static_cast<const uint8_t*>(backgroundBitmap.getAddr(0, y));
+            for (int x = 0; x < current.width(); ++x) {
+                bool differs = false;
+                for (int c = 0; c < 3; ++c) {
+                    int i = x * 4 + c;
+                    float expected = base[i] + opacity * (text[i] - base[i]);
+                    differs |= std::fabs(actual[i] - expected) > 2.0f;
                 }
+                changed += std::memcmp(text + x * 4, base + x * 4, 4) != 0;
+                mismatched += differs;
+            }
+        }
+        // 至少要真的画出了文本；不匹配的像素不超过文本像素的0.5%
+        bool ok = changed > 0 && mismatched * 200 <= changed;
+        log << "  " << (ok ? "✅" : "❌") << " 透明度合成检查: 文本像素 " << changed
+            << ", 不符合合成结果的像素 " << mismatched << std::endl;
+        return ok;
+    }
+
+    const TestCase* findTest(const std::string& name) const {
+        for (const auto& test : tests) {
+            if (test.name == name) {
+                return &test;
             }
         }
+        return nullptr;
+    }
+
+    int parallelism() const {
+        return jobs > 0 ? jobs : ThreadPool::threadCount();
+    }
 
-        return static_cast<double>(differentPixels) / totalPixels;
+    // 在线程池上并行执行count个任务，同时最多parallelism()个
+    void runParallel(int count, const std::function<void(int)>& task) const {
+        int workers = std::max(1, std::min(parallelism(), count));
+        std::atomic<int> next{0};
+        ThreadPool::parallelFor(workers, [&](int) {
+            for (int i = next++; i < count; i = next++) {
+                task(i);
+            }
+        });
+    }
+
+public:
+    SimpleImageTest() {
+        // 创建必要的目录
+        fs::create_directories(baselineDir);
+        fs::create_directories(diffDir);
     }
 
-    // 生成差异图片
-    void generateDiffImage(const std::string& image1Path, const std::string& image2Path, 
-                          const std::string& diffPath) {
-        auto image1 = SkImages::DeferredFromEncodedData(SkData::MakeFromFileName(image1Path.c_str()));
-        auto image2 = SkImages::DeferredFromEncodedData(SkData::MakeFromFileName(image2Path.c_str()));
-        
-        if (!image1 || !image2) {
-            std::cerr << "无法加载图片生成差异图" << std::endl;
+    // 运行单个测试
+    void runTest(const TestCase& test, TestResult* result) {
+        std::ostream& log = result->log;
+        log << "运行测试: " << test.name << std::endl;
+
+        std::string baselineImagePath = baselineDir + test.name + "_baseline.png";
+        std::string diffImagePath = diffDir + test.name + "_diff.png";
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        // 1. 进程内渲染
+        SkBitmap current;
+        std::string error;
+        if (!renderProtocol(test.protocolFile, &current, &error)) {
+            log << "  ❌ " << error << std::endl;
             return;
         }
 
-        SkBitmap bitmap1, bitmap2;
-        if (!image1->asLegacyBitmap(&bitmap1) || !image2->asLegacyBitmap(&bitmap2)) {
+        auto renderTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime);
+        log << "  渲染完成: " << current.width() << "x" << current.height()
+            << " (" << renderTime.count() << "ms)" << std::endl;
+
+        if (test.checkOpacity && !checkOpacity(test.protocolFile, current, log)) {
             return;
         }
 
-        int width = bitmap1.width();
-        int height = bitmap1.height();
-
-        // 创建差异图片
-        SkImageInfo info = SkImageInfo::Make(width, height, kRGBA_8888_SkColorType, kPremul_SkAlphaType);
-        auto surface = SkSurfaces::Raster(info);
-        SkCanvas* canvas = surface->getCanvas();
-
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                SkColor color1 = bitmap1.getColor(x, y);
-                SkColor color2 = bitmap2.getColor(x, y);
-                
-                if (color1 != color2) {
-                    // 差异像素显示为红色
-                    SkPaint paint;
-                    paint.setColor(SK_ColorRED);
-                    canvas->drawPoint(x, y, paint);
-                } else {
-                    // 相同像素显示为原色
-                    SkPaint paint;
-                    paint.setColor(color1);
-                    canvas->drawPoint(x, y, paint);
-                }
+        // 2. 基线不存在时以本次渲染结果创建基线
+        if (!fs::exists(baselineImagePath)) {
+            log << "  基线图片不存在，创建基线..." << std::endl;
+            result->passed = savePng(current.pixmap(), baselineImagePath);
+            if (!result->passed) {
+                log << "  ❌ 无法写入基线: " << baselineImagePath << std::endl;
             }
+            return;
         }
 
-        // 保存差异图片
-        auto diffImage = surface->makeImageSnapshot();
-        auto data = SkPngEncoder::Encode(nullptr, diffImage.get(), {});
-        if (data) {
-            std::ofstream file(diffPath, std::ios::binary);
-            file.write(static_cast<const char*>(data->data()), data->size());
+        SkBitmap baseline;
+        if (!loadBaseline(baselineImagePath, &baseline)) {
+            log << "  ❌ 无法解码基线图片: " << baselineImagePath << std::endl;
+            return;
         }
-    }
 
-    // 运行单个测试
-    bool runTest(const std::string& testName, const std::string& protocolFile) {
-        std::cout << "运行测试: " << testName << std::endl;
-        
-        // 基线图片路径
-        std::string baselineImagePath = baselineDir + testName + "_baseline.png";
-        std::string diffImagePath = diffDir + testName + "_diff.png";
-
-        // 1. 运行渲染程序生成当前图片
-        std::cout << "  渲染协议文件: " << protocolFile << std::endl;
-        
-        std::string command = "./build/renderer " + protocolFile;
-        int result = system(command.c_str());
-        
-        if (result != 0) {
-            std::cerr << "  ❌ 渲染失败，退出码: " << result << std::endl;
-            return false;
+        if (baseline.width() != current.width() || baseline.height() != current.height()) {
+            log << "  ❌ 图片尺寸不同: " << current.width() << "x" << current.height()
+                << " vs " << baseline.width() << "x" << baseline.height() << std::endl;
+            return;
         }
 
-        // 2. 查找生成的图片文件
-        std::string currentImagePath = "";
-        for (const auto& entry : fs::directory_iterator(outputDir)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".png") {
-                std::string filename = entry.path().filename().string();
-                if (filename.find(testName) != std::string::npos) {
-                    currentImagePath = entry.path().string();
-                    break;
-                }
-            }
-        }
-        
-        if (currentImagePath.empty()) {
-            std::cerr << "  ❌ 未找到生成的图片文件" << std::endl;
-            return false;
-        }
+        // 3. 像素对比，差异超过容差时同时生成差异图
+        ImageDiffResult diff;
+        ImageDiff::compare(current.pixmap(), baseline.pixmap(), &diff);
 
-        std::cout << "  找到生成图片: " << currentImagePath << std::endl;
-        
-        // 3. 检查基线图片是否存在
-        if (!fs::exists(baselineImagePath)) {
-            std::cout << "  基线图片不存在，创建基线..." << std::endl;
-            fs::copy_file(currentImagePath, baselineImagePath);
-            return true;
+        if (diff.differentPixels == 0) {
+            log << "  ✅ 图片完全一致" << std::endl;
+            fs::remove(diffImagePath);
+            result->passed = true;
+            return;
         }
 
-        // 4. 计算哈希值进行快速比较
-        std::string currentHash = calculateImageHash(currentImagePath);
-        std::string baselineHash = calculateImageHash(baselineImagePath);
-        
-        if (currentHash == baselineHash) {
-            std::cout << "  ✅ 图片完全一致 (哈希值相同)" << std::endl;
-            return true;
+        std::ostringstream detail;
+        detail << "差异: " << std::fixed << std::setprecision(4) << (diff.differentRatio() * 100) << "%"
+               << ", 最大通道差: " << diff.maxChannelDelta
+               << ", PSNR: " << formatPsnr(diff.psnr)
+               << ", 区域: [" << diff.diffBounds.left() << "," << diff.diffBounds.top() << " "
+               << diff.diffBounds.width() << "x" << diff.diffBounds.height() << "]";
+
+        if (diff.differentRatio() <= tolerance) {
+            log << "  ✅ 图片基本一致 (" << detail.str() << ")" << std::endl;
+            fs::remove(diffImagePath);
+            result->passed = true;
+            return;
         }
 
-        // 5. 进行像素级比较
-        double difference = compareImages(currentImagePath, baselineImagePath);
-        
-        if (difference <= tolerance) {
-            std::cout << "  ✅ 图片基本一致 (差异: " << std::fixed << std::setprecision(4) 
-                      << (difference * 100) << "%)" << std::endl;
-            return true;
-        } else {
-            std::cout << "  ❌ 图片差异过大 (差异: " << std::fixed << std::setprecision(4) 
-                      << (difference * 100) << "%)" << std::endl;
-            
-            // 生成差异图片
-            generateDiffImage(currentImagePath, baselineImagePath, diffImagePath);
-            std::cout << "  差异图片已保存: " << diffImagePath << std::endl;
-            
-            return false;
+        log << "  ❌ 图片差异过大 (" << detail.str() << ")" << std::endl;
+
+        // 差异图直接写进像素图，不再逐像素调用drawPoint
+        SkBitmap diffBitmap;
+        if (diffBitmap.tryAllocPixels(current.info()) &&
+            ImageDiff::compare(current.pixmap(), baseline.pixmap(), &diff, &diffBitmap.pixmap()) &&
+            savePng(diffBitmap.pixmap(), diffImagePath)) {
+            log << "  差异图片已保存: " << diffImagePath << std::endl;
         }
     }
 
-    // 运行所有测试
-    void runAllTests() {
+    // 运行测试，names为空时运行全部；全部通过返回true
+    bool runAllTests(const std::vector<std::string>& names = {}) {
         std::cout << "=== 简单图片对比测试开始 ===" << std::endl;
         std::cout << "容差设置: " << (tolerance * 100) << "%" << std::endl;
         std::cout << "基线目录: " << baselineDir << std::endl;
-        std::cout << "输出目录: " << outputDir << std::endl;
         std::cout << "差异目录: " << diffDir << std::endl;
+        std::cout << "并行用例: " << parallelism() << std::endl;
         std::cout << std::endl;
 
-        auto startTime = std::chrono::high_resolution_clock::now();
-        
-        std::vector<std::pair<std::string, std::string>> tests = {
-            {"trip", "projects/trip/trip_protocol.json"},
-            {"sunscreen", "projects/sunscreen/sunscreen_protocol.json"},
-            {"food", "projects/food/food_protocol.json"},
-            {"spring", "projects/spring/spring_protocol.json"},
-            {"dessert", "projects/dessert/dessert_protocol.json"},
-            {"cup", "projects/cup/cup_protocol.json"},
-            {"horizontal", "projects/horizontal/horizontal_protocol.json"},
-            {"long", "projects/long/long_protocol.json"},
-            {"clothes", "projects/clothes/clothes_protocol.json"},
-            {"tshirt", "projects/tshirt/tshirt_protocol.json"},
-            {"single_line", "projects/text_wrap_test/single_line_protocol.json"},
-            {"multi_line", "projects/text_wrap_test/multi_line_protocol.json"},
-            {"word_wrap", "projects/text_wrap_test/word_wrap_protocol.json"},
-            {"auto_fit", "projects/text_wrap_test/auto_fit_protocol.json"}
-        };
+        std::vector<const TestCase*> selected;
+        for (const auto& test : tests) {
+            if (names.empty() || std::find(names.begin(), names.end(), test.name) != names.end()) {
+                selected.push_back(&test);
+            }
+        }
+        for (const auto& name : names) {
+            if (!findTest(name)) {
+                std::cerr << "未知测试: " << name << std::endl;
+                return false;
+            }
+        }
 
-        int passedTests = 0;
-        int totalTests = tests.size();
+        auto startTime = std::chrono::steady_clock::now();
 
-        for (const auto& test : tests) {
-            bool result = runTest(test.first, test.second);
-            if (result) {
+        std::vector<TestResult> results(selected.size());
+        runParallel(static_cast<int>(selected.size()), [&](int i) {
+            runTest(*selected[i], &results[i]);
+        });
+
+        int passedTests = 0;
+        int totalTests = static_cast<int>(selected.size());
+        for (const auto& result : results) {
+            std::cout << result.log.str() << std::endl;
+            if (result.passed) {
                 passedTests++;
             }
-            std::cout << std::endl;
         }
 
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime);
 
         std::cout << "=== 测试结果 ===" << std::endl;
         std::cout << "总测试数: " << totalTests << std::endl;
         std::cout << "通过测试: " << passedTests << std::endl;
         std::cout << "失败测试: " << (totalTests - passedTests) << std::endl;
         std::cout << "测试耗时: " << duration.count() << "ms" << std::endl;
-        
+
         if (passedTests == totalTests) {
             std::cout << "🎉 所有测试通过！" << std::endl;
         } else {
             std::cout << "⚠️  部分测试失败，请检查差异图片" << std::endl;
         }
+        return passedTests == totalTests;
     }
 
-    // 更新基线图片
-    void updateBaseline(const std::string& testName) {
-        // 查找当前输出图片
-        std::string currentImagePath = "";
-        for (const auto& entry : fs::directory_iterator(outputDir)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".png") {
-                std::string filename = entry.path().filename().string();
-                if (filename.find(testName) != std::string::npos) {
-                    currentImagePath = entry.path().string();
-                    break;
-                }
-            }
+    // 更新基线图片：重新渲染并覆盖基线
+    bool updateBaseline(const std::string& testName) {
+        const TestCase* test = findTest(testName);
+        if (!test) {
+            std::cerr << "未知测试: " << testName << std::endl;
+            return false;
+        }
+
+        SkBitmap current;
+        std::string error;
+        if (!renderProtocol(test->protocolFile, &current, &error)) {
+            std::cerr << error << std::endl;
+            return false;
         }
-        
+
         std::string baselineImagePath = baselineDir + testName + "_baseline.png";
-        
-        if (!currentImagePath.empty() && fs::exists(currentImagePath)) {
-            fs::copy_file(currentImagePath, baselineImagePath, fs::copy_options::overwrite_existing);
-            std::cout << "已更新基线图片: " << baselineImagePath << std::endl;
-        } else {
-            std::cerr << "当前图片不存在，请先运行渲染" << std::endl;
+        if (!savePng(current.pixmap(), baselineImagePath)) {
+            std::cerr << "无法写入基线: " << baselineImagePath << std::endl;
+            return false;
         }
+        std::cout << "已更新基线图片: " << baselineImagePath << std::endl;
+        return true;
     }
 
     // 设置容差
@@ -307,103 +381,94 @@ public:
         std::cout << "容差已设置为: " << (tolerance * 100) << "%" << std::endl;
     }
 
-    // 一致性测试 - 多次渲染同一协议，检查是否一致
-    void consistencyTest(const std::string& testName, const std::string& protocolFile, int iterations = 5) {
+    // 设置并行用例数
+    void setJobs(int newJobs) {
+        jobs = newJobs;
+    }
+
+    // 一致性测试 - 并行多次渲染同一协议，检查像素是否完全一致（同时覆盖多线程下的确定性）
+    bool consistencyTest(const std::string& testName, int iterations = 5) {
         std::cout << "=== 一致性测试: " << testName << " (迭代 " << iterations << " 次) ===" << std::endl;
-        
-        std::vector<std::string> hashes;
-        
+
+        const TestCase* test = findTest(testName);
+        if (!test || iterations < 1) {
+            std::cerr << "  ❌ 未知测试: " << testName << std::endl;
+            return false;
+        }
+
+        std::vector<SkBitmap> bitmaps(iterations);
+        std::vector<std::string> errors(iterations);
+        std::vector<bool> rendered(iterations, false);
+        runParallel(iterations, [&](int i) {
+            rendered[i] = renderProtocol(test->protocolFile, &bitmaps[i], &errors[i]);
+        });
+
+        bool allSame = true;
         for (int i = 0; i < iterations; ++i) {
-            std::cout << "  第 " << (i+1) << " 次渲染..." << std::endl;
-            
-            // 运行渲染程序
-            std::string command = "./build/renderer " + protocolFile;
-            int result = system(command.c_str());
-            
-            if (result != 0) {
-                std::cerr << "  ❌ 第 " << (i+1) << " 次渲染失败" << std::endl;
-                return;
-            }
-            
-            // 查找生成的图片文件
-            std::string imagePath = "";
-            for (const auto& entry : fs::directory_iterator(outputDir)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".png") {
-                    std::string filename = entry.path().filename().string();
-                    if (filename.find(testName) != std::string::npos) {
-                        imagePath = entry.path().string();
-                        break;
-                    }
-                }
+            if (!rendered[i]) {
+                std::cerr << "  ❌ 第 " << (i + 1) << " 次渲染失败: " << errors[i] << std::endl;
+                return false;
             }
-            
-            if (imagePath.empty()) {
-                std::cerr << "  ❌ 第 " << (i+1) << " 次渲染未找到图片文件" << std::endl;
-                return;
+            if (i == 0) {
+                continue;
             }
-            
-            std::string hash = calculateImageHash(imagePath);
-            hashes.push_back(hash);
-            
-            std::cout << "  第 " << (i+1) << " 次渲染完成，哈希值: " << hash << std::endl;
-        }
-        
-        // 检查所有哈希值是否相同
-        bool allSame = true;
-        std::string firstHash = hashes[0];
-        
-        for (size_t i = 1; i < hashes.size(); ++i) {
-            if (hashes[i] != firstHash) {
+
+            ImageDiffResult diff;
+            if (!ImageDiff::compare(bitmaps[0].pixmap(), bitmaps[i].pixmap(), &diff) ||
+                diff.differentPixels != 0) {
                 allSame = false;
-                std::cout << "  ❌ 第 " << (i+1) << " 次渲染结果不同" << std::endl;
+                std::cout << "  ❌ 第 " << (i + 1) << " 次渲染结果不同 (差异像素: "
+                          << diff.differentPixels << ", 最大通道差: " << diff.maxChannelDelta << ")" << std::endl;
             }
         }
-        
+
         if (allSame) {
             std::cout << "  ✅ 所有渲染结果完全一致！" << std::endl;
         } else {
             std::cout << "  ❌ 渲染结果不一致，可能存在随机性" << std::endl;
         }
+        return allSame;
     }
 };
 
+static void printUsage(const char* program) {
+    std::cout << "用法:" << std::endl;
+    std::cout << "  " << program << " run [--jobs N] [--tolerance V] [test_name...]  # 运行测试（默认全部）" << std::endl;
+    std::cout << "  " << program << " update <test_name>     # 更新指定测试的基线" << std::endl;
+    std::cout << "  " << program << " tolerance <value>      # 按指定容差 (0.0-1.0) 运行所有测试" << std::endl;
+    std::cout << "  " << program << " consistency <test_name> [iterations] # 一致性测试" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
     SimpleImageTest test;
-    
-    if (argc > 1) {
-        std::string command = argv[1];
-        
-        if (command == "run") {
-            test.runAllTests();
-        } else if (command == "update" && argc > 2) {
-            test.updateBaseline(argv[2]);
-        } else if (command == "tolerance" && argc > 2) {
-            double tolerance = std::stod(argv[2]);
-            test.setTolerance(tolerance);
-        } else if (command == "consistency" && argc > 2) {
-            std::string testName = argv[2];
-            int iterations = (argc > 3) ? std::stoi(argv[3]) : 5;
-            
-            // 特殊处理文本模式测试的路径
-            std::string protocolFile;
-            if (testName == "single_line" || testName == "multi_line" || 
-                testName == "word_wrap" || testName == "auto_fit") {
-                protocolFile = "projects/text_wrap_test/" + testName + "_protocol.json";
+
+    std::string command = argc > 1 ? argv[1] : "run";
+    bool success = false;
+
+    if (command == "run") {
+        std::vector<std::string> names;
+        for (int i = 2; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+                test.setJobs(std::atoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+                test.setTolerance(std::stod(argv[++i]));
             } else {
-                protocolFile = "projects/" + testName + "/" + testName + "_protocol.json";
+                names.push_back(argv[i]);
             }
-            
-            test.consistencyTest(testName, protocolFile, iterations);
-        } else {
-            std::cout << "用法:" << std::endl;
-            std::cout << "  " << argv[0] << " run                    # 运行所有测试" << std::endl;
-            std::cout << "  " << argv[0] << " update <test_name>     # 更新指定测试的基线" << std::endl;
-            std::cout << "  " << argv[0] << " tolerance <value>      # 设置容差 (0.0-1.0)" << std::endl;
-            std::cout << "  " << argv[0] << " consistency <test_name> [iterations] # 一致性测试" << std::endl;
         }
+        success = test.runAllTests(names);
+    } else if (command == "update" && argc > 2) {
+        success = test.updateBaseline(argv[2]);
+    } else if (command == "tolerance" && argc > 2) {
+        test.setTolerance(std::stod(argv[2]));
+        success = test.runAllTests();
+    } else if (command == "consistency" && argc > 2) {
+        int iterations = (argc > 3) ? std::stoi(argv[3]) : 5;
+        success = test.consistencyTest(argv[2], iterations);
     } else {
-        test.runAllTests();
+        printUsage(argv[0]);
     }
-    
-    return 0;
-} 
\ No newline at end of file
+
+    // 非0退出码供presubmit/ctest判断失败
+    return success ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImageInfo.h"
+#include "include/codec/SkCodec.h"
+
+#include "engine/render_engine.h"
+#include "parsers/protocol_parser.h"
+
+using namespace skia_renderer;
+
+// 分块光栅化一致性测试：同一协议分别用串行和分块并行方式渲染，解码后的像素必须逐字节一致
+class TiledRasterTest {
+private:
+    std::vector<std::string> protocolFiles = {
+        "projects/trip/trip_protocol.json",
+        "projects/food/food_protocol.json",
+        "projects/clothes/clothes_protocol.json",
+        "projects/long/long_protocol.json",
+        "projects/text_wrap_test/word_wrap_protocol.json",
+    };
+    int passed = 0;
+    int failed = 0;
+
+    static bool decodeToRgba(sk_sp<SkData> data, SkBitmap* bitmap) {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(std::move(data));
+        if (!codec) {
+            return false;
+        }
+        SkImageInfo info = codec->getInfo().makeColorType(kRGBA_8888_SkColorType)
+                                           .makeAlphaType(kUnpremul_SkAlphaType)
+                                           .makeColorSpace(nullptr);
+        if (!bitmap->tryAllocPixels(info)) {
+            return false;
+        }
+        return codec->getPixels(info, bitmap->getPixels(), bitmap->rowBytes()) == SkCodec::kSuccess;
+    }
+
+    static bool renderPng(RenderProtocol protocol, bool tiled, int tileCount, SkBitmap* bitmap) {
+        protocol.canvas.tiledRaster = tiled;
+        protocol.canvas.tileCount = tileCount;
+        OutputConfig output;
+        output.format = "png";
+        output.filename = "tiled_raster_test.png";
+        output.profile = "fast";
+        protocol.outputs = {output};
+
+        RenderEngine engine;
+        sk_sp<SkData> data;
+        if (!engine.renderToData(protocol, &data)) {
+            std::cerr << "渲染失败: " << engine.getErrorMessage() << std::endl;
+            return false;
+        }
+        return decodeToRgba(data, bitmap);
+    }
+
+    static int countDiffPixels(const SkBitmap& a, const SkBitmap& b) {
+        if (a.width() != b.width() || a.height() != b.height()) {
+            return -1;
+        }
+        int diff = 0;
+        for (int y = 0; y < a.height(); ++y) {
+            for (int x = 0; x < a.width(); ++x) {
+                if (*a.getAddr32(x, y) != *b.getAddr32(x, y)) {
+                    ++diff;
+                }
+            }
+        }
+        return diff;
+    }
+
+    void testProtocol(const std::string& file) {
+        ProtocolParser parser;
+        if (!parser.loadFromFile(file)) {
+            std::cout << "⚠️  跳过 " << file << ": " << parser.getErrorMessage() << std::endl;
+            return;
+        }
+
+        SkBitmap serial;
+        if (!renderPng(parser.getProtocol(), false, 0, &serial)) {
+            ++failed;
+            std::cout << "❌ " << file << " 串行渲染失败" << std::endl;
+            return;
+        }
+
+        // 自动分块和非整除的分块数
+        for (int tileCount : {0, 7}) {
+            SkBitmap tiled;
+            int diff = renderPng(parser.getProtocol(), true, tileCount, &tiled)
+                     ? countDiffPixels(serial, tiled) : -1;
+            std::string name = file + " (tileCount=" + std::to_string(tileCount) + ")";
+            if (diff == 0) {
+                ++passed;
+                std::cout << "✅ " << name << std::endl;
+            } else {
+                ++failed;
+                std::cout << "❌ " << name << " 差异像素: " << diff << std::endl;
+            }
+        }
+    }
+
+public:
+    int run() {
+        std::cout << "🧪 分块光栅化一致性测试" << std::endl;
+        for (const auto& file : protocolFiles) {
+            testProtocol(file);
+        }
+        std::cout << "\n📊 通过: " << passed << "  失败: " << failed << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+};
+
+int main() {
+    TiledRasterTest test;
+    return test.run();
+}
@@ -0,0 +1,106 @@
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "resources/asset_bundle.h"
+
+using namespace skia_renderer;
+
+// 资源包工具：
+//   asset_bundle build -o <输出文件> <目录或文件>...   把目录下的图片和字体打包（路径保持为协议中引用的相对路径）
+//   asset_bundle list <资源包>                          列出条目及预先计算的元数据
+// 需要在项目根目录运行，例如：
+//   ./build/asset_bundle build -o food.bundle projects/food res/Fonts
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "用法:\n"
+              << "  " << program << " build -o <输出文件> <目录或文件>...\n"
+              << "  " << program << " list <资源包>" << std::endl;
+}
+
+const char* kindName(AssetBundle::Kind kind) {
+    switch (kind) {
+        case AssetBundle::Kind::Image:
+            return "image";
+        case AssetBundle::Kind::Font:
+            return "font";
+        default:
+            return "other";
+    }
+}
+
+int buildBundle(int argc, char* argv[]) {
+    std::string outputPath;
+    std::vector<std::string> inputs;
+    for (int i = 2; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "-o") == 0 || std::strcmp(argv[i], "--output") == 0) && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (outputPath.empty() || inputs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    AssetBundleWriter writer;
+    for (const auto& input : inputs) {
+        bool ok = std::filesystem::is_directory(input) ? writer.addDirectory(input) : writer.addFile(input, input);
+        if (!ok) {
+            std::cerr << "❌ " << writer.getErrorMessage() << std::endl;
+            return 1;
+        }
+    }
+    if (!writer.write(outputPath)) {
+        std::cerr << "❌ " << writer.getErrorMessage() << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(outputPath, ec);
+    std::cout << "✅ 已写入 " << outputPath << ": " << writer.getEntryCount() << " 个资源, "
+              << size / 1024 << " KB" << std::endl;
+    return 0;
+}
+
+int listBundle(int argc, char* argv[]) {
+    if (argc != 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string error;
+    std::shared_ptr<AssetBundle> bundle = AssetBundle::open(argv[2], &error);
+    if (!bundle) {
+        std::cerr << "❌ " << error << std::endl;
+        return 1;
+    }
+
+    std::vector<AssetBundle::Entry> entries = bundle->entries();
+    for (const auto& entry : entries) {
+        std::cout << kindName(entry.kind) << "\t" << entry.contentHash << "\t" << entry.size;
+        if (entry.kind == AssetBundle::Kind::Image) {
+            std::cout << "\t" << entry.width << "x" << entry.height << (entry.opaque ? " opaque" : "");
+        }
+        std::cout << "\t" << entry.path << std::endl;
+    }
+    std::cout << "📊 共 " << entries.size() << " 个资源" << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::strcmp(argv[1], "build") == 0) {
+        return buildBundle(argc, argv);
+    }
+    if (argc >= 2 && std::strcmp(argv[1], "list") == 0) {
+        return listBundle(argc, argv);
+    }
+    printUsage(argv[0]);
+    return 1;
+}
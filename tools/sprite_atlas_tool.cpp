@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "resources/sprite_atlas.h"
+
+using namespace skia_renderer;
+
+// 精灵图集工具：把项目里的小装饰图合成一张图集，写出<输出>.atlas.png和<输出>.atlas.json
+//   sprite_atlas -o <输出前缀> [--max-sprite N] [--max-atlas N] <目录或图片>...
+// 需要在项目根目录运行（索引里记录的是协议中引用的相对路径），例如：
+//   ./build/sprite_atlas -o projects/long/resources/long projects/long/resources
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "用法: " << program << " -o <输出前缀> [选项] <目录或图片>...\n"
+              << "选项:\n"
+              << "  --max-sprite N   宽高都不超过N的图片才进入图集（默认256）\n"
+              << "  --max-atlas N    图集边长上限（默认2048）" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string basePath;
+    int maxSprite = 256;
+    int maxAtlas = 2048;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((arg == "-o" || arg == "--output") && hasValue) {
+            basePath = argv[++i];
+        } else if (arg == "--max-sprite" && hasValue) {
+            maxSprite = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--max-atlas" && hasValue) {
+            maxAtlas = std::max(64, std::atoi(argv[++i]));
+        } else if (arg.rfind("--", 0) == 0) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (basePath.empty() || inputs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    SpriteAtlasBuilder builder(maxSprite, maxAtlas);
+    for (const auto& input : inputs) {
+        bool ok = std::filesystem::is_directory(input) ? builder.addDirectory(input) : builder.addFile(input);
+        if (!ok) {
+            std::cerr << "❌ " << builder.getErrorMessage() << std::endl;
+            return 1;
+        }
+    }
+    if (!builder.write(basePath)) {
+        std::cerr << "❌ " << builder.getErrorMessage() << std::endl;
+        return 1;
+    }
+
+    std::cout << "✅ 已写入 " << basePath << ".atlas.png / .atlas.json: " << builder.getPackedCount()
+              << " 个精灵, 图集 " << builder.getAtlasSize().width() << "x" << builder.getAtlasSize().height()
+              << ", 跳过 " << builder.getSkippedCount() << " 个（过大或放不下）" << std::endl;
+    return 0;
+}